@@ -0,0 +1,156 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Arena.h
+ *
+ * A region allocator for the nodes of the data structures storing relations.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * An arena handing out memory from a list of slabs by bumping a pointer.
+ *
+ * Memory is not returned piece by piece. Instead, reset() makes all slabs available
+ * for reuse at once and release() or the destructor return them to the system. For
+ * relations that are filled and cleared in every iteration of a fixpoint, this replaces
+ * one allocation and deallocation per node by a constant-time reset.
+ *
+ * Allocations may be conducted concurrently; threads share the current slab and only
+ * synchronise when it is exhausted. reset() and release() must not be called concurrently
+ * with other operations. Slabs start at the size of the first allocation and double in
+ * size up to max_slab_size.
+ */
+class Arena {
+public:
+    static constexpr std::size_t cache_line_size = 64;
+    static constexpr std::size_t max_slab_size = 1 << 20;
+
+    /** Create an arena whose allocations are aligned to the given power of two, at most a cache line */
+    explicit Arena(std::size_t alignment = cache_line_size) : alignment(alignment) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        release();
+    }
+
+    /** Allocate size bytes */
+    void* allocate(std::size_t size) {
+        size = (size + alignment - 1) / alignment * alignment;
+        while (true) {
+            Slab* slab = current.load(std::memory_order_acquire);
+            if (slab != nullptr) {
+                std::size_t pos = slab->used.fetch_add(size, std::memory_order_relaxed);
+                if (pos + size <= slab->size) {
+                    return slab->data() + pos;
+                }
+            }
+            // the slab is exhausted => the first thread noticing moves on to the next one
+            std::lock_guard<SpinLock> guard(lock);
+            if (current.load(std::memory_order_relaxed) == slab) {
+                current.store(nextSlab(size), std::memory_order_release);
+            }
+        }
+    }
+
+    /** Make all memory available for reuse, invalidating all allocations */
+    void reset() {
+        current.store(nullptr, std::memory_order_relaxed);
+        reused = 0;
+    }
+
+    /** Return all memory to the system, invalidating all allocations */
+    void release() {
+        reset();
+        for (Slab* slab : slabs) {
+            free(slab);
+        }
+        slabs.clear();
+        capacity = 0;
+    }
+
+    /** Obtain the alignment of all allocations */
+    std::size_t getAlignment() const {
+        return alignment;
+    }
+
+    /** Obtain the number of bytes held by this arena */
+    std::size_t getCapacity() const {
+        return capacity;
+    }
+
+private:
+    /** A slab is a header followed by its usable memory */
+    struct alignas(cache_line_size) Slab {
+        std::atomic<std::size_t> used;
+        std::size_t size;
+
+        char* data() {
+            return reinterpret_cast<char*>(this) + sizeof(Slab);
+        }
+    };
+
+    /** Obtain an empty slab of at least the given size, reusing slabs retained by reset() first */
+    Slab* nextSlab(std::size_t size) {
+        while (reused < slabs.size()) {
+            Slab* slab = slabs[reused++];
+            if (slab->size >= size) {
+                slab->used.store(0, std::memory_order_relaxed);
+                return slab;
+            }
+        }
+        const std::size_t slabSize = std::max(size, std::min(capacity, std::size_t(max_slab_size)));
+        void* mem = nullptr;
+        if (posix_memalign(&mem, cache_line_size, sizeof(Slab) + slabSize) != 0) {
+            throw std::bad_alloc();
+        }
+        Slab* slab = static_cast<Slab*>(mem);
+        new (&slab->used) std::atomic<std::size_t>(0);
+        slab->size = slabSize;
+        slabs.push_back(slab);
+        reused = slabs.size();
+        capacity += slabSize;
+        return slab;
+    }
+
+    // the alignment of all allocations
+    const std::size_t alignment;
+
+    // the slab allocations are currently served from
+    std::atomic<Slab*> current{nullptr};
+
+    // all slabs owned by this arena
+    std::vector<Slab*> slabs;
+
+    // the number of slabs in use since the last reset
+    std::size_t reused = 0;
+
+    // the total size of all slabs
+    std::size_t capacity = 0;
+
+    // serialises switching to the next slab
+    SpinLock lock;
+};
+
+}  // end of namespace souffle
@@ -18,7 +18,9 @@
 #include "AstProgram.h"
 #include "AstTranslationUnit.h"
 #include "AstVisitor.h"
+#include "ErrorReport.h"
 #include "Global.h"
+#include "RelationNodeSize.h"
 #include "Util.h"
 
 namespace souffle {
@@ -54,6 +56,14 @@ bool AstPragmaChecker::transform(AstTranslationUnit& translationUnit) {
         }
     });
 
+    // check the node sizes requested for relations
+    try {
+        RelationNodeSize::check();
+    } catch (const std::invalid_argument& e) {
+        translationUnit.getErrorReport().addDiagnostic(
+                Diagnostic(Diagnostic::ERROR, DiagnosticMessage(e.what())));
+    }
+
     return changed;
 }
 }  // end of namespace souffle
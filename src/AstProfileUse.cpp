@@ -61,4 +61,25 @@ size_t AstProfileUse::getRelationSize(const AstRelationIdentifier& rel) {
     }
 }
 
+/**
+ * Check whether the distinct values of a column are defined in profile
+ */
+bool AstProfileUse::hasDistinctValues(const AstRelationIdentifier& rel, size_t column) {
+    if (const auto* profRel = programRun->getRelation(rel.getName())) {
+        return profRel->getDistinctValues().count(column) > 0;
+    }
+    return false;
+}
+
+/**
+ * Get the distinct values of a column from profile
+ */
+size_t AstProfileUse::getDistinctValues(const AstRelationIdentifier& rel, size_t column) {
+    if (hasDistinctValues(rel, column)) {
+        return programRun->getRelation(rel.getName())->getDistinctValues().at(column);
+    } else {
+        return std::numeric_limits<size_t>::max();
+    }
+}
+
 }  // end of namespace souffle
@@ -51,6 +51,12 @@ public:
 
     /** Return size of relation in the profile */
     size_t getRelationSize(const AstRelationIdentifier& rel);
+
+    /** Check whether the number of distinct values of a column exists in profile */
+    bool hasDistinctValues(const AstRelationIdentifier& rel, size_t column);
+
+    /** Return the estimated number of distinct values of a column in the profile */
+    size_t getDistinctValues(const AstRelationIdentifier& rel, size_t column);
 };
 
 }  // end of namespace souffle
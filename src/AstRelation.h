@@ -59,6 +59,12 @@
 /* Relation uses a union relation */
 #define EQREL_RELATION (0x100)
 
+/* Relation uses a compressed data structure */
+#define COMPRESSED_RELATION (0x200)
+
+/* Relation uses hash indexes */
+#define HASH_RELATION (0x400)
+
 /* Relation warnings are suppressed */
 #define SUPPRESSED_RELATION (0x800)
 
@@ -123,6 +129,10 @@ public:
             representation = RelationRepresentation::BRIE;
         } else if (q & BTREE_RELATION) {
             representation = RelationRepresentation::BTREE;
+        } else if (q & COMPRESSED_RELATION) {
+            representation = RelationRepresentation::COMPRESSED;
+        } else if (q & HASH_RELATION) {
+            representation = RelationRepresentation::HASH;
         }
 
         if (q & INPUT_RELATION) {
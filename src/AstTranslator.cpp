@@ -124,6 +124,10 @@ std::vector<IODirectives> AstTranslator::getInputIODirectives(
 
     for (auto& ioDirective : inputDirectives) {
         makeIODirective(ioDirective, rel, inputFilePath, inputFileExt, isIntermediate);
+        // a sample run loads a subset of the facts
+        if (Global::config().has("fact-sample") && !isIntermediate) {
+            ioDirective.set("sample", Global::config().get("fact-sample"));
+        }
     }
 
     return inputDirectives;
@@ -647,6 +651,11 @@ std::unique_ptr<RamStatement> AstTranslator::ClauseTranslator::translateClause(
     // the rest should be rules
     assert(clause.isRule());
 
+    // a cyclic body is evaluated by a worst-case optimal join instead of a loop nest
+    if (hasCyclicBody(clause)) {
+        return translateLeapfrogClause(clause, originalClause);
+    }
+
     createValueIndex(clause);
 
     // -- create RAM statement --
@@ -878,6 +887,157 @@ std::unique_ptr<RamStatement> AstTranslator::ClauseTranslator::translateClause(
     }
 }
 
+bool AstTranslator::ClauseTranslator::hasCyclicBody(const AstClause& clause) const {
+    if (Global::config().has("provenance")) {
+        return false;
+    }
+    bool hasAggregator = false;
+    visitDepthFirst(clause, [&](const AstAggregator&) { hasAggregator = true; });
+    if (hasAggregator) {
+        return false;
+    }
+
+    // the atoms must be tries over ordered indexes whose levels are distinct variables
+    std::vector<std::set<std::string>> edges;
+    std::set<std::string> atomVariables;
+    for (const AstAtom* atom : clause.getAtoms()) {
+        const RelationRepresentation representation =
+                translator.translateRelation(atom)->get()->getRepresentation();
+        if (atom->getArity() == 0 || (representation != RelationRepresentation::DEFAULT &&
+                                             representation != RelationRepresentation::BTREE)) {
+            return false;
+        }
+        std::set<std::string> edge;
+        for (const AstArgument* arg : atom->getArguments()) {
+            if (dynamic_cast<const AstUnnamedVariable*>(arg) != nullptr) {
+                continue;
+            }
+            const auto* var = dynamic_cast<const AstVariable*>(arg);
+            if (var == nullptr || !edge.insert(var->getName()).second) {
+                return false;
+            }
+        }
+        atomVariables.insert(edge.begin(), edge.end());
+        edges.push_back(std::move(edge));
+    }
+
+    // all other variables must be bound by the atoms
+    bool bound = true;
+    visitDepthFirst(clause, [&](const AstVariable& var) {
+        bound = bound && atomVariables.find(var.getName()) != atomVariables.end();
+    });
+
+    return bound && isCyclic(std::move(edges));
+}
+
+bool AstTranslator::ClauseTranslator::isCyclic(std::vector<std::set<std::string>> edges) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        // remove variables that occur in a single edge
+        std::map<std::string, size_t> occurrences;
+        for (const auto& edge : edges) {
+            for (const auto& var : edge) {
+                ++occurrences[var];
+            }
+        }
+        for (auto& edge : edges) {
+            for (auto it = edge.begin(); it != edge.end();) {
+                if (occurrences[*it] == 1) {
+                    it = edge.erase(it);
+                    changed = true;
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        // remove an edge that is contained in another edge
+        for (size_t i = 0; i < edges.size() && !changed; ++i) {
+            for (size_t j = 0; j < edges.size() && !changed; ++j) {
+                if (i != j && std::includes(edges[j].begin(), edges[j].end(), edges[i].begin(),
+                                      edges[i].end())) {
+                    edges.erase(edges.begin() + i);
+                    changed = true;
+                }
+            }
+        }
+    }
+    return edges.size() > 1;
+}
+
+/** generate RAM code for a rule with a cyclic body */
+std::unique_ptr<RamStatement> AstTranslator::ClauseTranslator::translateLeapfrogClause(
+        const AstClause& clause, const AstClause& originalClause) {
+    const AstAtom* head = clause.getHead();
+    const auto atoms = clause.getAtoms();
+
+    // the variables are the elements of the tuple t0, numbered by their first occurrence;
+    // unnamed variables are bound last
+    std::map<std::string, size_t> variables;
+    for (const AstAtom* atom : atoms) {
+        for (const AstArgument* arg : atom->getArguments()) {
+            if (const auto* var = dynamic_cast<const AstVariable*>(arg)) {
+                if (variables.find(var->getName()) == variables.end()) {
+                    const size_t idx = variables.size();
+                    variables[var->getName()] = idx;
+                    valueIndex.addVarReference(*var, 0, idx);
+                }
+            }
+        }
+    }
+    size_t numVariables = variables.size();
+    std::vector<std::unique_ptr<RamRelationReference>> relations;
+    std::vector<std::vector<size_t>> atomVariables;
+    for (const AstAtom* atom : atoms) {
+        std::vector<size_t> cur;
+        for (const AstArgument* arg : atom->getArguments()) {
+            if (const auto* var = dynamic_cast<const AstVariable*>(arg)) {
+                cur.push_back(variables[var->getName()]);
+            } else {
+                cur.push_back(numVariables++);
+            }
+        }
+        relations.push_back(translator.translateRelation(atom));
+        atomVariables.push_back(std::move(cur));
+    }
+
+    std::unique_ptr<RamOperation> op = createOperation(clause);
+
+    /* add conditions caused by negations and binary relations */
+    for (const auto& lit : clause.getBodyLiterals()) {
+        if (auto condition = translator.translateConstraint(lit, valueIndex)) {
+            op = std::make_unique<RamFilter>(std::move(condition), std::move(op));
+        }
+    }
+
+    if (head->getArity() == 0) {
+        op = std::make_unique<RamBreak>(std::make_unique<RamNegation>(std::make_unique<RamEmptinessCheck>(
+                                                translator.translateRelation(head))),
+                std::move(op));
+    }
+
+    op = std::make_unique<RamLeapfrogJoin>(
+            std::move(relations), std::move(atomVariables), numVariables, 0, std::move(op));
+
+    // add checks for emptiness of the atoms
+    for (const AstAtom* atom : atoms) {
+        op = std::make_unique<RamFilter>(
+                std::make_unique<RamNegation>(
+                        std::make_unique<RamEmptinessCheck>(translator.translateRelation(atom))),
+                std::move(op));
+    }
+
+    /* generate the final RAM Insert statement */
+    std::unique_ptr<RamCondition> cond = createCondition(originalClause);
+    if (cond != nullptr) {
+        return std::make_unique<RamQuery>(std::make_unique<RamFilter>(std::move(cond), std::move(op)));
+    } else {
+        return std::make_unique<RamQuery>(std::move(op));
+    }
+}
+
 /* utility for appending statements */
 void AstTranslator::appendStmt(std::unique_ptr<RamStatement>& stmtList, std::unique_ptr<RamStatement> stmt) {
     if (stmt) {
@@ -992,6 +1152,58 @@ void AstTranslator::nameUnnamedVariables(AstClause* clause) {
     }
 }
 
+/** generate RAM code for a version of a recursive clause, offering alternative join orders */
+std::unique_ptr<RamStatement> AstTranslator::translateAdaptiveClause(
+        const AstClause& clause, const AstClause& originalClause, const int version, const size_t deltaAtom) {
+    const size_t numAtoms = clause.getAtoms().size();
+    const auto plan = clause.getExecutionPlan();
+
+    // there is no choice for a single atom, an imposed order or a leapfrog join
+    if (numAtoms < 2 || clause.hasFixedExecutionPlan() || (plan != nullptr && plan->hasOrderFor(version)) ||
+            ClauseTranslator(*this).hasCyclicBody(clause)) {
+        return ClauseTranslator(*this).translateClause(clause, originalClause, version);
+    }
+
+    // candidate orders move a single atom to the front, starting with the static order and the delta atom
+    std::vector<std::vector<unsigned int>> orders;
+    std::vector<size_t> firstAtoms = {0, deltaAtom};
+    for (size_t i = 1; i < numAtoms; ++i) {
+        firstAtoms.push_back(i);
+    }
+    for (size_t first : firstAtoms) {
+        std::vector<unsigned int> order = {(unsigned int)first};
+        for (size_t i = 0; i < numAtoms; ++i) {
+            if (i != first) {
+                order.push_back(i);
+            }
+        }
+        if (orders.size() < maxJoinOrders && !contains(orders, order)) {
+            orders.push_back(order);
+        }
+    }
+
+    auto res = std::make_unique<RamAdaptiveQuery>();
+    for (const auto& order : orders) {
+        std::unique_ptr<AstClause> reorderedClause(clause.clone());
+        reorderedClause->reorderAtoms(order);
+        std::unique_ptr<RamStatement> stmt =
+                ClauseTranslator(*this).translateClause(*reorderedClause, originalClause, version);
+        assert(dynamic_cast<RamQuery*>(stmt.get()) != nullptr && "rules are translated to queries");
+
+        std::string profileText;
+        if (Global::config().has("profile")) {
+            std::stringstream atoms;
+            for (const AstAtom* atom : reorderedClause->getAtoms()) {
+                atoms << (atoms.tellp() > 0 ? "," : "") << toString(*atom);
+            }
+            profileText = LogStatement::joinOrder(toString(originalClause.getHead()->getName()), version,
+                    originalClause.getSrcLoc(), stringify(toString(originalClause)), stringify(atoms.str()));
+        }
+        res->add(std::unique_ptr<RamQuery>(static_cast<RamQuery*>(stmt.release())), profileText);
+    }
+    return std::move(res);
+}
+
 /** generate RAM code for recursive relations in a strongly-connected component */
 std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
         const std::set<const AstRelation*>& scc, const RecursiveClauses* recursiveClauses) {
@@ -1115,7 +1327,9 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
                 }
 
                 std::unique_ptr<RamStatement> rule =
-                        ClauseTranslator(*this).translateClause(*r1, *cl, version);
+                        Global::config().has("adaptive-join-order")
+                                ? translateAdaptiveClause(*r1, *cl, version, j)
+                                : ClauseTranslator(*this).translateClause(*r1, *cl, version);
 
                 /* add logging */
                 if (Global::config().has("profile")) {
@@ -1578,6 +1792,21 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
                                          *((const AstRelation*)*allInterns.begin()), recursiveClauses)
                                : translateRecursiveRelation(allInterns, recursiveClauses);
         appendStmt(current, std::move(bodyStatement));
+
+        // log the column statistics of the computed relations for profile-guided atom ordering
+        if (Global::config().has("profile")) {
+            for (const auto& relation : allInterns) {
+                std::vector<std::string> messages;
+                for (size_t i = 0; i < relation->getArity(); ++i) {
+                    messages.push_back(LogStatement::nRelationDistinct(
+                            toString(relation->getName()), relation->getSrcLoc(), i));
+                }
+                if (!messages.empty()) {
+                    appendStmt(current, std::make_unique<RamLogStatistics>(
+                                                translateRelation(relation), std::move(messages)));
+                }
+            }
+        }
 #ifdef USE_MPI
         // note that the order of sends is first by relation then second destination
         if (Global::config().get("engine") == "mpi") {
@@ -339,6 +339,13 @@ private:
 
         void createValueIndex(const AstClause& clause);
 
+        /** check whether the hypergraph of the given variable sets remains after a GYO reduction */
+        static bool isCyclic(std::vector<std::set<std::string>> edges);
+
+        /** translate a rule to a leapfrog join binding the variables of its atoms */
+        std::unique_ptr<RamStatement> translateLeapfrogClause(
+                const AstClause& clause, const AstClause& originalClause);
+
     protected:
         AstTranslator& translator;
 
@@ -356,6 +363,9 @@ private:
 
         std::unique_ptr<RamStatement> translateClause(
                 const AstClause& clause, const AstClause& originalClause, const int version = 0);
+
+        /** check whether the atoms of a rule form a cycle that is evaluated by a leapfrog join */
+        bool hasCyclicBody(const AstClause& clause) const;
     };
 
     class ProvenanceClauseTranslator : public ClauseTranslator {
@@ -375,6 +385,16 @@ private:
     std::unique_ptr<RamStatement> translateNonRecursiveRelation(
             const AstRelation& rel, const RecursiveClauses* recursiveClauses);
 
+    /** the maximal number of join orders offered for a version of a recursive clause */
+    static constexpr size_t maxJoinOrders = 4;
+
+    /**
+     * translate RAM code for a version of a recursive clause, offering join orders that start with
+     * different atoms to be chosen between at runtime.
+     */
+    std::unique_ptr<RamStatement> translateAdaptiveClause(const AstClause& clause,
+            const AstClause& originalClause, const int version, const size_t deltaAtom);
+
     /** translate RAM code for recursive relations in a strongly-connected component */
     std::unique_ptr<RamStatement> translateRecursiveRelation(
             const std::set<const AstRelation*>& scc, const RecursiveClauses* recursiveClauses);
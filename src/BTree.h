@@ -17,16 +17,25 @@
 
 #pragma once
 
+#include "Arena.h"
 #include "ParallelUtils.h"
 #include "Util.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#endif
+
 namespace souffle {
 
 namespace detail {
@@ -197,6 +206,207 @@ struct binary_search : public search_strategy {
     }
 };
 
+/**
+ * Describes where a b-tree key keeps the value its comparator orders by first, so that
+ * simd_search can scan it with vector instructions. Keys are viewed as arrays of 32-bit
+ * signed integers; the leading value of the i-th key is found at offset + i * stride.
+ *
+ * Only key/comparator pairs with a specialisation are accelerated, everything else is
+ * searched linearly.
+ */
+template <typename Key, typename Comp, typename = void>
+struct simd_key {
+    static constexpr bool enabled = false;
+};
+
+template <typename Key>
+struct simd_key<Key, comparator<Key>,
+        typename std::enable_if<std::is_integral<Key>::value && std::is_signed<Key>::value &&
+                                sizeof(Key) == sizeof(int32_t)>::type> {
+    static constexpr bool enabled = true;
+    static constexpr std::size_t stride = 1;
+    static constexpr std::size_t offset = 0;
+};
+
+namespace simd_ops {
+
+/**
+ * Scalar version of leadingLess: the number of keys at the front of a node whose leading
+ * value is less than the given one.
+ */
+template <std::size_t Stride, std::size_t Offset>
+inline std::size_t leadingLessScalar(const int32_t* keys, std::size_t n, int32_t key) {
+    std::size_t i = 0;
+    while (i < n && keys[i * Stride + Offset] < key) {
+        ++i;
+    }
+    return i;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+
+/** Whether a lane holds a leading value when keys are loaded back to back, as a lane mask */
+template <std::size_t Stride, std::size_t Offset>
+constexpr int32_t laneSelection(std::size_t lane) {
+    return lane % Stride == Offset ? -1 : 0;
+}
+
+/**
+ * SSE2 version of leadingLess for keys of 1, 2 or 4 values, compares 4 values per
+ * instruction and keeps the lanes holding leading values. Since leading values are sorted
+ * the matching lanes are simply counted, without data-dependent branches.
+ */
+template <std::size_t Stride, std::size_t Offset>
+inline std::size_t leadingLessSSE(const int32_t* keys, std::size_t n, int32_t key) {
+    const __m128i k = _mm_set1_epi32(key);
+    const __m128i selection = _mm_setr_epi32(laneSelection<Stride, Offset>(0),
+            laneSelection<Stride, Offset>(1), laneSelection<Stride, Offset>(2),
+            laneSelection<Stride, Offset>(3));
+    const std::size_t perVector = 4 / Stride;
+    __m128i counts = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + perVector <= n; i += perVector) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i * Stride));
+        counts = _mm_sub_epi32(counts, _mm_and_si128(_mm_cmpgt_epi32(k, v), selection));
+    }
+    counts = _mm_add_epi32(counts, _mm_shuffle_epi32(counts, _MM_SHUFFLE(1, 0, 3, 2)));
+    counts = _mm_add_epi32(counts, _mm_shuffle_epi32(counts, _MM_SHUFFLE(2, 3, 0, 1)));
+    const auto count = static_cast<std::size_t>(_mm_cvtsi128_si32(counts));
+    if (count < i) {
+        return count;
+    }
+    return i + leadingLessScalar<Stride, Offset>(keys + i * Stride, n - i, key);
+}
+
+/**
+ * AVX2 version of leadingLess, compares 8 values per instruction. Keys of 1, 2, 4 or 8
+ * values are loaded back to back, leading values of other keys are gathered.
+ */
+template <std::size_t Stride, std::size_t Offset>
+__attribute__((target("avx2"))) inline std::size_t leadingLessAVX2(
+        const int32_t* keys, std::size_t n, int32_t key) {
+    const __m256i k = _mm256_set1_epi32(key);
+    __m256i counts = _mm256_setzero_si256();
+    std::size_t i = 0;
+    if (8 % Stride == 0) {
+        const __m256i selection = _mm256_setr_epi32(laneSelection<Stride, Offset>(0),
+                laneSelection<Stride, Offset>(1), laneSelection<Stride, Offset>(2),
+                laneSelection<Stride, Offset>(3), laneSelection<Stride, Offset>(4),
+                laneSelection<Stride, Offset>(5), laneSelection<Stride, Offset>(6),
+                laneSelection<Stride, Offset>(7));
+        const std::size_t perVector = 8 / Stride;
+        for (; i + perVector <= n; i += perVector) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i * Stride));
+            counts = _mm256_sub_epi32(counts, _mm256_and_si256(_mm256_cmpgt_epi32(k, v), selection));
+        }
+    } else {
+        const auto s = static_cast<int>(Stride);
+        const __m256i index = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_i32gather_epi32(keys + i * Stride + Offset, index, sizeof(int32_t));
+            counts = _mm256_sub_epi32(counts, _mm256_cmpgt_epi32(k, v));
+        }
+    }
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(counts), _mm256_extracti128_si256(counts, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    const auto count = static_cast<std::size_t>(_mm_cvtsi128_si32(sum));
+    if (count < i) {
+        return count;
+    }
+    return i + leadingLessScalar<Stride, Offset>(keys + i * Stride, n - i, key);
+}
+
+inline bool hasAVX2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#endif
+
+/**
+ * Determines the number of keys at the front of a node whose leading value is less than
+ * the given one, picking the widest instruction set supported by the running CPU. Keys
+ * consist of Stride values, the leading one being at position Offset.
+ */
+template <std::size_t Stride, std::size_t Offset>
+inline std::size_t leadingLess(const int32_t* keys, std::size_t n, int32_t key) {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    if (hasAVX2()) {
+        return leadingLessAVX2<Stride, Offset>(keys, n, key);
+    }
+    if (4 % Stride == 0) {
+        return leadingLessSSE<Stride, Offset>(keys, n, key);
+    }
+#endif
+    return leadingLessScalar<Stride, Offset>(keys, n, key);
+}
+
+}  // end namespace simd_ops
+
+/**
+ * A vectorised search strategy for looking up keys in b-tree nodes.
+ *
+ * Keys described by simd_key are first skipped by comparing their leading values with
+ * vector instructions; the remaining keys sharing the leading value are then resolved
+ * linearly with the full comparator. Other keys fall back to linear search.
+ */
+struct simd_search : public search_strategy {
+    /**
+     * Required user-defined default constructor.
+     */
+    simd_search() = default;
+
+    /**
+     * Obtains an iterator referencing an element equivalent to the
+     * given key in the given range. If no such element is present,
+     * a reference to the first element not less than the given key
+     * is returned.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter operator()(const Key& k, Iter a, Iter b, Comp& comp) const {
+        return lower_bound(k, a, b, comp);
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * is not less than the given key.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter lower_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        return linear_search().lower_bound(k, skip(k, a, b, comp), b, comp);
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * such that the given key is less than the referenced element.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter upper_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        return linear_search().upper_bound(k, skip(k, a, b, comp), b, comp);
+    }
+
+private:
+    /**
+     * Skips all keys whose leading value is less than the one of the given key.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    static typename std::enable_if<simd_key<Key, Comp>::enabled, Iter>::type skip(
+            const Key& k, Iter a, Iter b, Comp& /* comp */) {
+        using traits = simd_key<Key, Comp>;
+        static_assert(sizeof(Key) == traits::stride * sizeof(int32_t), "keys must be densely packed");
+        const auto* keys = reinterpret_cast<const int32_t*>(&*a);
+        const auto key = reinterpret_cast<const int32_t*>(&k)[traits::offset];
+        return a + simd_ops::leadingLess<traits::stride, traits::offset>(keys, b - a, key);
+    }
+
+    template <typename Key, typename Iter, typename Comp>
+    static typename std::enable_if<!simd_key<Key, Comp>::enabled, Iter>::type skip(
+            const Key& /* k */, Iter a, Iter /* b */, Comp& /* comp */) {
+        return a;
+    }
+};
+
 // ---------- search strategies selection --------------
 
 /**
@@ -210,6 +420,7 @@ struct strategy_selection {
 
 struct linear : public strategy_selection<linear_search> {};
 struct binary : public strategy_selection<binary_search> {};
+struct simd : public strategy_selection<simd_search> {};
 
 // by default every key utilizes binary search
 template <typename Key>
@@ -288,7 +499,9 @@ protected:
     /* -------------- the node type ----------------- */
 
     using size_type = std::size_t;
-    using field_index_type = uint8_t;
+    // positions in a parent node, a single byte unless large nodes hold more than 255 keys
+    using field_index_type =
+            typename std::conditional<(blockSize / sizeof(Key) < 256), uint8_t, uint16_t>::type;
     using lock_type = OptimisticReadWriteLock;
 
     struct node;
@@ -377,20 +590,13 @@ protected:
         // a simple constructor
         node(bool inner) : base(inner) {}
 
-        // a destructor cleaning up nodes
-        ~node() {
-            if (this->inner) {
-                asInnerNode().cleanup();
-            }
-        }
-
         /**
-         * A deep-copy operation creating a clone of this node.
+         * A deep-copy operation creating a clone of this node in the given arena.
          */
-        node* clone() const {
+        node* clone(Arena& arena) const {
             // create a clone of this node
-            node* res = (this->isInner()) ? static_cast<node*>(new inner_node())
-                                          : static_cast<node*>(new leaf_node());
+            node* res = (this->isInner()) ? static_cast<node*>(create<inner_node>(arena))
+                                          : static_cast<node*>(create<leaf_node>(arena));
 
             // copy basic fields
             res->position = this->position;
@@ -408,7 +614,7 @@ protected:
             // copy child nodes recursively
             auto* ires = (inner_node*)res;
             for (size_type i = 0; i <= this->numElements; ++i) {
-                ires->children[i] = this->getChild(i)->clone();
+                ires->children[i] = this->getChild(i)->clone(arena);
                 ires->children[i]->parent = res;
             }
 
@@ -546,14 +752,15 @@ protected:
          * @param idx  .. the position of the insert causing the split
          */
 #ifdef IS_PARALLEL
-        void split(node** root, lock_type& root_lock, int idx, std::vector<node*>& locked_nodes) {
+        void split(
+                node** root, lock_type& root_lock, Arena& arena, int idx, std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        void split(node** root, lock_type& root_lock, int idx) {
+        void split(node** root, lock_type& root_lock, Arena& arena, int idx) {
 #endif
             assert(this->numElements == maxKeys);
 
@@ -561,8 +768,8 @@ protected:
             int split_point = getSplitPoint(idx);
 
             // create a new sibling node
-            node* sibling = (this->inner) ? static_cast<node*>(new inner_node())
-                                          : static_cast<node*>(new leaf_node());
+            node* sibling = (this->inner) ? static_cast<node*>(create<inner_node>(arena))
+                                          : static_cast<node*>(create<leaf_node>(arena));
 
 #ifdef IS_PARALLEL
             // lock sibling
@@ -592,9 +799,9 @@ protected:
 
             // update parent
 #ifdef IS_PARALLEL
-            grow_parent(root, root_lock, sibling, locked_nodes);
+            grow_parent(root, root_lock, arena, sibling, locked_nodes);
 #else
-            grow_parent(root, root_lock, sibling);
+            grow_parent(root, root_lock, arena, sibling);
 #endif
         }
 
@@ -611,14 +818,15 @@ protected:
          */
         // TODO: remove root_lock ... no longer needed
 #ifdef IS_PARALLEL
-        int rebalance_or_split(node** root, lock_type& root_lock, int idx, std::vector<node*>& locked_nodes) {
+        int rebalance_or_split(
+                node** root, lock_type& root_lock, Arena& arena, int idx, std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        int rebalance_or_split(node** root, lock_type& root_lock, int idx) {
+        int rebalance_or_split(node** root, lock_type& root_lock, Arena& arena, int idx) {
 #endif
 
             // this node is full ... and needs some space
@@ -636,7 +844,7 @@ protected:
                 // lock access to left sibling
                 if (!left->lock.try_start_write()) {
                     // left node is currently updated => skip balancing and split
-                    split(root, root_lock, idx, locked_nodes);
+                    split(root, root_lock, arena, idx, locked_nodes);
                     return 0;
                 }
 #endif
@@ -707,9 +915,9 @@ protected:
 
             // Option B) split node
 #ifdef IS_PARALLEL
-            split(root, root_lock, idx, locked_nodes);
+            split(root, root_lock, arena, idx, locked_nodes);
 #else
-            split(root, root_lock, idx);
+            split(root, root_lock, arena, idx);
 #endif
             return 0;  // = no re-balancing
         }
@@ -724,21 +932,22 @@ protected:
          * @param sibling .. the new right-sibling to be add to the parent node
          */
 #ifdef IS_PARALLEL
-        void grow_parent(node** root, lock_type& root_lock, node* sibling, std::vector<node*>& locked_nodes) {
+        void grow_parent(node** root, lock_type& root_lock, Arena& arena, node* sibling,
+                std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        void grow_parent(node** root, lock_type& root_lock, node* sibling) {
+        void grow_parent(node** root, lock_type& root_lock, Arena& arena, node* sibling) {
 #endif
 
             if (this->parent == nullptr) {
                 assert(*root == this);
 
                 // create a new root node
-                auto* new_root = new inner_node();
+                auto* new_root = create<inner_node>(arena);
                 new_root->numElements = 1;
                 new_root->keys[0] = keys[this->numElements];
 
@@ -760,9 +969,9 @@ protected:
 
 #ifdef IS_PARALLEL
                 parent->insert_inner(
-                        root, root_lock, pos, this, keys[this->numElements], sibling, locked_nodes);
+                        root, root_lock, arena, pos, this, keys[this->numElements], sibling, locked_nodes);
 #else
-                parent->insert_inner(root, root_lock, pos, this, keys[this->numElements], sibling);
+                parent->insert_inner(root, root_lock, arena, pos, this, keys[this->numElements], sibling);
 #endif
             }
         }
@@ -776,13 +985,13 @@ protected:
          * @param newNode .. the new right-child of the inserted key
          */
 #ifdef IS_PARALLEL
-        void insert_inner(node** root, lock_type& root_lock, unsigned pos, node* predecessor, const Key& key,
-                node* newNode, std::vector<node*>& locked_nodes) {
+        void insert_inner(node** root, lock_type& root_lock, Arena& arena, unsigned pos, node* predecessor,
+                const Key& key, node* newNode, std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(souffle::contains(locked_nodes, this));
 #else
-        void insert_inner(node** root, lock_type& root_lock, unsigned pos, node* predecessor, const Key& key,
-                node* newNode) {
+        void insert_inner(node** root, lock_type& root_lock, Arena& arena, unsigned pos, node* predecessor,
+                const Key& key, node* newNode) {
 #endif
 
             // check capacity
@@ -795,9 +1004,9 @@ protected:
 
                 // split this node
 #ifdef IS_PARALLEL
-                pos -= rebalance_or_split(root, root_lock, pos, locked_nodes);
+                pos -= rebalance_or_split(root, root_lock, arena, pos, locked_nodes);
 #else
-                pos -= rebalance_or_split(root, root_lock, pos);
+                pos -= rebalance_or_split(root, root_lock, arena, pos);
 #endif
 
                 // complete insertion within new sibling if necessary
@@ -819,9 +1028,9 @@ protected:
                         if (other->getChild(i) == predecessor) break;
 
                     pos = (i > other->numElements) ? 0 : i;
-                    other->insert_inner(root, root_lock, pos, predecessor, key, newNode, locked_nodes);
+                    other->insert_inner(root, root_lock, arena, pos, predecessor, key, newNode, locked_nodes);
 #else
-                    other->insert_inner(root, root_lock, pos, predecessor, key, newNode);
+                    other->insert_inner(root, root_lock, arena, pos, predecessor, key, newNode);
 #endif
                     return;
                 }
@@ -1061,13 +1270,6 @@ protected:
 
         // a simple default constructor initializing member fields
         inner_node() : node(true) {}
-
-        // a destruction operation clearing up child nodes recursively
-        void cleanup() {
-            for (unsigned i = 0; i <= this->numElements; ++i) {
-                delete children[i];
-            }
-        }
     };
 
     /**
@@ -1079,6 +1281,31 @@ protected:
         leaf_node() : node(false) {}
     };
 
+    /**
+     * Creates a node in the given arena. Nodes start at cache line boundaries, such that the
+     * book-keeping information and the first keys share a cache line.
+     */
+    template <typename Node>
+    static Node* create(Arena& arena) {
+        return new (arena.allocate(sizeof(Node))) Node();
+    }
+
+    /**
+     * Destroys the keys of the given sub-tree. The memory of the nodes is owned by the arena
+     * of the tree, so there is nothing to be done for trivially destructible keys.
+     */
+    static void destroy(node* cur) {
+        if (std::is_trivially_destructible<Key>::value) {
+            return;
+        }
+        if (cur->isInner()) {
+            for (size_type i = 0; i <= cur->numElements; ++i) {
+                destroy(cur->getChild(i));
+            }
+        }
+        cur->~node();
+    }
+
     // ------------------- iterators ------------------------
 
 public:
@@ -1216,6 +1443,9 @@ protected:
     // a pointer to the left-most node of this tree (initial note for iteration)
     leaf_node* leftmost;
 
+    // the arena owning the nodes of this tree
+    std::unique_ptr<Arena> arena;
+
     /* -------------- operator hint statistics ----------------- */
 
     // an aggregation of statistical values of the hint utilization
@@ -1239,42 +1469,46 @@ protected:
 public:
     enum {
         // the maximum number of keys stored per node
-        max_keys_per_node = node::maxKeys
+        max_keys_per_node = node::maxKeys,
+
+        // merges of whole trees rebuild trees holding at most this many times the number of
+        // merged elements, otherwise the elements are inserted one by one
+        bulk_merge_ratio = 16,
+
+        // range insertions into an empty tree build it bottom-up from at least this many elements
+        bulk_load_min_size = 1024
     };
 
     // -- ctors / dtors --
 
     // the default constructor creating an empty tree
     btree(Comparator comp = Comparator(), WeakComparator weak_comp = WeakComparator())
-            : comp(std::move(comp)), weak_comp(std::move(weak_comp)), root(nullptr), leftmost(nullptr) {}
+            : comp(std::move(comp)), weak_comp(std::move(weak_comp)), root(nullptr), leftmost(nullptr),
+              arena(std::make_unique<Arena>()) {}
 
     // a constructor creating a tree from the given iterator range
     template <typename Iter>
-    btree(const Iter& a, const Iter& b) : root(nullptr), leftmost(nullptr) {
+    btree(const Iter& a, const Iter& b) : root(nullptr), leftmost(nullptr), arena(std::make_unique<Arena>()) {
         insert(a, b);
     }
 
     // a move constructor
     btree(btree&& other)
-            : comp(other.comp), weak_comp(other.weak_comp), root(other.root), leftmost(other.leftmost) {
+            : comp(other.comp), weak_comp(other.weak_comp), root(other.root), leftmost(other.leftmost),
+              arena(std::move(other.arena)) {
         other.root = nullptr;
         other.leftmost = nullptr;
+        other.arena = std::make_unique<Arena>();
     }
 
     // a copy constructor
-    btree(const btree& set) : comp(set.comp), weak_comp(set.weak_comp), root(nullptr), leftmost(nullptr) {
+    btree(const btree& set)
+            : comp(set.comp), weak_comp(set.weak_comp), root(nullptr), leftmost(nullptr),
+              arena(std::make_unique<Arena>()) {
         // use assignment operator for a deep copy
         *this = set;
     }
 
-protected:
-    /**
-     * An internal constructor enabling the specific creation of a tree
-     * based on internal parameters.
-     */
-    btree(size_type size, node* root, leaf_node* leftmost) : root(root), leftmost(leftmost) {}
-
-public:
     // the destructor freeing all contained nodes
     ~btree() {
         clear();
@@ -1322,7 +1556,7 @@ public:
             }
 
             // create new node
-            leftmost = new leaf_node();
+            leftmost = create<leaf_node>(*arena);
             leftmost->numElements = 1;
             leftmost->keys[0] = k;
             root = leftmost;
@@ -1514,7 +1748,7 @@ public:
 
                 // split this node
                 auto old_root = root;
-                idx -= cur->rebalance_or_split(const_cast<node**>(&root), root_lock, idx, parents);
+                idx -= cur->rebalance_or_split(const_cast<node**>(&root), root_lock, *arena, idx, parents);
 
                 // release parent lock
                 for (auto it = parents.rbegin(); it != parents.rend(); ++it) {
@@ -1566,7 +1800,7 @@ public:
         // special handling for inserting first element
         if (empty()) {
             // create new node
-            leftmost = new leaf_node();
+            leftmost = create<leaf_node>(*arena);
             leftmost->numElements = 1;
             leftmost->keys[0] = k;
             root = leftmost;
@@ -1641,7 +1875,7 @@ public:
 
             if (cur->numElements >= node::maxKeys) {
                 // split this node
-                idx -= cur->rebalance_or_split(&root, root_lock, idx);
+                idx -= cur->rebalance_or_split(&root, root_lock, *arena, idx);
 
                 // insert element in right fragment
                 if (((size_type)idx) > cur->numElements) {
@@ -1672,40 +1906,47 @@ public:
 
     /**
      * Inserts the given range of elements into this tree.
+     *
+     * A large range of random-access elements inserted into an empty tree is sorted (unless it
+     * already is) and the tree is built bottom-up from it. All other ranges are inserted element
+     * by element, ranges of random-access elements in parallel on disjoint parts. Neither copies
+     * nor rebuilds a non-empty tree, such that range insertions may run concurrently with other
+     * insertions into this tree.
      */
     template <typename Iter>
     void insert(const Iter& a, const Iter& b) {
-        // TODO: improve this beyond a naive insert
-        operation_hints hints;
-        // a naive insert so far .. seems to work fine
-        for (auto it = a; it != b; ++it) {
-            // use insert with hint
-            insert(*it, hints);
+        if (a == b) {
+            return;
         }
+        insertRange(a, b, typename std::iterator_traits<Iter>::iterator_category());
     }
 
     /**
      * Inserts all elements of the given b-tree into this tree.
-     * This can be a more effective alternative to the ordered insertion
-     * of elements utilizing iterators.
+     * Since both trees are ordered, trees large compared to this tree are merged with it in linear
+     * time and this tree is rebuilt bottom-up, both in parallel on disjoint key ranges. Smaller trees
+     * are inserted element by element. Since a rebuild replaces all nodes, this operation must not
+     * run concurrently with other operations on this tree and invalidates all operation hints
+     * referring to it.
+     *
+     * @return the number of elements added to this tree
      */
-    void insertAll(const btree& other) {
+    size_type insertAll(const btree& other) {
         // shortcut for non-sense operation
-        if (this == &other) {
-            return;
+        if (this == &other || other.empty()) {
+            return 0;
         }
 
-        // make sure bigger tree is inserted in smaller tree
-        if ((size() + 10000) < other.size()) {
-            // switch sides
-            btree tmp = other;
-            tmp.insertAll(*this);
-            swap(tmp);
-            return;
+        std::vector<chunk> chunks;
+        for (const auto& cur : other.getChunks(MAX_THREADS * 4)) {
+            if (cur.begin() != cur.end()) {
+                chunks.push_back(cur);
+            }
         }
-
-        // by default use the iterator based insertion
-        insert(other.begin(), other.end());
+        if (!shouldRebuild(other.size())) {
+            return insertParallel(chunks);
+        }
+        return mergeAndRebuild(chunks);
     }
 
     // Obtains an iterator referencing the first element of the tree.
@@ -1927,12 +2168,26 @@ public:
     }
 
     /**
-     * Clears this tree.
+     * Clears this tree and releases the memory of its nodes.
      */
     void clear() {
-        delete root;
+        reset();
+        arena->release();
+    }
+
+    /**
+     * Clears this tree, keeping the memory of its nodes for subsequent
+     * insertions. Unless keys need to be destroyed, this takes constant
+     * time in the size of the tree. Operation hints referring to this
+     * tree become invalid.
+     */
+    void reset() {
+        if (root != nullptr) {
+            destroy(root);
+        }
         root = nullptr;
         leftmost = nullptr;
+        arena->reset();
     }
 
     /**
@@ -1944,6 +2199,7 @@ public:
         // swap the content
         std::swap(root, other.root);
         std::swap(leftmost, other.leftmost);
+        std::swap(arena, other.arena);
     }
 
     // Implementation of the assignment operation for trees.
@@ -1954,13 +2210,15 @@ public:
         }
 
         // create a deep-copy of the content of the other tree
+        clear();
+
         // shortcut for empty sets
         if (other.empty()) {
             return *this;
         }
 
         // clone content (deep copy)
-        root = other.root->clone();
+        root = other.root->clone(*arena);
 
         // update leftmost reference
         auto tmp = root;
@@ -2097,21 +2355,24 @@ public:
             R>::type
     load(const Iter& a, const Iter& b) {
         // quick exit - empty range
+        R res;
         if (a == b) {
-            return R();
+            return res;
         }
 
         // resolve tree recursively
-        auto root = buildSubTree(a, b - 1);
+        btree& tree = res;
+        tree.root = tree.buildSubTree(a, b - 1);
 
         // find leftmost node
-        node* leftmost = root;
+        node* leftmost = tree.root;
         while (!leftmost->isLeaf()) {
             leftmost = leftmost->getChild(0);
         }
+        tree.leftmost = static_cast<leaf_node*>(leftmost);
 
-        // build result
-        return R(b - a, root, static_cast<leaf_node*>(leftmost));
+        // done
+        return res;
     }
 
 protected:
@@ -2153,59 +2414,249 @@ private:
         return !node->isEmpty() && !less(k, node->keys[0]) && less(k, node->keys[node->numElements - 1]);
     }
 
-    // Utility function for the load operation above.
+    /**
+     * Determines whether this tree contains more than the given number of elements,
+     * visiting no more elements than necessary.
+     */
+    bool hasMoreThan(std::size_t limit) const {
+        std::size_t count = 0;
+        for (auto it = begin(); it != end(); ++it) {
+            if (++count > limit) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Determines whether inserting the given number of elements is cheaper by rebuilding this
+     * tree than by inserting them one by one. Elements that are weakly equal to present ones
+     * need to be updated individually, so rebuilding requires a single comparator.
+     */
+    bool shouldRebuild(std::size_t count) const {
+        return std::is_same<Comparator, WeakComparator>::value && !hasMoreThan(count * bulk_merge_ratio);
+    }
+
+    /**
+     * Inserts the given non-empty range of random-access elements, see the range insertion above.
+     */
+    template <typename Iter>
+    void insertRange(const Iter& a, const Iter& b, std::random_access_iterator_tag) {
+        if (!std::is_same<Comparator, WeakComparator>::value || std::size_t(b - a) < bulk_load_min_size ||
+                !empty()) {
+            insertParallel(split(a, b));
+            return;
+        }
+
+        std::vector<Key> keys(a, b);
+        auto lessThan = [&](const Key& x, const Key& y) { return less(x, y); };
+        if (!std::is_sorted(keys.begin(), keys.end(), lessThan)) {
+            std::sort(keys.begin(), keys.end(), lessThan);
+        }
+        if (isSet) {
+            auto equalTo = [&](const Key& x, const Key& y) { return equal(x, y); };
+            keys.erase(std::unique(keys.begin(), keys.end(), equalTo), keys.end());
+        }
+        if (!loadIfEmpty(keys)) {
+            // some concurrent insertion was faster
+            insertParallel(split(keys.cbegin(), keys.cend()));
+        }
+    }
+
+    /**
+     * Inserts the given non-empty range of elements one by one.
+     */
+    template <typename Iter>
+    void insertRange(const Iter& a, const Iter& b, std::input_iterator_tag) {
+        operation_hints hints;
+        for (auto it = a; it != b; ++it) {
+            insert(*it, hints);
+        }
+    }
+
+    /**
+     * Builds this tree bottom-up from the given non-empty, ordered elements unless it is not
+     * empty any more. The root lock is held while building, such that concurrent insertions of
+     * first elements wait for the built tree.
+     *
+     * @return true if the tree has been built, false if it already contained elements
+     */
+    bool loadIfEmpty(const std::vector<Key>& keys) {
+        root_lock.start_write();
+        if (root != nullptr) {
+            root_lock.abort_write();
+            return false;
+        }
+        node* res = buildSubTree(keys.begin(), keys.end() - 1);
+        node* cur = res;
+        while (!cur->isLeaf()) {
+            cur = cur->getChild(0);
+        }
+        leftmost = static_cast<leaf_node*>(cur);
+        root = res;
+        root_lock.end_write();
+        return true;
+    }
+
+    /**
+     * Splits the given non-empty range of random-access elements into consecutive parts
+     * to be processed in parallel.
+     */
+    template <typename Iter>
+    static std::vector<range<Iter>> split(const Iter& a, const Iter& b) {
+        const std::size_t minPartSize = 1024;
+        const std::size_t size = b - a;
+        const std::size_t numParts =
+                std::max<std::size_t>(1, std::min<std::size_t>(MAX_THREADS * 4, size / minPartSize));
+        std::vector<range<Iter>> res;
+        for (std::size_t i = 0; i < numParts; ++i) {
+            res.emplace_back(a + size * i / numParts, a + size * (i + 1) / numParts);
+        }
+        return res;
+    }
+
+    /**
+     * Inserts the elements of the given parts one by one, the parts in parallel.
+     *
+     * @return the number of elements added to this tree
+     */
+    template <typename Iter>
+    std::size_t insertParallel(const std::vector<range<Iter>>& parts) {
+        std::size_t added = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : added) if (parts.size() > 1)
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            operation_hints hints;
+            for (const auto& key : parts[i]) {
+                added += insert(key, hints);
+            }
+        }
+        return added;
+    }
+
+    /**
+     * Merges the given consecutive, non-empty and ordered parts with the elements of this tree and
+     * rebuilds it. The elements of this tree are assigned to the parts by key range, such that all
+     * parts are merged in parallel. For sets, the parts must not contain duplicates.
+     *
+     * @return the number of elements added to this tree
+     */
     template <typename Iter>
-    static node* buildSubTree(const Iter& a, const Iter& b) {
-        const int N = node::maxKeys;
+    std::size_t mergeAndRebuild(const std::vector<range<Iter>>& parts) {
+        auto lessThan = [&](const Key& x, const Key& y) { return less(x, y); };
+        auto equalTo = [&](const Key& x, const Key& y) { return equal(x, y); };
+
+        // on ties the present elements come first and survive the de-duplication
+        std::vector<std::vector<Key>> merged(parts.size());
+        std::size_t added = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : added) if (parts.size() > 1)
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            iterator lo = (i == 0) ? begin() : lower_bound(*parts[i].begin());
+            iterator hi = (i + 1 == parts.size()) ? end() : lower_bound(*parts[i + 1].begin());
+            std::vector<Key>& res = merged[i];
+            std::merge(lo, hi, parts[i].begin(), parts[i].end(), std::back_inserter(res), lessThan);
+            if (isSet) {
+                res.erase(std::unique(res.begin(), res.end(), equalTo), res.end());
+            }
+            added += res.size() - std::distance(lo, hi);
+        }
+
+        // concatenate the merged parts
+        std::vector<std::size_t> offsets(parts.size() + 1, 0);
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            offsets[i + 1] = offsets[i] + merged[i].size();
+        }
+        std::vector<Key> keys(offsets.back());
+#pragma omp parallel for schedule(dynamic) if (parts.size() > 1)
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            std::copy(merged[i].begin(), merged[i].end(), keys.begin() + offsets[i]);
+            std::vector<Key>().swap(merged[i]);
+        }
+
+        rebuild(keys);
+        return added;
+    }
+
+    /**
+     * Replaces the content of this tree by the given ordered elements,
+     * building all nodes bottom-up.
+     */
+    void rebuild(const std::vector<Key>& keys) {
+        reset();
+        if (keys.empty()) {
+            return;
+        }
+        root = buildSubTree(keys.begin(), keys.end() - 1);
+        node* cur = root;
+        while (!cur->isLeaf()) {
+            cur = cur->getChild(0);
+        }
+        leftmost = static_cast<leaf_node*>(cur);
+    }
 
-        // divide range in N+1 sub-ranges
-        int length = (b - a) + 1;
+    // Utility function for the load operation above.
+    template <typename Iter>
+    node* buildSubTree(const Iter& a, const Iter& b) {
+        // the height of the lowest tree holding all elements, on whose bottom level all leaves are placed
+        const std::size_t length = (b - a) + 1;
+        unsigned height = 0;
+        for (std::size_t capacity = node::maxKeys; capacity < length;
+                capacity = capacity * (node::maxKeys + 1) + node::maxKeys) {
+            height++;
+        }
+        return buildSubTree(a, b, height);
+    }
 
-        // terminal case: length is less then maxKeys
-        if (length <= N) {
-            // create a leaf node
-            node* res = new leaf_node();
+    // Builds a sub-tree of the given height from the given non-empty range.
+    template <typename Iter>
+    node* buildSubTree(const Iter& a, const Iter& b, unsigned height) {
+        const std::size_t N = node::maxKeys;
+        const std::size_t length = (b - a) + 1;
+
+        // terminal case: a leaf holding all elements
+        if (height == 0) {
+            assert(length <= N && "Leaf overflow!");
+            node* res = create<leaf_node>(*arena);
             res->numElements = length;
 
-            for (int i = 0; i < length; ++i) {
+            for (std::size_t i = 0; i < length; ++i) {
                 res->keys[i] = a[i];
             }
 
             return res;
         }
 
-        // recursive case - compute step size
-        int numKeys = N;
-        int step = ((length - numKeys) / (numKeys + 1));
-
-        while (numKeys > 1 && (step < N / 2)) {
-            numKeys--;
-            step = ((length - numKeys) / (numKeys + 1));
+        // the maximum number of elements held by a sub-tree of the next lower level
+        std::size_t capacity = N;
+        for (unsigned i = 1; i < height; ++i) {
+            capacity = capacity * (N + 1) + N;
         }
 
+        // use as few children as possible, spreading the elements evenly among them
+        const std::size_t numChildren = std::max<std::size_t>(2, (length + capacity + 1) / (capacity + 1));
+        const std::size_t numKeys = numChildren - 1;
+        const std::size_t numChildElements = length - numKeys;
+
         // create inner node
-        node* res = new inner_node();
+        node* res = create<inner_node>(*arena);
         res->numElements = numKeys;
 
         Iter c = a;
-        for (int i = 0; i < numKeys; i++) {
-            // get dividing key
-            res->keys[i] = c[step];
+        for (std::size_t i = 0; i <= numKeys; i++) {
+            std::size_t size = numChildElements * (i + 1) / numChildren - numChildElements * i / numChildren;
 
             // get sub-tree
-            auto child = buildSubTree(c, c + (step - 1));
+            auto child = buildSubTree(c, c + (size - 1), height - 1);
             child->parent = res;
             child->position = i;
             res->getChildren()[i] = child;
 
-            c = c + (step + 1);
-        }
+            // get dividing key
+            if (i < numKeys) {
+                res->keys[i] = c[size];
+            }
 
-        // and the remaining part
-        auto child = buildSubTree(c, b);
-        child->parent = res;
-        child->position = numKeys;
-        res->getChildren()[numKeys] = child;
+            c = c + (size + 1);
+        }
 
         // done
         return res;
@@ -2262,12 +2713,6 @@ public:
     // A move constructor.
     btree_set(btree_set&& other) : super(std::move(other)) {}
 
-private:
-    // A constructor required by the bulk-load facility.
-    template <typename s, typename n, typename l>
-    btree_set(s size, n* root, l* leftmost) : super(size, root, leftmost) {}
-
-public:
     // Support for the assignment operator.
     btree_set& operator=(const btree_set& other) {
         super::operator=(other);
@@ -2323,12 +2768,6 @@ public:
     // A move constructor.
     btree_multiset(btree_multiset&& other) : super(std::move(other)) {}
 
-private:
-    // A constructor required by the bulk-load facility.
-    template <typename s, typename n, typename l>
-    btree_multiset(s size, n* root, l* leftmost) : super(size, root, leftmost) {}
-
-public:
     // Support for the assignment operator.
     btree_multiset& operator=(const btree_multiset& other) {
         super::operator=(other);
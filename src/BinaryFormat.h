@@ -0,0 +1,57 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file BinaryFormat.h
+ *
+ * Layout of the binary fact format used by IO=binary.
+ *
+ * A file consists of a header followed by a sequence of blocks:
+ *
+ *   header: magic (8 bytes), version (u32), sizeof(RamDomain) (u32), arity (u32),
+ *           one byte per column that is 1 for symbol columns, padding to 8 bytes
+ *   block:  number of tuples (u64), number of new symbols (u64),
+ *           the new symbols as (length (u32), characters), padding to 8 bytes,
+ *           then one array of RamDomain values per column
+ *
+ * Symbol columns hold file-local symbol numbers. Each block introduces the
+ * symbols it uses for the first time; numbers are assigned consecutively
+ * across blocks, so a reader only has to intern every symbol once.
+ * All values are stored in the byte order of the writing machine.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace souffle {
+
+struct BinaryFormat {
+    static constexpr const char* MAGIC = "SOUFBIN";
+    static constexpr size_t MAGIC_SIZE = 8;
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t ALIGNMENT = 8;
+
+    /** Number of padding bytes needed after offset to reach the next aligned offset */
+    static size_t padding(size_t offset) {
+        return (ALIGNMENT - offset % ALIGNMENT) % ALIGNMENT;
+    }
+
+    /** Check whether the first bytes of a buffer hold the magic number of the format */
+    static bool hasMagic(const char* data, size_t size) {
+        return size >= MAGIC_SIZE && std::memcmp(data, MAGIC, MAGIC_SIZE) == 0;
+    }
+};
+
+} /* namespace souffle */
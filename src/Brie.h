@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include "Arena.h"
 #include "CompiledTuple.h"
 #include "RamTypes.h"
 #include "Util.h"
@@ -34,6 +35,7 @@
 #include <bitset>
 #include <cstring>
 #include <iterator>
+#include <memory>
 #include <utility>
 
 namespace souffle {
@@ -175,6 +177,12 @@ private:
         index_type firstOffset;
     };
 
+    // the arena holding all nodes of this array, created on the first allocation unless shared
+    std::atomic<Arena*> arena;
+
+    // whether this array owns its arena or shares the arena of an enclosing structure
+    bool ownsArena;
+
     union {
         RootInfo unsynced;         // for sequential operations
         volatile RootInfo synced;  // for synchronized operations
@@ -184,7 +192,20 @@ public:
     /**
      * A default constructor creating an empty sparse array.
      */
-    SparseArray() : unsynced(RootInfo{nullptr, 0, 0, nullptr, std::numeric_limits<index_type>::max()}) {}
+    SparseArray()
+            : arena(nullptr), ownsArena(true),
+              unsynced(RootInfo{nullptr, 0, 0, nullptr, std::numeric_limits<index_type>::max()}) {}
+
+    /**
+     * A constructor creating an empty sparse array allocating its nodes from the
+     * given arena, which is shared with an enclosing structure. The nodes are only
+     * released when the arena is reset or released by its owner.
+     */
+    explicit SparseArray(Arena& shared)
+            : arena(&shared), ownsArena(false),
+              unsynced(RootInfo{nullptr, 0, 0, nullptr, std::numeric_limits<index_type>::max()}) {
+        assert(alignof(Node) <= shared.getAlignment() && "Insufficient alignment of shared arena!");
+    }
 
     /**
      * A copy constructor for sparse arrays. It creates a deep
@@ -192,7 +213,8 @@ public:
      * array instance.
      */
     SparseArray(const SparseArray& other)
-            : unsynced(RootInfo{clone(other.unsynced.root, other.unsynced.levels), other.unsynced.levels,
+            : arena(nullptr), ownsArena(true),
+              unsynced(RootInfo{clone(other.unsynced.root, other.unsynced.levels), other.unsynced.levels,
                       other.unsynced.offset, nullptr, other.unsynced.firstOffset}) {
         if (unsynced.root) {
             unsynced.root->parent = nullptr;
@@ -206,11 +228,15 @@ public:
      * handed in array.
      */
     SparseArray(SparseArray&& other)
-            : unsynced(RootInfo{other.unsynced.root, other.unsynced.levels, other.unsynced.offset,
+            : arena(other.arena.load(std::memory_order_relaxed)), ownsArena(other.ownsArena),
+              unsynced(RootInfo{other.unsynced.root, other.unsynced.levels, other.unsynced.offset,
                       other.unsynced.first, other.unsynced.firstOffset}) {
+        other.arena.store(nullptr, std::memory_order_relaxed);
+        other.ownsArena = true;
         other.unsynced.root = nullptr;
         other.unsynced.levels = 0;
         other.unsynced.first = nullptr;
+        other.unsynced.firstOffset = std::numeric_limits<index_type>::max();
     }
 
     /**
@@ -219,6 +245,9 @@ public:
      */
     ~SparseArray() {
         clean();
+        if (ownsArena) {
+            delete arena.load(std::memory_order_relaxed);
+        }
     }
 
     /**
@@ -253,6 +282,10 @@ public:
         clean();
 
         // harvest content
+        Arena* otherArena = other.arena.load(std::memory_order_relaxed);
+        other.arena.store(arena.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        arena.store(otherArena, std::memory_order_relaxed);
+        std::swap(ownsArena, other.ownsArena);
         unsynced.root = other.unsynced.root;
         unsynced.levels = other.unsynced.levels;
         unsynced.offset = other.unsynced.offset;
@@ -263,6 +296,7 @@ public:
         other.unsynced.root = nullptr;
         other.unsynced.levels = 0;
         other.unsynced.first = nullptr;
+        other.unsynced.firstOffset = std::numeric_limits<index_type>::max();
 
         // done
         return *this;
@@ -333,16 +367,45 @@ public:
 
     /**
      * Resets the content of this array to default values for each contained
-     * element.
+     * element and releases the memory of its nodes, unless the arena is shared.
      */
     void clear() {
+        reset();
+        Arena* owned = (ownsArena) ? arena.load(std::memory_order_relaxed) : nullptr;
+        if (owned) {
+            owned->release();
+        }
+    }
+
+    /**
+     * Resets the content of this array to default values for each contained
+     * element, keeping the memory of its nodes for subsequent insertions.
+     * This takes constant time in the size of the array.
+     */
+    void reset() {
         clean();
-        unsynced.root = nullptr;
-        unsynced.levels = 0;
         unsynced.first = nullptr;
         unsynced.firstOffset = std::numeric_limits<index_type>::max();
     }
 
+    /**
+     * Obtains the arena holding the nodes of this array, creating it on first use
+     * unless it is shared. Nested structures may allocate from it as well.
+     */
+    Arena& getArena() {
+        Arena* res = arena.load(std::memory_order_acquire);
+        if (res) {
+            return *res;
+        }
+        // lock-free lazy creation of the owned arena
+        auto* fresh = new Arena(alignof(Node));
+        if (arena.compare_exchange_strong(res, fresh, std::memory_order_acq_rel)) {
+            return *fresh;
+        }
+        delete fresh;  // some other thread was faster => use its arena
+        return *res;
+    }
+
     /**
      * A struct to be utilized as a local, temporal context by client code
      * to speed up the execution of various operations (optional parameter).
@@ -593,7 +656,7 @@ private:
             }
 
             // somebody else was faster => use standard insertion procedure
-            delete info.root;
+            // (the node stays in the arena until it is reset)
 
             // retrieve new root info
             info = getRootInfo();
@@ -636,7 +699,7 @@ private:
                 // try to update next
                 if (!aNext.compare_exchange_strong(next, newNext)) {
                     // some other thread was faster => use updated next
-                    delete newNext;
+                    // (newNext stays in the arena until it is reset)
                 } else {
                     // the locally created next is the new next
                     next = newNext;
@@ -769,7 +832,7 @@ private:
      * @param src the node to be cloned
      * @param levels the height of the cloned node
      */
-    static void merge(const Node* parent, Node*& trg, const Node* src, int levels) {
+    void merge(const Node* parent, Node*& trg, const Node* src, int levels) {
         // if other side is null => done
         if (!src) return;
 
@@ -841,8 +904,17 @@ public:
             node = &next;
         }
 
-        // merge sub-branches from here
-        merge((*node)->parent, *node, other.unsynced.root, level);
+        // merge sub-branches from here, the branches below the top node in parallel
+        if (level == 0) {
+            merge((*node)->parent, *node, other.unsynced.root, level);
+        } else {
+            Node* trg = *node;
+            const Node* src = other.unsynced.root;
+#pragma omp parallel for schedule(dynamic) if (level > 1)
+            for (int i = 0; i < NUM_CELLS; ++i) {
+                merge(trg, trg->cell[i].ptr, src->cell[i].ptr, level - 1);
+            }
+        }
 
         // update first
         if (unsynced.firstOffset > other.unsynced.firstOffset) {
@@ -1198,45 +1270,37 @@ private:
     // --------------------------------------------------------------------------
 
     /**
-     * Creates new nodes and initializes them with 0.
-     */
-    static Node* newNode() {
-        auto* res = new Node();
-        std::memset(res->cell, 0, sizeof(Cell) * NUM_CELLS);
-        return res;
-    }
-
-    /**
-     * Destroys a node and all its sub-nodes recursively.
+     * Creates new nodes in the arena of this array and initializes them with 0.
+     * Value-initializing a node zero-initializes its cells, including the bytes of
+     * union members larger than the first one.
      */
-    static void freeNodes(Node* node, int level) {
-        if (!node) return;
-        if (level != 0) {
-            for (int i = 0; i < NUM_CELLS; i++) {
-                freeNodes(node->cell[i].ptr, level - 1);
-            }
-        }
-        delete node;
+    Node* newNode() {
+        return new (getArena().allocate(sizeof(Node))) Node();
     }
 
     /**
-     * Conducts a cleanup of the internal tree structure.
+     * Conducts a cleanup of the internal tree structure. Nodes are trivially
+     * destructible, such that discarding the content of the arena suffices.
+     * Nodes in a shared arena are left to its owner.
      */
     void clean() {
-        freeNodes(unsynced.root, unsynced.levels);
+        Arena* owned = (ownsArena) ? arena.load(std::memory_order_relaxed) : nullptr;
+        if (owned) {
+            owned->reset();
+        }
         unsynced.root = nullptr;
         unsynced.levels = 0;
     }
 
     /**
-     * Clones the given node and all its sub-nodes.
+     * Clones the given node and all its sub-nodes into the arena of this array.
      */
-    static Node* clone(const Node* node, int level) {
+    Node* clone(const Node* node, int level) {
         // support null-pointers
         if (!node) return nullptr;
 
         // create a clone
-        auto* res = new Node();
+        auto* res = new (getArena().allocate(sizeof(Node))) Node();
 
         // handle leaf level
         if (level == 0) {
@@ -1337,10 +1401,8 @@ private:
         if (tryUpdateRootInfo(info)) {
             // success => final step, update parent of old root
             oldRoot->parent = info.root;
-        } else {
-            // throw away temporary new node
-            delete newRoot;
         }
+        // otherwise the temporary new node stays in the arena until it is reset
     }
 
     /**
@@ -1418,6 +1480,9 @@ public:
     // a simple default constructor
     SparseBitMap() = default;
 
+    // a constructor allocating all nodes from the given arena shared with an enclosing structure
+    explicit SparseBitMap(Arena& arena) : store(arena) {}
+
     // a default copy constructor
     SparseBitMap(const SparseBitMap&) = default;
 
@@ -1514,6 +1579,13 @@ public:
         store.clear();
     }
 
+    /**
+     * Resets all contained bits to 0, keeping the allocated memory for reuse.
+     */
+    void reset() {
+        store.reset();
+    }
+
     /**
      * Determines the number of bits set.
      */
@@ -1702,10 +1774,55 @@ public:
         if (!(mask & (1llu << (i & LEAF_INDEX_MASK)))) return end();
 
         // OK, it is there => create iterator
-        mask &= ((1ull << (i & LEAF_INDEX_MASK)) - 1);  // remove all bits before pos i
+        mask &= ~((2ull << (i & LEAF_INDEX_MASK)) - 1);  // remove all bits up to pos i
         return iterator(it, mask, i);
     }
 
+    /**
+     * Walks the words of this map and reports the first index of a word to the given operation
+     * whenever at least target indices have been counted since the last report. The count is
+     * carried in and out, such that consecutive maps may be split as one sequence.
+     *
+     * @param target the number of indices between two reports
+     * @param count the number of indices counted since the last report
+     * @param split the operation receiving the indices starting new parts
+     */
+    template <typename Op>
+    void splitBalanced(std::size_t target, std::size_t& count, const Op& split) const {
+        for (const auto& cur : store) {
+            if (count >= target) {
+                split(static_cast<index_type>((cur.first << LEAF_INDEX_WIDTH) | __builtin_ctzll(cur.second)));
+                count = 0;
+            }
+            count += __builtin_popcountll(cur.second);
+        }
+    }
+
+    /**
+     * Computes a partition of an approximate number of chunks holding similar numbers
+     * of indices. Chunks are split between words of 64 bits.
+     *
+     * @param chunks the number of chunks requested
+     * @return a list of sub-ranges forming a partition of the content of this map
+     */
+    std::vector<range<iterator>> partition(unsigned chunks = 500) const {
+        std::vector<range<iterator>> res;
+
+        // shortcut for empty map
+        if (empty()) return res;
+
+        std::size_t count = 0;
+        auto priv = begin();
+        splitBalanced(std::max(size() / std::max(chunks, 1u), std::size_t(1)), count, [&](index_type i) {
+            auto cur = find(i);
+            res.push_back(make_range(priv, cur));
+            priv = cur;
+        });
+        // add final chunk
+        res.push_back(make_range(priv, end()));
+        return res;
+    }
+
     /**
      * A debugging utility printing the internal structure of this map to the
      * given output stream.
@@ -2031,28 +2148,12 @@ class Trie : public detail::TrieBase<Dim, Trie<Dim>> {
     // the type of the nested tries (1 dimension less)
     using nested_trie_type = Trie<Dim - 1>;
 
-    // the merge operation capable of merging two nested tries
-    struct nested_trie_merger {
-        nested_trie_type* operator()(nested_trie_type* a, const nested_trie_type* b) const {
-            if (!b) return a;
-            if (!a) return new nested_trie_type(*b);
-            a->insertAll(*b);
-            return a;
-        }
-    };
-
-    // the operation capable of cloning a nested trie
-    struct nested_trie_cloner {
-        nested_trie_type* operator()(nested_trie_type* a) const {
-            if (!a) return a;
-            return new nested_trie_type(*a);
-        }
-    };
-
-    // the data structure utilized for indexing nested tries
+    // the data structure utilized for indexing nested tries; nested tries are placed in the
+    // arena of the store of the top-level trie, thus they are merged and copied by this trie
+    // rather than by the store
     using store_type = SparseArray<nested_trie_type*,
-            6,  // = 2^6 entries per block
-            nested_trie_merger, nested_trie_cloner>;
+            6  // = 2^6 entries per block
+            >;
 
     // the actual data store
     store_type store;
@@ -2164,15 +2265,38 @@ public:
     using base::contains;
     using base::insert;
 
+    // a simple default constructor
+    Trie() = default;
+
     /**
-     * A simple destructore.
+     * A constructor for nested tries, allocating all levels from the given arena.
+     * Tries placed in an arena are never destroyed; their memory is reclaimed with it.
      */
-    ~Trie() {
-        for (auto& cur : store) {
-            delete cur.second;  // clears all nested tries
-        }
+    explicit Trie(Arena& arena) : store(arena) {}
+
+    /**
+     * A copy constructor creating a deep copy of the given trie in a new arena.
+     */
+    Trie(const Trie& other) : base(other) {
+        insertAll(other);
     }
 
+    // a default r-value copy constructor, taking over the arena of the given trie
+    Trie(Trie&&) = default;
+
+    /**
+     * An assignment creating a deep copy of the given trie in the arena of this trie.
+     */
+    Trie& operator=(const Trie& other) {
+        if (this == &other) return *this;
+        clear();
+        insertAll(other);
+        return *this;
+    }
+
+    // a default r-value assignment operator
+    Trie& operator=(Trie&&) = default;
+
     /**
      * Determines whether this trie is empty or not.
      */
@@ -2209,18 +2333,21 @@ public:
     }
 
     /**
-     * Removes all entries within this trie.
+     * Removes all entries within this trie. Since all levels share the arena
+     * of the top-level store, this releases it without visiting nested tries.
      */
     void clear() {
-        // delete lower levels
-        for (auto& cur : store) {
-            delete cur.second;
-        }
-
-        // clear store
         store.clear();
     }
 
+    /**
+     * Removes all entries within this trie, keeping the memory of all levels
+     * for reuse. This takes constant time in the size of the trie.
+     */
+    void reset() {
+        store.reset();
+    }
+
     /**
      * Inserts a new entry.
      *
@@ -2275,7 +2402,21 @@ public:
      * @param other the elements to be inserted into this trie
      */
     void insertAll(const Trie& other) {
-        store.addAll(other.store);
+        if (this == &other || other.empty()) return;
+
+        // merge the nested tries of other into the corresponding ones of this trie, in parallel
+        std::vector<std::pair<RamDomain, const nested_trie_type*>> nested;
+        for (const auto& cur : other.store) {
+            nested.emplace_back(cur.first, cur.second);
+        }
+#pragma omp parallel if (nested.size() > 1)
+        {
+            typename store_type::op_context ctxt;
+#pragma omp for schedule(dynamic)
+            for (std::size_t i = 0; i < nested.size(); ++i) {
+                getOrCreateNested(nested[i].first, ctxt)->insertAll(*nested[i].second);
+            }
+        }
     }
 
     /**
@@ -2372,6 +2513,9 @@ public:
      * of this trie. Thus, the union of the resulting set of disjoint ranges is
      * equivalent to the content of this trie.
      *
+     * The chunks hold similar numbers of tuples. Sub-tries holding more tuples than a
+     * chunk, e.g. below a first level with few distinct values, are split at deeper levels.
+     *
      * @param chunks the number of chunks requested
      * @return a list of sub-ranges forming a partition of the content of this trie
      */
@@ -2381,17 +2525,15 @@ public:
         // shortcut for empty trie
         if (this->empty()) return res;
 
-        // use top-level elements for partitioning
-        int step = std::max(store.size() / chunks, size_t(1));
-
-        int c = 1;
+        std::size_t count = 0;
+        entry_type first;
         auto priv = begin();
-        for (auto it = store.begin(); it != store.end(); ++it, c++) {
-            if (c % step != 0 || c == 1) continue;
-            auto cur = iterator(it);
-            res.push_back(make_range(priv, cur));
-            priv = cur;
-        }
+        splitBalanced<0>(std::max(size() / std::max(chunks, 1u), std::size_t(1)), count, first,
+                [&](const entry_type& entry) {
+                    auto cur = find(entry);
+                    res.push_back(make_range(priv, cur));
+                    priv = cur;
+                });
         // add final chunk
         res.push_back(make_range(priv, end()));
         return res;
@@ -2419,6 +2561,35 @@ private:
         return iterator_core<I>(store.begin(), entry);
     }
 
+    /**
+     * Walks this sub-trie and reports the first tuple of a nested trie to the given operation
+     * whenever at least target tuples have been counted since the last report. Nested tries
+     * holding more than target tuples are walked recursively.
+     *
+     * @tparam I the component index associated to this level
+     * @param target the number of tuples between two reports
+     * @param count the number of tuples counted since the last report
+     * @param entry the tuple whose components up to I-1 hold the prefix of this sub-trie
+     * @param split the operation receiving the tuples starting new parts
+     */
+    template <unsigned I, typename Tuple, typename Op>
+    void splitBalanced(std::size_t target, std::size_t& count, Tuple& entry, const Op& split) const {
+        for (const auto& cur : store) {
+            entry[I] = cur.first;
+            const std::size_t size = cur.second->size();
+            if (size > target) {
+                cur.second->template splitBalanced<I + 1>(target, count, entry, split);
+                continue;
+            }
+            if (count >= target) {
+                cur.second->template getBeginCoreIterator<I + 1>(entry);
+                split(entry);
+                count = 0;
+            }
+            count += size;
+        }
+    }
+
     /**
      * The internally utilized implementation of the insert operation inserting
      * a given tuple into this sub-trie.
@@ -2431,9 +2602,6 @@ private:
      */
     template <unsigned I, typename Tuple>
     bool insert_internal(const Tuple& tuple, op_context& ctxt) {
-        using value_t = typename store_type::value_type;
-        using atomic_value_t = typename store_type::atomic_value_type;
-
         // check context
         if (ctxt.lastNested && ctxt.lastQuery == tuple[I]) {
             base::hint_stats.inserts.addHit();
@@ -2442,37 +2610,52 @@ private:
             base::hint_stats.inserts.addMiss();
         }
 
+        // lookup or create nested
+        nested_trie_type* nextPtr = getOrCreateNested(tuple[I], ctxt.local);
+
+        // clear context if necessary
+        if (nextPtr != ctxt.lastNested) {
+            ctxt.lastQuery = tuple[I];
+            ctxt.lastNested = nextPtr;
+            ctxt.nestedCtxt = typename op_context::nested_ctxt();
+        }
+
+        // conduct recursive step
+        return nextPtr->template insert_internal<I + 1>(tuple, ctxt.nestedCtxt);
+    }
+
+    /**
+     * Obtains the nested trie associated to the given value, creating it if necessary.
+     * New nested tries are placed in the arena shared by all levels of this trie.
+     *
+     * @param value the value of the component associated to this level
+     * @param ctxt a operation context of the store to exploit temporal locality
+     * @return the nested trie associated to the given value
+     */
+    nested_trie_type* getOrCreateNested(RamDomain value, typename store_type::op_context& ctxt) {
         // lookup nested
-        atomic_value_t& next = store.getAtomic(tuple[I], ctxt.local);
+        typename store_type::atomic_value_type& next = store.getAtomic(value, ctxt);
 
         // get pure pointer to next level
-        value_t nextPtr = next;
+        nested_trie_type* nextPtr = next;
 
         // conduct a lock-free lazy-creation of nested trees
         if (!nextPtr) {
             // create a new sub-tree
-            auto newNested = new nested_trie_type();
+            Arena& arena = store.getArena();
+            assert(alignof(nested_trie_type) <= arena.getAlignment() && "Insufficient alignment!");
+            auto newNested = new (arena.allocate(sizeof(nested_trie_type))) nested_trie_type(arena);
 
             // register new sub-tree atomically
-            if (next.compare_exchange_weak(nextPtr, newNested)) {
+            if (next.compare_exchange_strong(nextPtr, newNested)) {
                 nextPtr = newNested;  // worked
-            } else {
-                delete newNested;  // some other thread was faster => use its version
             }
+            // otherwise some other thread was faster => use its version, newNested stays in the arena
         }
 
         // make sure a next has been established
         assert(nextPtr);
-
-        // clear context if necessary
-        if (nextPtr != ctxt.lastNested) {
-            ctxt.lastQuery = tuple[I];
-            ctxt.lastNested = nextPtr;
-            ctxt.nestedCtxt = typename op_context::nested_ctxt();
-        }
-
-        // conduct recursive step
-        return nextPtr->template insert_internal<I + 1>(tuple, ctxt.nestedCtxt);
+        return nextPtr;
     }
 
     /**
@@ -2547,6 +2730,13 @@ public:
         present = false;
     }
 
+    /**
+     * Clears the content of this trie.
+     */
+    void reset() {
+        present = false;
+    }
+
     /**
      * Determines whether this trie is empty or not.
      */
@@ -2764,6 +2954,12 @@ public:
     using base::contains;
     using base::insert;
 
+    // a simple default constructor
+    Trie() = default;
+
+    // a constructor for nested tries, allocating all nodes from the given arena
+    explicit Trie(Arena& arena) : map(arena) {}
+
     /**
      * Determines whether this trie is empty or not.
      */
@@ -2793,6 +2989,13 @@ public:
         map.clear();
     }
 
+    /**
+     * Removes all elements form this trie, keeping the allocated memory for reuse.
+     */
+    void reset() {
+        map.reset();
+    }
+
     /**
      * Inserts the given tuple into this trie.
      *
@@ -2944,19 +3147,11 @@ public:
         // shortcut for empty trie
         if (this->empty()) return res;
 
-        // use top-level elements for partitioning
-        int step = std::max(map.size() / chunks, size_t(1));
-
-        int c = 1;
-        auto priv = begin();
-        for (auto it = map.begin(); it != map.end(); ++it, c++) {
-            if (c % step != 0 || c == 1) continue;
-            auto cur = iterator(it);
-            res.push_back(make_range(priv, cur));
-            priv = cur;
+        // split the bit-map into parts of similar sizes
+        for (const auto& cur : map.partition(chunks)) {
+            auto last = (cur.end() == map.end()) ? end() : iterator(cur.end());
+            res.push_back(make_range(iterator(cur.begin()), last));
         }
-        // add final chunk
-        res.push_back(make_range(priv, end()));
         return res;
     }
 
@@ -3018,6 +3213,24 @@ private:
         return iterator_core<I>(map.begin(), entry);
     }
 
+    /**
+     * Walks this sub-trie and reports the tuple starting a new part to the given operation
+     * whenever at least target tuples have been counted since the last report.
+     *
+     * @tparam I the component index associated to this level
+     * @param target the number of tuples between two reports
+     * @param count the number of tuples counted since the last report
+     * @param entry the tuple whose components up to I-1 hold the prefix of this sub-trie
+     * @param split the operation receiving the tuples starting new parts
+     */
+    template <unsigned I, typename Tuple, typename Op>
+    void splitBalanced(std::size_t target, std::size_t& count, Tuple& entry, const Op& split) const {
+        map.splitBalanced(target, count, [&](RamDomain value) {
+            entry[I] = value;
+            split(entry);
+        });
+    }
+
     /**
      * The internally utilized implementation of the insert operation inserting
      * a given tuple into this sub-trie.
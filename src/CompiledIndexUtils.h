@@ -1547,4 +1547,20 @@ private:
 
 }  // end namespace ram
 
+namespace detail {
+
+/**
+ * Tuples ordered by an index comparator are searched with vector instructions on the first
+ * column of the index order (see simd_search).
+ */
+template <std::size_t Arity, unsigned First, unsigned... Rest>
+struct simd_key<ram::Tuple<RamDomain, Arity>, ram::index_utils::comparator<First, Rest...>,
+        typename std::enable_if<sizeof(RamDomain) == sizeof(int32_t)>::type> {
+    static constexpr bool enabled = true;
+    static constexpr std::size_t stride = Arity;
+    static constexpr std::size_t offset = First;
+};
+
+}  // end namespace detail
+
 }  // end namespace souffle
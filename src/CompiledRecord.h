@@ -20,6 +20,8 @@
 #include "ParallelUtils.h"
 #include "Util.h"
 
+#include <array>
+#include <atomic>
 #include <limits>
 #include <memory>
 #include <unordered_map>
@@ -74,12 +76,23 @@ namespace detail {
 
 /**
  * A bidirectional mapping between tuples and reference indices.
+ *
+ * The mapping from tuples to indices is split into shards selected by the hash of the tuple, each guarded
+ * by its own lock. Tuples are stored in append-only blocks which are never moved, so that unpacking does not
+ * require any synchronisation.
  */
 template <typename Tuple>
 class RecordMap {
     // create blocks of a million entries
     static const std::size_t BLOCK_SIZE = 1 << 20;
 
+    // enough blocks to cover all positive indices
+    static const std::size_t MAX_BLOCKS =
+            (std::size_t(std::numeric_limits<RamDomain>::max()) + 1) / BLOCK_SIZE;
+
+    // the number of shards of the mapping from tuples to indices, a power of two
+    static const std::size_t SHARDS = 64;
+
     /** The definition of the tuple type handled by this instance */
     using tuple_type = Tuple;
 
@@ -87,56 +100,66 @@ class RecordMap {
     using block_type = std::array<tuple_type, BLOCK_SIZE>;
 
     /** The type utilized for the block index */
-    using block_index_type = std::vector<std::unique_ptr<block_type>>;
+    using block_index_type = std::array<std::atomic<block_type*>, MAX_BLOCKS>;
+
+    /** A shard of the mapping from tuples to references/indices */
+    struct Shard {
+        /** a lock for the pack operations of this shard */
+        Lock pack_lock;
+
+        /** The mapping from tuples to references/indices */
+        std::unordered_map<tuple_type, RamDomain> r2i;
+    };
 
     /** The mapping from tuples to references/indices */
-    std::unordered_map<tuple_type, RamDomain> r2i;
+    std::array<Shard, SHARDS> shards;
 
     /** The mapping from indices to tuples */
     block_index_type i2r;
 
-    /** a lock for the pack operation */
-    Lock pack_lock;
+    /** The next free index, 0 is skipped for the Nil element */
+    std::atomic<RamDomain> next{1};
 
 public:
-    RecordMap() = default;
+    RecordMap() {
+        for (auto& block : i2r) {
+            block.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~RecordMap() {
+        for (auto& block : i2r) {
+            delete block.load(std::memory_order_relaxed);
+        }
+    }
 
     /**
      * Packs the given tuple -- and may create a new reference if necessary.
      */
     RamDomain pack(const tuple_type& tuple) {
-        RamDomain index;
-
-        {
-            // lock pack operation
-            auto leas = pack_lock.acquire();  // lock hold till end of scope
-            (void)leas;                       // avoid warning
-
-            // try lookup
-            auto pos = r2i.find(tuple);
-            if (pos != r2i.end()) {
-                // take the previously assigned value
-                index = pos->second;
-            } else {
-                // add tuple to index
-                index = r2i.size() + 1;  // since 0 is skipped for the Nil element
-                r2i[tuple] = index;
-
-                // assert that new index is smaller than the range
-                assert(index != std::numeric_limits<RamDomain>::max());
-
-                if (index / BLOCK_SIZE == i2r.size()) {
-                    i2r.push_back(std::make_unique<block_type>());
-                }
-
-                // create entry for unpacking
-                auto& list = i2r[index / BLOCK_SIZE];
-
-                // insert tuple
-                (*list)[index % BLOCK_SIZE] = tuple;
-            }
+        Shard& shard = shards[std::hash<tuple_type>()(tuple) & (SHARDS - 1)];
+
+        // lock pack operation of the shard
+        auto leas = shard.pack_lock.acquire();  // lock hold till end of scope
+        (void)leas;                             // avoid warning
+
+        // try lookup
+        auto pos = shard.r2i.find(tuple);
+        if (pos != shard.r2i.end()) {
+            // take the previously assigned value
+            return pos->second;
         }
 
+        // add tuple to index
+        RamDomain index = next.fetch_add(1, std::memory_order_relaxed);
+
+        // assert that new index is smaller than the range
+        assert(index != std::numeric_limits<RamDomain>::max());
+
+        // create entry for unpacking
+        getBlock(index / BLOCK_SIZE)[index % BLOCK_SIZE] = tuple;
+        shard.r2i[tuple] = index;
+
         // done
         return index;
     }
@@ -146,7 +169,23 @@ public:
      */
     const tuple_type& unpack(RamDomain index) {
         // just look up the right spot
-        return (*(i2r[index / BLOCK_SIZE]))[index % BLOCK_SIZE];
+        return (*i2r[index / BLOCK_SIZE].load(std::memory_order_acquire))[index % BLOCK_SIZE];
+    }
+
+private:
+    /** Obtains a block of tuples, allocating it if necessary */
+    block_type& getBlock(std::size_t blockIndex) {
+        block_type* block = i2r[blockIndex].load(std::memory_order_acquire);
+        if (block != nullptr) {
+            return *block;
+        }
+        auto* newBlock = new block_type();
+        if (i2r[blockIndex].compare_exchange_strong(block, newBlock, std::memory_order_acq_rel)) {
+            return *newBlock;
+        }
+        // another thread allocated the block first
+        delete newBlock;
+        return *block;
     }
 };
 
@@ -22,14 +22,19 @@
 #include "souffle/CompiledRecord.h"
 #include "souffle/CompiledRelation.h"
 #include "souffle/CompiledTuple.h"
+#include "souffle/CompressedSet.h"
+#include "souffle/HashIndex.h"
 #include "souffle/IODirectives.h"
 #include "souffle/IOSystem.h"
+#include "souffle/LeapfrogTrieJoin.h"
 #include "souffle/Logger.h"
 #include "souffle/ParallelUtils.h"
 #include "souffle/ProfileEvent.h"
 #include "souffle/RamTypes.h"
+#include "souffle/RelationStats.h"
 #include "souffle/SignalHandler.h"
 #include "souffle/SouffleInterface.h"
+#include "souffle/StratumScheduler.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/Util.h"
 #include "souffle/WriteStream.h"
@@ -235,6 +240,9 @@ public:
     void purge() {
         data = false;
     }
+    void reset() {
+        data = false;
+    }
     void printHintStatistics(std::ostream& o, std::string prefix) const {}
 };
 
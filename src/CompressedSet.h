@@ -0,0 +1,528 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file CompressedSet.h
+ *
+ * A sorted set of tuples stored in front-coded blocks, trading some CPU
+ * time for a compact representation of wide relations.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "CompiledTuple.h"
+#include "ParallelUtils.h"
+#include "RamTypes.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+namespace detail {
+
+/**
+ * The encoding of a tuple relative to its predecessor in a block.
+ *
+ * A tuple is written as the length of the prefix it shares with its predecessor (one byte),
+ * the difference to the predecessor in the first differing column, and the remaining columns.
+ * Values are written as variable-length integers of seven bits per byte; the remaining columns
+ * are zigzag-encoded first so that small negative values remain short as well.
+ */
+template <unsigned Dim>
+struct FrontCoding {
+    using entry_type = ram::Tuple<RamDomain, Dim>;
+    using unsigned_type = typename std::make_unsigned<RamDomain>::type;
+
+    /** Append the encoding of the tuple to the given buffer */
+    static void encode(std::vector<uint8_t>& out, const entry_type& tuple, const entry_type& pred) {
+        unsigned prefix = 0;
+        while (tuple[prefix] == pred[prefix]) {
+            prefix++;
+        }
+        out.push_back(static_cast<uint8_t>(prefix));
+        // the tuple succeeds its predecessor, hence the difference is positive
+        writeVarint(
+                out, static_cast<unsigned_type>(tuple[prefix]) - static_cast<unsigned_type>(pred[prefix]));
+        for (unsigned i = prefix + 1; i < Dim; ++i) {
+            writeVarint(out, zigzag(tuple[i]));
+        }
+    }
+
+    /** Decode the tuple at the given position, which holds its predecessor on entry */
+    static void decode(const uint8_t* data, std::size_t& pos, entry_type& tuple) {
+        const unsigned prefix = data[pos++];
+        tuple[prefix] =
+                static_cast<RamDomain>(static_cast<unsigned_type>(tuple[prefix]) + readVarint(data, pos));
+        for (unsigned i = prefix + 1; i < Dim; ++i) {
+            tuple[i] = unzigzag(readVarint(data, pos));
+        }
+    }
+
+    static void writeVarint(std::vector<uint8_t>& out, unsigned_type value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static unsigned_type readVarint(const uint8_t* data, std::size_t& pos) {
+        unsigned_type value = 0;
+        unsigned shift = 0;
+        while ((data[pos] & 0x80) != 0) {
+            value |= static_cast<unsigned_type>(data[pos++] & 0x7f) << shift;
+            shift += 7;
+        }
+        return value | (static_cast<unsigned_type>(data[pos++]) << shift);
+    }
+
+    static unsigned_type zigzag(RamDomain value) {
+        return (static_cast<unsigned_type>(value) << 1) ^ (value < 0 ? ~unsigned_type(0) : unsigned_type(0));
+    }
+
+    static RamDomain unzigzag(unsigned_type value) {
+        return static_cast<RamDomain>((value >> 1) ^ (unsigned_type(0) - (value & 1)));
+    }
+};
+
+}  // end namespace detail
+
+/**
+ * A set of tuples of a fixed arity in lexicographical order, stored in front-coded blocks.
+ *
+ * The first tuple of each block is kept uncompressed as the key of the block in an ordered map,
+ * all others are encoded relative to their predecessor (see detail::FrontCoding). Since tuples
+ * of a sorted relation tend to share long prefixes with their neighbours, a tuple of a wide
+ * relation mostly occupies a few bytes instead of Dim values. Inserting a tuple only re-encodes
+ * its successor; blocks exceeding block_size tuples are split in halves.
+ *
+ * The set offers the interface of a Trie of the same dimension, such that it can be used
+ * wherever a trie stores the tuples of a relation in one of its index orders. Insertions may be
+ * conducted concurrently: an insertion into an existing block only locks this block, while the
+ * rare insertions changing the set of blocks lock the set exclusively. Lookups must not run
+ * concurrently with insertions, which holds for relations during the evaluation of a Datalog program.
+ */
+template <unsigned Dim>
+class CompressedSet {
+    static_assert(Dim > 0, "nullary relations are not stored in compressed sets");
+
+public:
+    using entry_type = ram::Tuple<RamDomain, Dim>;
+
+    /** The maximum number of tuples of a block */
+    static constexpr std::size_t block_size = 64;
+
+private:
+    using coding = detail::FrontCoding<Dim>;
+
+    struct block {
+        // the encoded tuples following the key of the block
+        std::vector<uint8_t> data;
+
+        // the number of tuples of the block, including its key
+        std::size_t size = 1;
+
+        // serialises insertions into this block
+        SpinLock lock;
+
+        block() = default;
+
+        block(block&& other) : data(std::move(other.data)), size(other.size) {}
+    };
+
+    using block_map = std::map<entry_type, block>;
+    using block_iterator = typename block_map::const_iterator;
+
+public:
+    /** An iterator decoding the tuples of the set in order */
+    class iterator : public std::iterator<std::forward_iterator_tag, entry_type> {
+        friend class CompressedSet;
+
+        // the block of the current tuple, and the end of the block map
+        block_iterator cur;
+        block_iterator last;
+
+        // the position of the successor of the current tuple in the block
+        std::size_t pos = 0;
+
+        // the decoded current tuple
+        entry_type value = {};
+
+        iterator(block_iterator cur, block_iterator last) : cur(cur), last(last) {
+            if (cur != last) {
+                value = cur->first;
+            }
+        }
+
+    public:
+        iterator() = default;
+
+        bool operator==(const iterator& other) const {
+            return cur == other.cur && pos == other.pos;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        const entry_type& operator*() const {
+            return value;
+        }
+
+        const entry_type* operator->() const {
+            return &value;
+        }
+
+        iterator& operator++() {
+            const auto& data = cur->second.data;
+            if (pos < data.size()) {
+                coding::decode(data.data(), pos, value);
+            } else {
+                pos = 0;
+                if (++cur != last) {
+                    value = cur->first;
+                }
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto res = *this;
+            ++(*this);
+            return res;
+        }
+    };
+
+    /** Hints caching the block of the last lookup or insertion of a thread */
+    struct op_context {
+        block_iterator block;
+        std::size_t epoch = 0;
+    };
+
+    /** Statistics on the effectiveness of hints */
+    struct hint_statistics {
+        // the counter for insertion operations
+        CacheAccessCounter inserts;
+
+        // the counter for contains operations
+        CacheAccessCounter contains;
+
+        // the counter for get_boundaries operations
+        CacheAccessCounter get_boundaries;
+    };
+
+    CompressedSet() = default;
+
+    CompressedSet(const CompressedSet&) = delete;
+    CompressedSet& operator=(const CompressedSet&) = delete;
+
+    std::size_t size() const {
+        return num_tuples.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return num_tuples == 0;
+    }
+
+    bool insert(const entry_type& tuple) {
+        op_context ctxt;
+        return insert(tuple, ctxt);
+    }
+
+    /** Insert a tuple, return true if it was not present before */
+    bool insert(const entry_type& tuple, op_context& ctxt) {
+        // insertions into an existing block only share the set of blocks
+        blocks_lock.start_read();
+        auto pos = lookup(tuple, ctxt, hint_stats.inserts);
+        if (pos != blocks.end()) {
+            // the map is not modified while it is shared, hence the block may be changed under its lock
+            block& cur = const_cast<block&>(pos->second);
+            cur.lock.lock();
+            const bool inserted = insertIntoBlock(pos->first, cur, tuple);
+            const bool full = cur.size > block_size;
+            cur.lock.unlock();
+            blocks_lock.end_read();
+            if (inserted) {
+                num_tuples++;
+            }
+            if (full) {
+                splitBlock(tuple);
+            }
+            return inserted;
+        }
+        blocks_lock.end_read();
+
+        // the tuple precedes all blocks, the set of blocks is changed exclusively
+        blocks_lock.start_write();
+        bool inserted = true;
+        auto next = blocks.upper_bound(tuple);
+        if (blocks.empty()) {
+            blocks.emplace(tuple, block());
+        } else if (next == blocks.begin()) {
+            // the tuple becomes the key of the first block, the former key its successor
+            block first = std::move(next->second);
+            std::vector<uint8_t> data;
+            reserve(data, first.data.size() + 1 + sizeof(entry_type));
+            coding::encode(data, next->first, tuple);
+            data.insert(data.end(), first.data.begin(), first.data.end());
+            first.data = std::move(data);
+            first.size++;
+            blocks.erase(next);
+            next = blocks.emplace(tuple, std::move(first)).first;
+            epoch++;
+            if (next->second.size > block_size) {
+                split(next);
+            }
+        } else {
+            // another thread created a block for the tuple in the meantime
+            --next;
+            inserted = insertIntoBlock(next->first, next->second, tuple);
+            if (next->second.size > block_size) {
+                split(next);
+            }
+        }
+        blocks_lock.end_write();
+        if (inserted) {
+            num_tuples++;
+        }
+        return inserted;
+    }
+
+    /** Insert all tuples of the given set */
+    void insertAll(const CompressedSet& other) {
+        op_context ctxt;
+        for (const auto& cur : other) {
+            insert(cur, ctxt);
+        }
+    }
+
+    bool contains(const entry_type& tuple) const {
+        op_context ctxt;
+        return contains(tuple, ctxt);
+    }
+
+    bool contains(const entry_type& tuple, op_context& ctxt) const {
+        return find(tuple, ctxt) != end();
+    }
+
+    iterator find(const entry_type& tuple) const {
+        op_context ctxt;
+        return find(tuple, ctxt);
+    }
+
+    iterator find(const entry_type& tuple, op_context& ctxt) const {
+        auto res = bound(tuple, false, ctxt, hint_stats.contains);
+        return (res != end() && *res == tuple) ? res : end();
+    }
+
+    /** Obtain the range of tuples whose first levels columns match those of the given tuple */
+    template <unsigned levels>
+    range<iterator> getBoundaries(const entry_type& entry) const {
+        op_context ctxt;
+        return getBoundaries<levels>(entry, ctxt);
+    }
+
+    template <unsigned levels>
+    range<iterator> getBoundaries(const entry_type& entry, op_context& ctxt) const {
+        if (levels == 0) {
+            return make_range(begin(), end());
+        }
+        entry_type low = entry;
+        entry_type high = entry;
+        for (unsigned i = levels; i < Dim; ++i) {
+            low[i] = std::numeric_limits<RamDomain>::min();
+            high[i] = std::numeric_limits<RamDomain>::max();
+        }
+        auto lower = bound(low, false, ctxt, hint_stats.get_boundaries);
+        return make_range(lower, bound(high, true, ctxt, hint_stats.get_boundaries));
+    }
+
+    iterator begin() const {
+        return iterator(blocks.begin(), blocks.end());
+    }
+
+    iterator end() const {
+        return iterator(blocks.end(), blocks.end());
+    }
+
+    /** Partition the set into about the given number of ranges of whole blocks */
+    std::vector<range<iterator>> partition(unsigned chunks = 500) const {
+        std::vector<range<iterator>> res;
+        const std::size_t step = std::max<std::size_t>(1, blocks.size() / std::max(1u, chunks));
+        auto cur = blocks.begin();
+        while (cur != blocks.end()) {
+            auto next = cur;
+            for (std::size_t i = 0; i < step && next != blocks.end(); ++i) {
+                ++next;
+            }
+            res.push_back(make_range(iterator(cur, blocks.end()), iterator(next, blocks.end())));
+            cur = next;
+        }
+        return res;
+    }
+
+    void clear() {
+        blocks.clear();
+        num_tuples.store(0, std::memory_order_relaxed);
+        epoch++;
+    }
+
+    /** Remove all tuples; blocks are not retained, hence this is equivalent to clear() */
+    void reset() {
+        clear();
+    }
+
+    /** Obtain the number of bytes occupied by this set */
+    std::size_t getMemoryUsage() const {
+        std::size_t res = sizeof(*this);
+        for (const auto& cur : blocks) {
+            // the node of the map consists of a header of four words and the entry
+            res += 4 * sizeof(void*) + sizeof(cur) + cur.second.data.capacity();
+        }
+        return res;
+    }
+
+    const hint_statistics& getHintStatistics() const {
+        return hint_stats;
+    }
+
+private:
+    /** Obtain the last block whose key is not greater than the given tuple, or the end */
+    block_iterator lookup(const entry_type& tuple, op_context& ctxt, CacheAccessCounter& counter) const {
+        if (ctxt.epoch == epoch && ctxt.block != blocks.end() && !(tuple < ctxt.block->first)) {
+            auto next = std::next(ctxt.block);
+            if (next == blocks.end() || tuple < next->first) {
+                counter.addHit();
+                return ctxt.block;
+            }
+        }
+        counter.addMiss();
+        auto pos = blocks.upper_bound(tuple);
+        if (pos == blocks.begin()) {
+            return blocks.end();
+        }
+        ctxt.block = --pos;
+        ctxt.epoch = epoch;
+        return pos;
+    }
+
+    /** Obtain the first tuple not less than (or greater than, if strict) the given tuple */
+    iterator bound(
+            const entry_type& tuple, bool strict, op_context& ctxt, CacheAccessCounter& counter) const {
+        auto pos = lookup(tuple, ctxt, counter);
+        if (pos == blocks.end()) {
+            return begin();
+        }
+        // all tuples of the following blocks are greater than the given tuple
+        iterator res(pos, blocks.end());
+        while (res.cur == pos && (strict ? !(tuple < res.value) : res.value < tuple)) {
+            ++res;
+        }
+        return res;
+    }
+
+    /** Insert a tuple into the block with the given key, which must not succeed it */
+    static bool insertIntoBlock(const entry_type& key, block& cur, const entry_type& tuple) {
+        if (key == tuple) {
+            return false;
+        }
+        auto& data = cur.data;
+        entry_type pred = key;
+        std::size_t i = 0;
+        while (i < data.size()) {
+            const std::size_t start = i;
+            entry_type next = pred;
+            coding::decode(data.data(), i, next);
+            if (next == tuple) {
+                return false;
+            }
+            if (tuple < next) {
+                // re-encode the successor relative to the inserted tuple
+                std::vector<uint8_t> code;
+                coding::encode(code, tuple, pred);
+                coding::encode(code, next, tuple);
+                reserve(data, code.size());
+                data.erase(data.begin() + start, data.begin() + i);
+                data.insert(data.begin() + start, code.begin(), code.end());
+                cur.size++;
+                return true;
+            }
+            pred = next;
+        }
+        // the tuple succeeds all tuples of the block
+        reserve(data, 1 + sizeof(entry_type));
+        coding::encode(data, tuple, pred);
+        cur.size++;
+        return true;
+    }
+
+    /** Split the block holding the given tuple if it is still overfull */
+    void splitBlock(const entry_type& tuple) {
+        blocks_lock.start_write();
+        auto pos = blocks.upper_bound(tuple);
+        if (pos != blocks.begin() && (--pos)->second.size > block_size) {
+            split(pos);
+        }
+        blocks_lock.end_write();
+    }
+
+    /** Split the given block in halves */
+    void split(typename block_map::iterator pos) {
+        auto& data = pos->second.data;
+        const std::size_t mid = pos->second.size / 2;
+        entry_type key = pos->first;
+        std::size_t start = 0;
+        std::size_t i = 0;
+        for (std::size_t k = 0; k < mid; ++k) {
+            start = i;
+            coding::decode(data.data(), i, key);
+        }
+        block second;
+        second.data.assign(data.begin() + i, data.end());
+        second.size = pos->second.size - mid;
+        data.resize(start);
+        data.shrink_to_fit();
+        pos->second.size = mid;
+        blocks.emplace_hint(std::next(pos), key, std::move(second));
+    }
+
+    /** Grow the capacity of a buffer moderately, blocks are small and numerous */
+    static void reserve(std::vector<uint8_t>& data, std::size_t extra) {
+        if (data.size() + extra > data.capacity()) {
+            data.reserve(data.size() + extra + data.size() / 4);
+        }
+    }
+
+    // the blocks of the set, indexed by their first tuple
+    block_map blocks;
+
+    // the number of tuples of the set
+    std::atomic<std::size_t> num_tuples{0};
+
+    // incremented whenever blocks are removed, invalidating the hints of lookups
+    std::size_t epoch = 1;
+
+    // shared by insertions into existing blocks, held exclusively while blocks are added or removed
+    ReadWriteLock blocks_lock;
+
+    // the hint statistic of this set
+    mutable hint_statistics hint_stats;
+};
+
+}  // end namespace souffle
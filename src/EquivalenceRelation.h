@@ -18,7 +18,7 @@
 
 #pragma once
 
-#include "LambdaBTree.h"
+#include "PiggyList.h"
 #include "UnionFind.h"
 #include "Util.h"
 #include <algorithm>
@@ -34,14 +34,13 @@ class EquivalenceRelation {
 
     // mapping from representative to disjoint set
     // just a cache, essentially, used for iteration over
+    // it is updated incrementally, hence representatives of merged sets must be removable
     using StatesList = souffle::PiggyList<value_type>;
     using StatesBucket = StatesList*;
-    using StorePair = std::pair<value_type, StatesBucket>;
-    using StatesMap = souffle::LambdaBTreeSet<StorePair, std::function<StatesBucket(StorePair&)>,
-            souffle::EqrelMapComparator<StorePair>>;
+    using StatesMap = std::unordered_map<value_type, StatesBucket>;
 
 public:
-    EquivalenceRelation() : statesMapStale(false){};
+    EquivalenceRelation() : statesMapStale(false), attachedRoots(10){};
     ~EquivalenceRelation() {
         emptyPartition();
     }
@@ -79,7 +78,7 @@ public:
         // indicate that iterators will have to generate on request
         this->statesMapStale.store(true, std::memory_order_relaxed);
         bool retval = contains(x, y);
-        sds.unionNodes(x, y);
+        unionNodes(x, y);
         return retval;
     }
 
@@ -91,14 +90,12 @@ public:
         other.genAllDisjointSetLists();
 
         // iterate over partitions at a time
-        for (typename StatesMap::chunk it : other.equivalencePartition.getChunks(MAX_THREADS)) {
-            for (auto& p : it) {
-                value_type rep = p.first;
-                StatesList& pl = *p.second;
-                const size_t ksize = pl.size();
-                for (size_t i = 0; i < ksize; ++i) {
-                    this->sds.unionNodes(rep, pl.get(i));
-                }
+        for (auto& p : other.equivalencePartition) {
+            value_type rep = p.first;
+            StatesList& pl = *p.second;
+            const size_t ksize = pl.size();
+            for (size_t i = 0; i < ksize; ++i) {
+                this->unionNodes(rep, pl.get(i));
             }
         }
         // invalidate iterators unconditionally
@@ -123,11 +120,9 @@ public:
         // find all the disjoint sets that need to be added to this relation
         // that exist in other (and exist in this)
         {
-            auto it = this->sds.sparseToDenseMap.begin();
-            auto end = this->sds.sparseToDenseMap.end();
-            value_type el;
-            for (; it != end; ++it) {
-                std::tie(el, std::ignore) = *it;
+            const size_t end = this->sds.size();
+            for (size_t i = 0; i < end; ++i) {
+                value_type el = this->sds.toSparse(i);
                 if (other.containsElement(el)) {
                     value_type rep = other.sds.findNode(el);
                     if (repsCovered.count(rep) == 0) {
@@ -139,13 +134,10 @@ public:
 
         // add the intersecting dj sets into this one
         {
-            value_type el;
-            value_type rep;
-            auto it = other.sds.sparseToDenseMap.begin();
-            auto end = other.sds.sparseToDenseMap.end();
-            for (; it != end; ++it) {
-                std::tie(el, std::ignore) = *it;
-                rep = other.sds.findNode(el);
+            const size_t end = other.sds.size();
+            for (size_t i = 0; i < end; ++i) {
+                value_type el = other.sds.toSparse(i);
+                value_type rep = other.sds.findNode(el);
                 if (repsCovered.count(rep) != 0) {
                     this->insert(el, rep);
                 }
@@ -171,6 +163,10 @@ public:
         this->statesMapStale.store(true, std::memory_order_relaxed);
 
         equivalencePartition.clear();
+
+        // the next update of the cache starts from scratch
+        attachedRoots.clear();
+        cachedNodes = 0;
     }
 
     /**
@@ -204,6 +200,13 @@ public:
         return retVal;
     }
 
+    /**
+     * Obtain the counters of the union and find operations on this relation
+     */
+    const DisjointSetStatistics& getStatistics() const {
+        return sds.getStatistics();
+    }
+
     // an almighty iterator for several types of iteration.
     // Unfortunately, subclassing isn't an option with souffle
     //   - we don't deal with pointers (so no virtual)
@@ -495,7 +498,7 @@ public:
         genAllDisjointSetLists();
 
         // locate the blocklist that the anterior val resides in
-        auto found = equivalencePartition.find({sds.findNode(anteriorVal), nullptr});
+        auto found = equivalencePartition.find(sds.findNode(anteriorVal));
         assert(found != equivalencePartition.end() && "iterator called on partition that doesn't exist");
 
         return iterator(this, anteriorVal, (*found).second);
@@ -516,7 +519,7 @@ public:
         genAllDisjointSetLists();
 
         // locate the blocklist that the val resides in
-        auto found = equivalencePartition.find({sds.findNode(posteriorVal), nullptr});
+        auto found = equivalencePartition.find(sds.findNode(posteriorVal));
         assert(found != equivalencePartition.end() && "iterator called on partition that doesn't exist");
 
         return iterator(this, anteriorVal, posteriorVal, (*found).second);
@@ -531,7 +534,7 @@ public:
         genAllDisjointSetLists();
 
         // locate the blocklist that the val resides in
-        auto found = equivalencePartition.find({sds.findNode(rep), nullptr});
+        auto found = equivalencePartition.find(sds.findNode(rep));
         return iterator(this, (*found).second);
     }
 
@@ -605,9 +608,29 @@ private:
     // whether the cache is stale
     mutable std::atomic<bool> statesMapStale;
 
+    // the former roots attached to other roots since the last update of the cache, as dense values
+    mutable souffle::PiggyList<parent_t> attachedRoots;
+    // the number of nodes covered by the cache, nodes are numbered densely in order of creation
+    mutable size_t cachedNodes = 0;
+
+    /**
+     * Union two nodes, recording the root attached to the other one for the update of the cache
+     */
+    void unionNodes(value_type x, value_type y) {
+        parent_t attached;
+        if (sds.unionNodes(x, y, &attached)) {
+            attachedRoots.append(attached);
+        }
+    }
+
     /**
      * Generate a cache of the sets such that they can be iterated over efficiently.
      * Each set is partitioned into a PiggyList.
+     *
+     * The cache is updated rather than rebuilt: sets merged since the last update append the smaller
+     * of their lists to the larger one, and nodes created since the last update are appended to the
+     * lists of their sets. Thus, interleaving insertions and iterations costs time proportional to the
+     * changes rather than to the size of the relation.
      */
     void genAllDisjointSetLists() const {
         statesLock.lock();
@@ -618,22 +641,45 @@ private:
             return;
         }
 
-        // btree version
-        emptyPartition();
+        // move the lists of former representatives to the current ones
+        const size_t numAttached = attachedRoots.size();
+        for (size_t i = 0; i < numAttached; ++i) {
+            value_type former = this->sds.toSparse(attachedRoots.get(i));
+            auto pos = equivalencePartition.find(former);
+            // roots created since the last update have no list yet; their nodes are added below
+            if (pos == equivalencePartition.end()) continue;
+
+            StatesBucket members = pos->second;
+            equivalencePartition.erase(pos);
+
+            StatesBucket& target = equivalencePartition[this->sds.findNode(former)];
+            if (target == nullptr) {
+                target = members;
+                continue;
+            }
+            if (target->size() < members->size()) {
+                std::swap(target, members);
+            }
+            const size_t msize = members->size();
+            for (size_t j = 0; j < msize; ++j) {
+                target->append(members->get(j));
+            }
+            delete members;
+        }
+        attachedRoots.clear();
 
+        // add the nodes created since the last update
         size_t dSetSize = this->sds.ds.a_blocks.size();
-        for (size_t i = 0; i < dSetSize; ++i) {
+        for (size_t i = cachedNodes; i < dSetSize; ++i) {
             typename TupleType::value_type sparseVal = this->sds.toSparse(i);
-            parent_t rep = this->sds.findNode(sparseVal);
-
-            StorePair p = {rep, nullptr};
-            StatesList* mapList = equivalencePartition.insert(p, [&](StorePair& sp) {
-                auto* r = new StatesList(1);
-                sp.second = r;
-                return r;
-            });
+
+            StatesBucket& mapList = equivalencePartition[this->sds.findNode(sparseVal)];
+            if (mapList == nullptr) {
+                mapList = new StatesList(1);
+            }
             mapList->append(sparseVal);
         }
+        cachedNodes = dSetSize;
 
         statesMapStale.store(false, std::memory_order_release);
         statesLock.unlock();
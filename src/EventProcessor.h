@@ -286,6 +286,34 @@ public:
     }
 } recursiveRuleNumberProcessor;
 
+/**
+ * Join Order Profile Event Processor, recording the loop nest chosen for a recursive rule in an iteration
+ */
+const class JoinOrderProcessor : public EventProcessor {
+public:
+    JoinOrderProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@join-order", this);
+    }
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& version = signature[2];
+        const std::string& srcLocator = signature[3];
+        const std::string& rule = signature[4];
+        const std::string& atoms = signature[5];
+        size_t alternative = va_arg(args, size_t);
+        std::string iteration = std::to_string(va_arg(args, size_t));
+        db.addTextEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
+                                version, "source-locator"},
+                srcLocator);
+        db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
+                                version, "join-order"},
+                alternative);
+        db.addTextEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
+                                version, "join-order-atoms"},
+                atoms);
+    }
+} joinOrderProcessor;
+
 /**
  * Non-Recursive Relation Number Profile Event Processor
  */
@@ -329,6 +357,23 @@ public:
     }
 } nonRecursiveRelationNumberProcessor;
 
+/**
+ * Relation Distinct Values Profile Event Processor
+ */
+const class RelationDistinctNumberProcessor : public EventProcessor {
+public:
+    RelationDistinctNumberProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@n-relation-distinct", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& column = signature[3];
+        size_t num = va_arg(args, size_t);
+        db.addSizeEntry({"program", "relation", relation, "distinct-values", column}, num);
+    }
+} relationDistinctNumberProcessor;
+
 /**
  * Recursive Relation Timing Profile Event Processor
  */
@@ -0,0 +1,348 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HashIndex.h
+ *
+ * A concurrent hash index for relations whose tuples are only ever
+ * looked up by equality on fixed sets of columns.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "Arena.h"
+#include "CompiledTuple.h"
+#include "ParallelUtils.h"
+#include "RamTypes.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A hash index over tuples of a fixed arity, keyed by the columns of a search signature.
+ *
+ * The index is an open-addressing hash table with linear probing whose slots hold a key, i.e. the
+ * tuple values of the key columns, and the chain of all tuples sharing this key. Indexing the full
+ * signature yields a set of tuples, in which insertions of present tuples fail; any other signature
+ * yields a secondary index, to which the caller must insert each tuple only once.
+ *
+ * The table is split into shards selected by the hash of a key, each guarded by its own lock, such
+ * that concurrent insertions only contend on equal shards. Tuples are allocated from an arena.
+ * Lookups and iterations must not run concurrently with insertions, which holds for relations
+ * during the evaluation of a Datalog program. Iteration follows no particular order.
+ */
+template <unsigned Arity>
+class HashIndex {
+public:
+    using entry_type = ram::Tuple<RamDomain, Arity>;
+
+    /** The number of independently locked shards */
+    static constexpr std::size_t num_shards = 64;
+
+private:
+    struct node {
+        entry_type tuple;
+        const node* next;
+    };
+
+    struct slot {
+        std::size_t hash;
+        node* head;
+    };
+
+    struct shard {
+        // the slots of the shard, a power of two of them or none
+        std::vector<slot> slots;
+
+        // the number of occupied slots
+        std::size_t used = 0;
+
+        // the number of tuples
+        std::size_t size = 0;
+
+        // serialises insertions into this shard
+        SpinLock lock;
+    };
+
+public:
+    /** An iterator over all tuples of the index or over the tuples of a single key */
+    class iterator : public std::iterator<std::forward_iterator_tag, entry_type> {
+        friend class HashIndex;
+
+        // the index, null when only the chain of the current tuple is iterated
+        const HashIndex* index = nullptr;
+
+        // the position of the slot of the current tuple
+        std::size_t shardPos = 0;
+        std::size_t slotPos = 0;
+
+        // the current tuple, null at the end
+        const node* cur = nullptr;
+
+        iterator(const node* cur) : cur(cur) {}
+
+        /** Create an iterator at the first tuple at or after the given slot */
+        iterator(const HashIndex* index, std::size_t shardPos, std::size_t slotPos)
+                : index(index), shardPos(shardPos), slotPos(slotPos) {
+            seek();
+        }
+
+        void seek() {
+            for (; shardPos < num_shards; ++shardPos, slotPos = 0) {
+                const auto& slots = index->shards[shardPos].slots;
+                for (; slotPos < slots.size(); ++slotPos) {
+                    if (slots[slotPos].head != nullptr) {
+                        cur = slots[slotPos].head;
+                        return;
+                    }
+                }
+            }
+            cur = nullptr;
+        }
+
+    public:
+        iterator() = default;
+
+        bool operator==(const iterator& other) const {
+            return cur == other.cur;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        const entry_type& operator*() const {
+            return cur->tuple;
+        }
+
+        const entry_type* operator->() const {
+            return &cur->tuple;
+        }
+
+        iterator& operator++() {
+            cur = cur->next;
+            if (cur == nullptr && index != nullptr) {
+                ++slotPos;
+                seek();
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto res = *this;
+            ++(*this);
+            return res;
+        }
+    };
+
+    /** Create an index keyed by the columns of the given search signature */
+    explicit HashIndex(SearchSignature columns)
+            : columns(columns), unique((columns & full) == full),
+              arena(std::make_unique<Arena>(alignof(node))), shards(new shard[num_shards]) {}
+
+    HashIndex(const HashIndex&) = delete;
+    HashIndex& operator=(const HashIndex&) = delete;
+
+    /** Obtain the number of tuples of the index */
+    std::size_t size() const {
+        std::size_t res = 0;
+        for (std::size_t i = 0; i < num_shards; ++i) {
+            res += shards[i].size;
+        }
+        return res;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /** Insert a tuple, return false if the index is unique and an equal tuple is present */
+    bool insert(const entry_type& tuple) {
+        const std::size_t hash = hashKey(tuple);
+        shard& cur = shards[hash % num_shards];
+        std::lock_guard<SpinLock> guard(cur.lock);
+        if ((cur.used + 1) * 4 > cur.slots.size() * 3) {
+            grow(cur);
+        }
+        const std::size_t mask = cur.slots.size() - 1;
+        std::size_t pos = (hash / num_shards) & mask;
+        while (cur.slots[pos].head != nullptr) {
+            if (cur.slots[pos].hash == hash && equalKey(cur.slots[pos].head->tuple, tuple)) {
+                if (unique) {
+                    return false;
+                }
+                break;
+            }
+            pos = (pos + 1) & mask;
+        }
+        node* n = new (arena->allocate(sizeof(node))) node{tuple, cur.slots[pos].head};
+        if (cur.slots[pos].head == nullptr) {
+            cur.slots[pos].hash = hash;
+            cur.used++;
+        }
+        cur.slots[pos].head = n;
+        cur.size++;
+        return true;
+    }
+
+    /** Check whether a tuple with the key of the given tuple is present */
+    bool contains(const entry_type& tuple) const {
+        return find(tuple) != nullptr;
+    }
+
+    /** Obtain all tuples sharing the key of the given tuple */
+    range<iterator> equalRange(const entry_type& tuple) const {
+        return make_range(iterator(find(tuple)), iterator());
+    }
+
+    iterator begin() const {
+        return iterator(this, 0, 0);
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    /** Partition the index into about the given number of ranges of slots */
+    std::vector<range<iterator>> partition(unsigned chunks = 500) const {
+        std::vector<range<iterator>> res;
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < num_shards; ++i) {
+            total += shards[i].slots.size();
+        }
+        const std::size_t step = std::max<std::size_t>(1, total / std::max(1u, chunks));
+        iterator from = begin();
+        std::size_t pos = 0;
+        for (std::size_t i = 0; i < num_shards && from != end(); ++i) {
+            for (std::size_t j = 0; j < shards[i].slots.size(); ++j) {
+                if (++pos % step == 0) {
+                    iterator to(this, i, j + 1);
+                    if (from != to) {
+                        res.push_back(make_range(from, to));
+                        from = to;
+                    }
+                }
+            }
+        }
+        if (from != end()) {
+            res.push_back(make_range(from, end()));
+        }
+        return res;
+    }
+
+    /** Remove all tuples and return the memory of the index to the system */
+    void clear() {
+        for (std::size_t i = 0; i < num_shards; ++i) {
+            std::vector<slot>().swap(shards[i].slots);
+            shards[i].used = 0;
+            shards[i].size = 0;
+        }
+        arena->release();
+    }
+
+    /** Remove all tuples, keeping the memory of the index for refilling it */
+    void reset() {
+        for (std::size_t i = 0; i < num_shards; ++i) {
+            std::fill(shards[i].slots.begin(), shards[i].slots.end(), slot{0, nullptr});
+            shards[i].used = 0;
+            shards[i].size = 0;
+        }
+        arena->reset();
+    }
+
+    /** Obtain the number of bytes occupied by this index */
+    std::size_t getMemoryUsage() const {
+        std::size_t res = sizeof(*this) + num_shards * sizeof(shard) + arena->getCapacity();
+        for (std::size_t i = 0; i < num_shards; ++i) {
+            res += shards[i].slots.capacity() * sizeof(slot);
+        }
+        return res;
+    }
+
+private:
+    /** The signature of all columns */
+    static constexpr SearchSignature full = (SearchSignature(1) << Arity) - 1;
+
+    /** Hash the key columns of a tuple */
+    std::size_t hashKey(const entry_type& tuple) const {
+        uint64_t hash = 0;
+        for (unsigned i = 0; i < Arity; ++i) {
+            if ((columns >> i) & 1) {
+                hash = (hash ^ static_cast<uint64_t>(tuple[i])) * 0x9E3779B97F4A7C15ull;
+            }
+        }
+        return static_cast<std::size_t>(hash ^ (hash >> 29));
+    }
+
+    /** Compare the key columns of two tuples */
+    bool equalKey(const entry_type& a, const entry_type& b) const {
+        for (unsigned i = 0; i < Arity; ++i) {
+            if (((columns >> i) & 1) && a[i] != b[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Obtain the chain of tuples with the key of the given tuple, or null */
+    const node* find(const entry_type& tuple) const {
+        const std::size_t hash = hashKey(tuple);
+        const shard& cur = shards[hash % num_shards];
+        if (cur.slots.empty()) {
+            return nullptr;
+        }
+        const std::size_t mask = cur.slots.size() - 1;
+        for (std::size_t pos = (hash / num_shards) & mask; cur.slots[pos].head != nullptr;
+                pos = (pos + 1) & mask) {
+            if (cur.slots[pos].hash == hash && equalKey(cur.slots[pos].head->tuple, tuple)) {
+                return cur.slots[pos].head;
+            }
+        }
+        return nullptr;
+    }
+
+    /** Double the number of slots of a shard */
+    static void grow(shard& cur) {
+        std::vector<slot> slots(std::max<std::size_t>(8, cur.slots.size() * 2), slot{0, nullptr});
+        const std::size_t mask = slots.size() - 1;
+        for (const auto& s : cur.slots) {
+            if (s.head != nullptr) {
+                std::size_t pos = (s.hash / num_shards) & mask;
+                while (slots[pos].head != nullptr) {
+                    pos = (pos + 1) & mask;
+                }
+                slots[pos] = s;
+            }
+        }
+        cur.slots.swap(slots);
+    }
+
+    // the key columns
+    const SearchSignature columns;
+
+    // whether the key covers all columns
+    const bool unique;
+
+    // the memory of the tuples
+    std::unique_ptr<Arena> arena;
+
+    // the shards of the table
+    std::unique_ptr<shard[]> shards;
+};
+
+}  // end namespace souffle
@@ -32,8 +32,11 @@
 #include "RamOperation.h"
 #include "RamProgram.h"
 #include "RamVisitor.h"
+#include "RelationNodeSize.h"
+#include "RelationStats.h"
 #include "ReadStream.h"
 #include "SignalHandler.h"
+#include "StratumScheduler.h"
 #include "SymbolTable.h"
 #include "Util.h"
 #include "WriteStream.h"
@@ -53,15 +56,73 @@
 #include <utility>
 #include <ffi.h>
 
+/*
+ * Instruction dispatch of the interpreter loop.
+ *
+ * With GCC and Clang the code stream is threaded: on its first execution every opcode of the stream is
+ * resolved to the address of its handler, and each handler jumps directly to the handler of the next
+ * instruction (computed goto). Other compilers, or a build with LVM_SWITCH_DISPATCH defined, fall back to
+ * a switch statement. DISPATCH() ends a handler and must not be used inside loops of a handler. Neither
+ * must it be used inside a scope holding objects with destructors, as a computed goto leaves the scope
+ * without destroying them; such handlers dispatch after their block.
+ */
+#if defined(__GNUC__) && !defined(LVM_SWITCH_DISPATCH)
+#define LVM_THREADED_DISPATCH
+#endif
+
+#ifdef LVM_THREADED_DISPATCH
+#define SWITCH(opcode) DISPATCH();
+#define CASE(opcode) L_##opcode
+#define DEFAULT L_default
+#define DISPATCH() goto* threadedCode[ip]
+#else
+#define SWITCH(opcode) switch (opcode)
+#define CASE(opcode) case opcode
+#define DEFAULT default
+#define DISPATCH() break
+#endif
+
 namespace souffle {
 
+/** Evaluate a numeric comparison, given by the LVM opcode of its operator, as used by superinstructions */
+inline bool evalComparison(RamDomain op, RamDomain lhs, RamDomain rhs) {
+    switch (op) {
+        case LVM_OP_EQ:
+            return lhs == rhs;
+        case LVM_OP_NE:
+            return lhs != rhs;
+        case LVM_OP_LT:
+            return lhs < rhs;
+        case LVM_OP_LE:
+            return lhs <= rhs;
+        case LVM_OP_GT:
+            return lhs > rhs;
+        case LVM_OP_GE:
+            return lhs >= rhs;
+        default:
+            assert(false && "unsupported comparison");
+            return false;
+    }
+}
+
 void LVM::executeMain() {
     const RamStatement& main = *translationUnit.getProgram()->getMain();
     if (mainProgram.get() == nullptr) {
-        LVMGenerator generator(translationUnit.getSymbolTable(), main, *isa, relationEncoder);
+        LVMGenerator generator(translationUnit.getSymbolTable(), main, *isa, relationEncoder,
+                translationUnit.getAnalysis<RamStratumAnalysis>());
         mainProgram = generator.getCodeStream();
+        if (Global::config().has("verbose")) {
+            generator.printFusionStatistics(std::cout);
+        }
     }
     LVMContext ctxt;
+#ifdef _OPENMP
+    // parallel operations use the number of threads requested by -j, 0 stands for auto
+    size_t jobs = std::stoi(Global::config().get("jobs"));
+    if (jobs > 0) {
+        omp_set_num_threads(jobs);
+    }
+#endif
     SignalHandler::instance()->set();
     if (Global::config().has("verbose")) {
         SignalHandler::instance()->enableLogging();
@@ -97,6 +158,9 @@ void LVM::executeMain() {
         // Store count of rules
         size_t ruleCount = 0;
         visitDepthFirst(main, [&](const RamQuery& rule) { ++ruleCount; });
+        // alternative join orders of a rule count as one rule
+        visitDepthFirst(
+                main, [&](const RamAdaptiveQuery& rule) { ruleCount -= rule.getQueries().size() - 1; });
         ProfileEventSingleton::instance().makeConfigRecord("ruleCount", std::to_string(ruleCount));
 
         execute(mainProgram, ctxt);
@@ -119,54 +183,87 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
     const LVMCode& code = *codeStream;
     auto& symbolTable = codeStream->getSymbolTable();
     this->environment.resize(relationEncoder.getSize());
+#ifdef LVM_THREADED_DISPATCH
+    // Handler addresses in the order of LVM_Type, types which are operands only are unknown opcodes
+    static const void* const handlers[] = {
+            &&L_LVM_Number, &&L_LVM_TupleElement, &&L_LVM_AutoIncrement, &&L_LVM_OP_ORD, &&L_LVM_OP_STRLEN,
+            &&L_LVM_OP_NEG, &&L_LVM_OP_BNOT, &&L_LVM_OP_LNOT, &&L_LVM_OP_TONUMBER, &&L_LVM_OP_TOSTRING,
+            &&L_LVM_OP_ADD, &&L_LVM_OP_SUB, &&L_LVM_OP_MUL, &&L_LVM_OP_DIV, &&L_LVM_OP_EXP, &&L_LVM_OP_MOD,
+            &&L_LVM_OP_BAND, &&L_LVM_OP_BOR, &&L_LVM_OP_BXOR, &&L_LVM_OP_LAND, &&L_LVM_OP_LOR, &&L_LVM_OP_MAX,
+            &&L_LVM_OP_MIN, &&L_LVM_OP_CAT, &&L_LVM_OP_SUBSTR, &&L_LVM_OP_EQ, &&L_LVM_OP_NE, &&L_LVM_OP_LT,
+            &&L_LVM_OP_LE, &&L_LVM_OP_GT, &&L_LVM_OP_GE, &&L_LVM_OP_MATCH, &&L_LVM_OP_NOT_MATCH,
+            &&L_LVM_OP_CONTAINS, &&L_LVM_OP_NOT_CONTAINS, &&L_LVM_UserDefinedOperator, &&L_LVM_PackRecord,
+            &&L_LVM_Argument, &&L_LVM_Aggregate_COUNT, &&L_LVM_Aggregate_Return, &&L_LVM_Conjunction,
+            &&L_LVM_Negation, &&L_LVM_EmptinessCheck, &&L_LVM_ExistenceCheck,
+            &&L_LVM_ProvenanceExistenceCheck, &&L_LVM_Constraint, &&L_LVM_True, &&L_LVM_False, &&L_LVM_Scan,
+            &&L_LVM_IndexScan, &&L_LVM_Choice, &&L_LVM_IndexChoice, &&L_LVM_ParallelScan,
+            &&L_LVM_ParallelIndexScan, &&L_LVM_ParallelChoice, &&L_LVM_ParallelIndexChoice,
+            &&L_LVM_UnpackRecord, &&L_LVM_LeapfrogJoin, &&L_LVM_LeapfrogJoinNext, &&L_LVM_Aggregate,
+            &&L_LVM_IndexAggregate, &&L_LVM_Filter, &&L_LVM_Project, &&L_LVM_ReturnValue, &&L_LVM_Search,
+            &&L_LVM_Sequence, &&L_LVM_Parallel, &&L_LVM_Stop_Parallel, &&L_LVM_Loop,
+            &&L_LVM_IncIterationNumber, &&L_LVM_ResetIterationNumber, &&L_LVM_Exit,
+            &&L_LVM_LogTimer, &&L_LVM_LogRelationTimer, &&L_LVM_StopLogTimer, &&L_LVM_DebugInfo,
+            &&L_LVM_Stratum, &&L_LVM_ScheduleStrata, &&L_LVM_Create, &&L_LVM_Clear, &&L_LVM_Drop,
+            &&L_LVM_LogSize, &&L_LVM_LogStatistics, &&L_LVM_Load, &&L_LVM_Store, &&L_LVM_Fact, &&L_LVM_Merge,
+            &&L_LVM_Swap, &&L_LVM_Query, &&L_LVM_AdaptiveQuery, &&L_LVM_Goto, &&L_LVM_Jmpnz, &&L_LVM_Jmpez,
+            &&L_LVM_STOP,
+            &&L_default, &&L_default, &&L_default, &&L_default, &&L_default, &&L_default, &&L_default,
+            &&L_LVM_ITER_InitFullIndex, &&L_LVM_ITER_InitRangeIndex,
+            &&L_LVM_ITER_Select, &&L_LVM_ITER_Inc, &&L_LVM_ITER_NotAtEnd, &&L_LVM_CompareElementConstant,
+            &&L_LVM_CompareElements, &&L_LVM_ProjectElements};
+    static_assert(sizeof(handlers) / sizeof(handlers[0]) == LVM_TypeCount, "missing handler for LVM type");
+    if (!codeStream->isThreaded()) {
+        codeStream->resolveThreadedCode(handlers, &&L_default);
+    }
+    const void* const* threadedCode = codeStream->getThreadedCode().data();
+#endif
     while (true) {
-        switch (code[ip]) {
-            case LVM_Number:
+        SWITCH(code[ip]) {
+            CASE(LVM_Number):
                 stack.push(code[ip + 1]);
                 ip += 2;
-                break;
-            case LVM_TupleElement:
+                DISPATCH();
+            CASE(LVM_TupleElement):
                 stack.push(ctxt[code[ip + 1]][code[ip + 2]]);
                 ip += 3;
-                break;
-            case LVM_AutoIncrement:
-                stack.push(this->counter);
-                incCounter();
+                DISPATCH();
+            CASE(LVM_AutoIncrement):
+                stack.push(incCounter());
                 ip += 1;
-                break;
-            case LVM_OP_ORD:
+                DISPATCH();
+            CASE(LVM_OP_ORD):
                 // Does nothing
                 ip += 1;
-                break;
-            case LVM_OP_STRLEN: {
+                DISPATCH();
+            CASE(LVM_OP_STRLEN): {
                 RamDomain relNameId = stack.top();
                 stack.pop();
                 stack.push(symbolTable.resolve(relNameId).size());
                 ip += 1;
-                break;
             }
-            case LVM_OP_NEG: {
+                DISPATCH();
+            CASE(LVM_OP_NEG): {
                 RamDomain val = stack.top();
                 stack.pop();
                 stack.push(-val);
                 ip += 1;
-                break;
             }
-            case LVM_OP_BNOT: {
+                DISPATCH();
+            CASE(LVM_OP_BNOT): {
                 RamDomain val = stack.top();
                 stack.pop();
                 stack.push(~val);
                 ip += 1;
-                break;
             }
-            case LVM_OP_LNOT: {
+                DISPATCH();
+            CASE(LVM_OP_LNOT): {
                 RamDomain val = stack.top();
                 stack.pop();
                 stack.push(!val);
                 ip += 1;
-                break;
             }
-            case LVM_OP_TONUMBER: {
+                DISPATCH();
+            CASE(LVM_OP_TONUMBER): {
                 RamDomain val = stack.top();
                 stack.pop();
                 RamDomain result = 0;
@@ -180,26 +277,26 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
                 stack.push(result);
                 ip += 1;
-                break;
             }
-            case LVM_OP_TOSTRING: {
+                DISPATCH();
+            CASE(LVM_OP_TOSTRING): {
                 RamDomain val = stack.top();
                 RamDomain result = symbolTable.lookup(std::to_string(val));
                 stack.pop();
                 stack.push(result);
                 ip += 1;
-                break;
             }
-            case LVM_OP_ADD: {
+                DISPATCH();
+            CASE(LVM_OP_ADD): {
                 RamDomain x = stack.top();
                 stack.pop();
                 RamDomain y = stack.top();
                 stack.pop();
                 stack.push(x + y);
                 ip += 1;
-                break;
             }
-            case LVM_OP_SUB: {
+                DISPATCH();
+            CASE(LVM_OP_SUB): {
                 // Rhs was pushed last in the generator, so it should be on top.
                 RamDomain rhs = stack.top();
                 stack.pop();
@@ -207,90 +304,90 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 stack.pop();
                 stack.push(lhs - rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_MUL: {
+                DISPATCH();
+            CASE(LVM_OP_MUL): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs * rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_DIV: {
+                DISPATCH();
+            CASE(LVM_OP_DIV): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs / rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_EXP: {
+                DISPATCH();
+            CASE(LVM_OP_EXP): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(std::pow(lhs, rhs));
                 ip += 1;
-                break;
             }
-            case LVM_OP_MOD: {
+                DISPATCH();
+            CASE(LVM_OP_MOD): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs % rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_BAND: {
+                DISPATCH();
+            CASE(LVM_OP_BAND): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs & rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_BOR: {
+                DISPATCH();
+            CASE(LVM_OP_BOR): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs | rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_BXOR: {
+                DISPATCH();
+            CASE(LVM_OP_BXOR): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs ^ rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_LAND: {
+                DISPATCH();
+            CASE(LVM_OP_LAND): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs && rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_LOR: {
+                DISPATCH();
+            CASE(LVM_OP_LOR): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs || rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_MAX: {
+                DISPATCH();
+            CASE(LVM_OP_MAX): {
                 size_t size = code[ip + 1];
                 RamDomain val = MIN_RAM_DOMAIN;
                 for (size_t i = 0; i < size; ++i) {
@@ -299,9 +396,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
                 stack.push(val);
                 ip += 2;
-                break;
             }
-            case LVM_OP_MIN: {
+                DISPATCH();
+            CASE(LVM_OP_MIN): {
                 size_t size = code[ip + 1];
                 RamDomain val = MAX_RAM_DOMAIN;
                 for (size_t i = 0; i < size; ++i) {
@@ -310,9 +407,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
                 stack.push(val);
                 ip += 2;
-                break;
             }
-            case LVM_OP_CAT: {
+                DISPATCH();
+            CASE(LVM_OP_CAT): {
                 size_t size = code[ip + 1];
                 std::string cat;
                 for (size_t i = 0; i < size; ++i) {
@@ -321,9 +418,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
                 stack.push(symbolTable.lookup(cat));
                 ip += 2;
-                break;
             }
-            case LVM_OP_SUBSTR: {
+                DISPATCH();
+            CASE(LVM_OP_SUBSTR): {
                 RamDomain len = stack.top();
                 stack.pop();
                 RamDomain idx = stack.top();
@@ -341,63 +438,63 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 stack.push(symbolTable.lookup(sub_str));
 
                 ip += 1;
-                break;
             }
-            case LVM_OP_EQ: {
+                DISPATCH();
+            CASE(LVM_OP_EQ): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs == rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_NE: {
+                DISPATCH();
+            CASE(LVM_OP_NE): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs != rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_LT: {
+                DISPATCH();
+            CASE(LVM_OP_LT): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs < rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_LE: {
+                DISPATCH();
+            CASE(LVM_OP_LE): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs <= rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_GT: {
+                DISPATCH();
+            CASE(LVM_OP_GT): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs > rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_GE: {
+                DISPATCH();
+            CASE(LVM_OP_GE): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs >= rhs);
                 ip += 1;
-                break;
             }
-            case LVM_OP_MATCH: {
+                DISPATCH();
+            CASE(LVM_OP_MATCH): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
@@ -415,9 +512,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
                 stack.push(result);
                 ip += 1;
-                break;
             }
-            case LVM_OP_NOT_MATCH: {
+                DISPATCH();
+            CASE(LVM_OP_NOT_MATCH): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
@@ -435,9 +532,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
                 stack.push(result);
                 ip += 1;
-                break;
             }
-            case LVM_OP_CONTAINS: {
+                DISPATCH();
+            CASE(LVM_OP_CONTAINS): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
@@ -446,9 +543,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 const std::string& text = symbolTable.resolve(rhs);
                 stack.push(text.find(pattern) != std::string::npos);
                 ip += 1;
-                break;
             }
-            case LVM_OP_NOT_CONTAINS: {
+                DISPATCH();
+            CASE(LVM_OP_NOT_CONTAINS): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
@@ -457,9 +554,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 const std::string& text = symbolTable.resolve(rhs);
                 stack.push(text.find(pattern) == std::string::npos);
                 ip += 1;
-                break;
             }
-            case LVM_UserDefinedOperator: {
+                DISPATCH();
+            CASE(LVM_UserDefinedOperator): {
                 // get name and type
                 const std::string name = symbolTable.resolve(code[ip + 1]);
                 const std::string type = symbolTable.resolve(code[ip + 2]);
@@ -517,9 +614,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
                 stack.push(result);
                 ip += 4;
-                break;
             }
-            case LVM_PackRecord: {
+                DISPATCH();
+            CASE(LVM_PackRecord): {
                 RamDomain arity = code[ip + 1];
                 RamDomain data[arity];
                 for (auto i = 0; i < arity; ++i) {
@@ -528,46 +625,46 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
                 stack.push(pack(data, arity));
                 ip += 2;
-                break;
             }
-            case LVM_Argument: {
+                DISPATCH();
+            CASE(LVM_Argument): {
                 stack.push(ctxt.getArgument(code[ip + 1]));
                 ip += 2;
-                break;
             }
-            case LVM_True: {
+                DISPATCH();
+            CASE(LVM_True): {
                 stack.push(1);
                 ip += 1;
-                break;
-            };
-            case LVM_False: {
+            }
+                DISPATCH();
+            CASE(LVM_False): {
                 stack.push(0);
                 ip += 1;
-                break;
-            };
-            case LVM_Conjunction: {
+            }
+                DISPATCH();
+            CASE(LVM_Conjunction): {
                 RamDomain rhs = stack.top();
                 stack.pop();
                 RamDomain lhs = stack.top();
                 stack.pop();
                 stack.push(lhs && rhs);
                 ip += 1;
-                break;
             }
-            case LVM_Negation: {
+                DISPATCH();
+            CASE(LVM_Negation): {
                 RamDomain val = stack.top();
                 stack.pop();
                 stack.push(!val);
                 ip += 1;
-                break;
             }
-            case LVM_EmptinessCheck: {
+                DISPATCH();
+            CASE(LVM_EmptinessCheck): {
                 size_t relId = code[ip + 1];
                 stack.push(getRelation(relId)->empty());
                 ip += 2;
-                break;
             }
-            case LVM_ExistenceCheck: {
+                DISPATCH();
+            CASE(LVM_ExistenceCheck): {
                 size_t relId = code[ip + 1];
                 const std::string& patterns = symbolTable.resolve(code[ip + 2]);
                 RamDomain indexPos = code[ip + 3];
@@ -587,8 +684,6 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                         stack.pop();
                     }
                     stack.push(rel.exists(tuple));
-                    ip += 4;
-                    break;
                 } else {  // for partial we search for lower and upper boundaries
                     RamDomain low[arity];
                     RamDomain high[arity];
@@ -607,13 +702,11 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                     auto range = rel.lowerUpperBound(low, high, indexPos);
 
                     stack.push(range.first != range.second);
-                    ip += 4;
-                    break;
                 }
-
-                break;
+                ip += 4;
             }
-            case LVM_ProvenanceExistenceCheck: {
+                DISPATCH();
+            CASE(LVM_ProvenanceExistenceCheck): {
                 size_t relId = code[ip + 1];
                 std::string relationName = relationEncoder.decodeRelation(relId);
                 std::string patterns = symbolTable.resolve(code[ip + 2]);
@@ -643,37 +736,79 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 auto range = rel.lowerUpperBound(low, high, indexPos);
                 stack.push(range.first != range.second);
                 ip += 4;
-                break;
             }
-            case LVM_Constraint:
+                DISPATCH();
+            CASE(LVM_Constraint):
                 /** Does nothing, just a label */
                 ip += 1;
-                break;
-            case LVM_Scan:
+                DISPATCH();
+            CASE(LVM_Scan):
                 /** Does nothing, just a label */
                 ip += 1;
-                break;
-            case LVM_IndexScan:
+                DISPATCH();
+            CASE(LVM_IndexScan):
                 /** Does nothing, just a label */
                 ip += 1;
-                break;
-            case LVM_Choice:
+                DISPATCH();
+            CASE(LVM_Choice):
                 /** Does nothing, just a label */
                 ip += 1;
-                break;
-            case LVM_IndexChoice:
+                DISPATCH();
+            CASE(LVM_IndexChoice):
                 /** Does nothing, just a label */
                 ip += 1;
-                break;
-            case LVM_Search: {
+                DISPATCH();
+            CASE(LVM_ParallelScan):
+            CASE(LVM_ParallelChoice): {
+                size_t iterId = code[ip + 1];
+                size_t relId = code[ip + 2];
+                size_t endAddress = code[ip + 3];
+                auto partitions = getRelation(relId)->partition();
+                executeParallel(codeStream, ctxt, partitions, iterId, ip + 4);
+                ip = endAddress;
+            }
+                DISPATCH();
+            CASE(LVM_ParallelIndexScan):
+            CASE(LVM_ParallelIndexChoice): {
+                size_t iterId = code[ip + 1];
+                size_t relId = code[ip + 2];
+                auto relPtr = getRelation(relId);
+                std::string pattern = symbolTable.resolve(code[ip + 3]);
+                RamDomain indexPos = code[ip + 4];
+                size_t endAddress = code[ip + 5];
+
+                // create pattern tuple for range query
+                auto arity = relPtr->getArity();
+                RamDomain low[arity];
+                RamDomain hig[arity];
+                for (size_t i = 0; i < arity; i++) {
+                    if (pattern[arity - i - 1] == 'V') {
+                        low[arity - i - 1] = stack.top();
+                        stack.pop();
+                        hig[arity - i - 1] = low[arity - i - 1];
+                    } else {
+                        low[arity - i - 1] = MIN_RAM_DOMAIN;
+                        hig[arity - i - 1] = MAX_RAM_DOMAIN;
+                    }
+                }
+
+                // split the iterator range into chunks
+                auto bounds = relPtr->lowerUpperBound(low, hig, indexPos);
+                auto partitions = make_range(bounds.first, bounds.second).partition();
+                executeParallel(codeStream, ctxt, partitions, iterId, ip + 6);
+                ip = endAddress;
+            }
+                DISPATCH();
+            CASE(LVM_Search): {
                 if (Global::config().has("profile") && code[ip + 1] != 0) {
                     std::string msg = symbolTable.resolve(code[ip + 2]);
-                    this->frequencies[msg][this->getIterationNumber()]++;
+                    auto lease = profileLock.acquire();
+                    this->frequencies[msg][ctxt.getIterationNumber()]++;
                 }
                 ip += 3;
-                break;
             }
-            case LVM_UnpackRecord: {
+                DISPATCH();
+            CASE(LVM_UnpackRecord): {
                 RamDomain arity = code[ip + 1];
                 RamDomain id = code[ip + 2];
                 RamDomain exitAddress = code[ip + 3];
@@ -683,24 +818,63 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
 
                 if (isNull(ref)) {
                     ip = exitAddress;
-                    break;
+                    DISPATCH();
                 }
 
                 RamDomain* tuple = unpack(ref, arity);
                 ctxt[id] = tuple;
                 ip += 4;
-                break;
+                DISPATCH();
+            }
+            CASE(LVM_LeapfrogJoin): {
+                RamDomain joinId = code[ip + 1];
+                size_t numVariables = code[ip + 2];
+                size_t numRelations = code[ip + 3];
+
+                // Build a trie over the index of each relation ordered by the variables of its columns
+                auto join = std::make_unique<LeapfrogTrieJoin>(numVariables);
+                size_t pos = ip + 4;
+                for (size_t i = 0; i < numRelations; ++i) {
+                    auto relPtr = getRelation(code[pos]);
+                    size_t indexPos = code[pos + 1];
+                    size_t arity = code[pos + 2];
+                    std::vector<size_t> order(&code[pos + 3], &code[pos + 3 + arity]);
+                    std::vector<size_t> variables(&code[pos + 3 + arity], &code[pos + 3 + 2 * arity]);
+                    auto bounds = [relPtr, indexPos](const RamDomain* low, const RamDomain* high) {
+                        return relPtr->lowerUpperBound(low, high, indexPos);
+                    };
+                    join->addIterator(makeIndexTrieIterator(bounds, std::move(order), arity), variables);
+                    pos += 3 + 2 * arity;
+                }
+                ctxt.lookUpJoin(joinId) = std::move(join);
+                ip = pos;
+            }
+                DISPATCH();
+            CASE(LVM_LeapfrogJoinNext): {
+                RamDomain joinId = code[ip + 1];
+                RamDomain id = code[ip + 2];
+                RamDomain exitAddress = code[ip + 3];
+
+                auto& join = ctxt.lookUpJoin(joinId);
+                if (!join->next()) {
+                    ip = exitAddress;
+                    DISPATCH();
+                }
+                ctxt[id] = join->getBinding();
+                ip += 4;
+                DISPATCH();
             }
-            case LVM_Filter:
+            CASE(LVM_Filter):
                 if (Global::config().has("profile")) {
                     std::string msg = symbolTable.resolve(code[ip + 1]);
                     if (!msg.empty()) {
-                        this->frequencies[msg][this->getIterationNumber()]++;
+                        auto lease = profileLock.acquire();
+                        this->frequencies[msg][ctxt.getIterationNumber()]++;
                     }
                 }
                 ip += 2;
-                break;
-            case LVM_Project: {
+                DISPATCH();
+            CASE(LVM_Project): {
                 RamDomain arity = code[ip + 1];
                 size_t relId = code[ip + 2];
                 LVMRelation& rel = *getRelation(relId);
@@ -711,9 +885,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
                 rel.insert(tuple);
                 ip += 3;
-                break;
             }
-            case LVM_ReturnValue: {
+                DISPATCH();
+            CASE(LVM_ReturnValue): {
                 RamDomain size = code[ip + 1];
                 std::string types = symbolTable.resolve(code[ip + 2]);
                 for (auto i = 0; i < size; ++i) {
@@ -725,13 +899,13 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                     }
                 }
                 ip += 3;
-                break;
             }
-            case LVM_Sequence: {
+                DISPATCH();
+            CASE(LVM_Sequence): {
                 ip += 1;
-                break;
             }
-            case LVM_Parallel: {
+                DISPATCH();
+            CASE(LVM_Parallel): {
                 size_t size = code[ip + 1];
                 size_t end = code[ip + 2];
                 size_t startAddresses[size];
@@ -744,69 +918,69 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
 
                 ip = end;
-                break;
             }
-            case LVM_Stop_Parallel: {
-                ip += 2;
-                break;
+                DISPATCH();
+            CASE(LVM_Stop_Parallel): {
+                assert(stack.size() == 0);
+                return;
             }
-            case LVM_Loop: {
+            CASE(LVM_Loop): {
                 /** Does nothing, jus a label */
                 ip += 1;
-                break;
             }
-            case LVM_IncIterationNumber: {
-                incIterationNumber();
+                DISPATCH();
+            CASE(LVM_IncIterationNumber): {
+                ctxt.incIterationNumber();
                 ip += 1;
-                break;
-            };
-            case LVM_ResetIterationNumber: {
-                resetIterationNumber();
+            }
+                DISPATCH();
+            CASE(LVM_ResetIterationNumber): {
+                ctxt.resetIterationNumber();
                 ip += 1;
-                break;
-            };
-            case LVM_Exit: {
+            }
+                DISPATCH();
+            CASE(LVM_Exit): {
                 RamDomain val = stack.top();
                 stack.pop();
                 if (val) {
                     ip = code[ip + 1];
-                    break;
+                    DISPATCH();
                 }
                 ip += 2;
-                break;
+                DISPATCH();
             }
-            case LVM_LogTimer: {
+            CASE(LVM_LogTimer): {
                 std::string msg = symbolTable.resolve(code[ip + 1]);
                 size_t timerIndex = code[ip + 2];
-                Logger* logger = new Logger(msg.c_str(), this->getIterationNumber());
+                Logger* logger = new Logger(msg.c_str(), ctxt.getIterationNumber());
                 insertTimerAt(timerIndex, logger);
                 ip += 3;
-                break;
             }
-            case LVM_LogRelationTimer: {
+                DISPATCH();
+            CASE(LVM_LogRelationTimer): {
                 std::string msg = symbolTable.resolve(code[ip + 1]);
                 size_t timerIndex = code[ip + 2];
                 size_t relId = code[ip + 3];
                 const LVMRelation& rel = *getRelation(relId);
                 Logger* logger = new Logger(
-                        msg.c_str(), this->getIterationNumber(), std::bind(&LVMRelation::size, &rel));
+                        msg.c_str(), ctxt.getIterationNumber(), std::bind(&LVMRelation::size, &rel));
                 insertTimerAt(timerIndex, logger);
                 ip += 4;
-                break;
             }
-            case LVM_StopLogTimer: {
+                DISPATCH();
+            CASE(LVM_StopLogTimer): {
                 size_t timerIndex = code[ip + 1];
                 stopTimerAt(timerIndex);
                 ip += 2;
-                break;
             }
-            case LVM_DebugInfo: {
+                DISPATCH();
+            CASE(LVM_DebugInfo): {
                 std::string msg = symbolTable.resolve(code[ip + 1]);
                 SignalHandler::instance()->setMsg(msg.c_str());
                 ip += 2;
-                break;
             }
-            case LVM_Stratum: {
+                DISPATCH();
+            CASE(LVM_Stratum): {
                 this->level++;
                 // Record all the rleation that is created in the previous level
                 if (Global::config().has("profile") || this->level != 0) {
@@ -823,9 +997,38 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                     }
                 }
                 ip += 1;
-                break;
             }
-            case LVM_Create: {
+                DISPATCH();
+            CASE(LVM_ScheduleStrata): {
+                StratumScheduler scheduler;
+                size_t pos = ip + 2;
+                const size_t numStrata = code[pos++];
+                for (size_t i = 0; i < numStrata; ++i) {
+                    const size_t start = code[pos];
+                    const size_t numPredecessors = code[pos + 1];
+                    // each stratum runs on its own context and returns via LVM_Stop_Parallel
+                    scheduler.addStratum(
+                            [this, &codeStream, start]() {
+                                LVMContext stratumCtxt;
+                                this->execute(codeStream, stratumCtxt, start);
+                            },
+                            std::vector<size_t>(
+                                    code.begin() + pos + 2, code.begin() + pos + 2 + numPredecessors));
+                    pos += 2 + numPredecessors;
+                }
+                const size_t numDrops = code[pos++];
+                for (size_t i = 0; i < numDrops; ++i) {
+                    const size_t relId = code[pos];
+                    const size_t numUsers = code[pos + 1];
+                    scheduler.addRelease([this, relId]() { dropRelation(relId); },
+                            std::vector<size_t>(code.begin() + pos + 2, code.begin() + pos + 2 + numUsers));
+                    pos += 2 + numUsers;
+                }
+                scheduler.run(MAX_THREADS);
+                ip = code[ip + 1];
+            }
+                DISPATCH();
+            CASE(LVM_Create): {
                 std::unique_ptr<LVMRelation> res = nullptr;
                 size_t relId = code[ip + 1];
                 std::string relName = relationEncoder.decodeRelation(relId);
@@ -841,40 +1044,63 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
 
                 if (arity == 0) {
                     res = std::make_unique<LVMNullaryRelation>(relName, attributeTypes);
-                } else if (code[ip + 3] == LVM_EQREL) {
-                    res = std::make_unique<LVMEqRelation>(arity, &orderSet, relName, attributeTypes);
-                } else {
-                    res = std::make_unique<LVMIndirectRelation>(arity, &orderSet, relName, attributeTypes);
+                } else if (code[ip + 3] == LVM_EQREL && arity == 2) {
+                    res = std::make_unique<LVMEqRelation>(&orderSet, relName, attributeTypes);
+                } else if (code[ip + 3] == LVM_BRIE) {
+                    // brie relations of unsupported arities fall back to b-tree indexes
+                    res = createBrieRelation(arity, &orderSet, relName, attributeTypes);
+                } else if (code[ip + 3] == LVM_COMPRESSED) {
+                    // compressed relations of unsupported arities fall back to b-tree indexes
+                    res = createCompressedRelation(arity, &orderSet, relName, attributeTypes);
+                } else if (code[ip + 3] == LVM_HASH) {
+                    // hash relations of unsupported arities fall back to b-tree indexes
+                    res = createHashRelation(arity, &orderSet, relName, attributeTypes);
+                }
+                if (res == nullptr) {
+                    res = createBTreeRelation(
+                            RelationNodeSize::get(relName), arity, &orderSet, relName, attributeTypes);
                 }
 
                 res->setLevel(level);
                 environment[relId] = std::move(res);
                 ip += 3 + code[ip + 2] + 1;
-                break;
             }
-            case LVM_Clear: {
+                DISPATCH();
+            CASE(LVM_Clear): {
                 size_t relId = code[ip + 1];
                 auto relPtr = getRelation(relId);
-                relPtr->purge();
+                relPtr->reset();
                 ip += 2;
-                break;
             }
-            case LVM_Drop: {
+                DISPATCH();
+            CASE(LVM_Drop): {
                 size_t relId = code[ip + 1];
                 dropRelation(relId);
                 ip += 2;
-                break;
             }
-            case LVM_LogSize: {
+                DISPATCH();
+            CASE(LVM_LogSize): {
                 size_t relId = code[ip + 1];
                 auto relPtr = getRelation(relId);
                 std::string msg = symbolTable.resolve(code[ip + 2]);
                 ProfileEventSingleton::instance().makeQuantityEvent(
-                        msg, relPtr->size(), this->getIterationNumber());
+                        msg, relPtr->size(), ctxt.getIterationNumber());
                 ip += 3;
-                break;
             }
-            case LVM_Load: {
+                DISPATCH();
+            CASE(LVM_LogStatistics): {
+                size_t relId = code[ip + 1];
+                size_t count = code[ip + 2];
+                auto relPtr = getRelation(relId);
+                RelationStats stats = RelationStats::extractFrom(count, relPtr->begin(), relPtr->end());
+                for (size_t i = 0; i < count; ++i) {
+                    ProfileEventSingleton::instance().makeQuantityEvent(symbolTable.resolve(code[ip + 3 + i]),
+                            stats.getDistinctValues(i), ctxt.getIterationNumber());
+                }
+                ip += 3 + count;
+            }
+                DISPATCH();
+            CASE(LVM_Load): {
                 size_t relId = code[ip + 1];
                 auto IOs = codeStream->getIODirectives()[code[ip + 2]];
 
@@ -893,9 +1119,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                     }
                 }
                 ip += 3;
-                break;
             }
-            case LVM_Store: {
+                DISPATCH();
+            CASE(LVM_Store): {
                 size_t relId = code[ip + 1];
                 auto IOs = codeStream->getIODirectives()[code[ip + 2]];
 
@@ -914,9 +1140,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                     }
                 }
                 ip += 3;
-                break;
             }
-            case LVM_Fact: {
+                DISPATCH();
+            CASE(LVM_Fact): {
                 size_t relId = code[ip + 1];
                 auto arity = code[ip + 2];
                 RamDomain tuple[arity];
@@ -926,9 +1152,9 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
                 getRelation(relId)->insert(tuple);
                 ip += 3;
-                break;
             }
-            case LVM_Merge: {
+                DISPATCH();
+            CASE(LVM_Merge): {
                 size_t sourceId = code[ip + 1];
                 size_t targetId = code[ip + 2];
                 // get involved relation
@@ -943,54 +1169,79 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 trgPtr->insert(*srcPtr);
 
                 ip += 3;
-                break;
             }
-            case LVM_Swap: {
+                DISPATCH();
+            CASE(LVM_Swap): {
                 size_t firstRelId = code[ip + 1];
                 size_t secondRelId = code[ip + 2];
                 swapRelation(firstRelId, secondRelId);
                 ip += 3;
-                break;
             }
-            case LVM_Query:
+                DISPATCH();
+            CASE(LVM_Query):
                 /** Does nothing, just a label */
                 ip += 1;
-                break;
-            case LVM_Goto:
+                DISPATCH();
+            CASE(LVM_AdaptiveQuery): {
+                // Choose the loop nest with the least estimated cost for the current relation sizes
+                size_t count = code[ip + 1];
+                size_t pos = ip + 2;
+                size_t best = 0;
+                size_t bestPos = pos;
+                double bestCost = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    size_t levels = code[pos + 2];
+                    double cost = estimateLoopNestCost(&code[pos + 3], levels);
+                    if (i == 0 || cost < bestCost) {
+                        best = i;
+                        bestPos = pos;
+                        bestCost = cost;
+                    }
+                    pos += 3 + 3 * levels;
+                }
+                const std::string& msg = symbolTable.resolve(code[bestPos + 1]);
+                if (!msg.empty()) {
+                    ProfileEventSingleton::instance().makeQuantityEvent(
+                            msg, best, ctxt.getIterationNumber());
+                }
+                ip = code[bestPos];
+            }
+                DISPATCH();
+            CASE(LVM_Goto):
                 ip = code[ip + 1];
-                break;
-            case LVM_Jmpnz: {
+                DISPATCH();
+            CASE(LVM_Jmpnz): {
                 RamDomain val = stack.top();
                 stack.pop();
                 ip = (val != 0 ? code[ip + 1] : ip + 2);
-                break;
             }
-            case LVM_Jmpez: {
+                DISPATCH();
+            CASE(LVM_Jmpez): {
                 RamDomain val = stack.top();
                 stack.pop();
                 ip = (val == 0 ? code[ip + 1] : ip + 2);
-                break;
             }
-            case LVM_Aggregate: {
+                DISPATCH();
+            CASE(LVM_Aggregate): {
                 ip += 1;
-                break;
-            };
-            case LVM_IndexAggregate: {
+            }
+                DISPATCH();
+            CASE(LVM_IndexAggregate): {
                 ip += 1;
-                break;
-            };
-            case LVM_Aggregate_COUNT: {
+            }
+                DISPATCH();
+            CASE(LVM_Aggregate_COUNT): {
                 RamDomain res = 0;
                 RamDomain idx = code[ip + 1];
-                auto& iter = iteratorPool[idx];
+                auto& iter = ctxt.lookUpIterator(idx);
                 for (auto i = iter.first; i != iter.second; ++i) {
                     res++;
                 }
                 stack.push(res);
                 ip += 2;
-                break;
-            };
-            case LVM_Aggregate_Return: {
+            }
+                DISPATCH();
+            CASE(LVM_Aggregate_Return): {
                 RamDomain id = code[ip + 1];
                 RamDomain res = stack.top();
                 stack.pop();
@@ -998,18 +1249,18 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 tuple[0] = res;
                 ctxt[id] = tuple;
                 ip += 2;
-                break;
-            };
-            case LVM_ITER_InitFullIndex: {
+            }
+                DISPATCH();
+            CASE(LVM_ITER_InitFullIndex): {
                 RamDomain dest = code[ip + 1];
                 size_t relId = code[ip + 2];
                 const auto& relPtr = getRelation(relId);
                 auto iterPairs = std::make_pair(relPtr->begin(), relPtr->end());
-                lookUpIterator(dest) = iterPairs;
+                ctxt.lookUpIterator(dest) = iterPairs;
                 ip += 3;
-                break;
-            };
-            case LVM_ITER_InitRangeIndex: {
+            }
+                DISPATCH();
+            CASE(LVM_ITER_InitRangeIndex): {
                 RamDomain dest = code[ip + 1];
                 size_t relId = code[ip + 2];
                 auto relPtr = getRelation(relId);
@@ -1032,39 +1283,86 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 }
 
                 // get iterator range
-                lookUpIterator(dest) = relPtr->lowerUpperBound(low, hig, indexPos);
+                ctxt.lookUpIterator(dest) = relPtr->lowerUpperBound(low, hig, indexPos);
                 ip += 5;
-                break;
-            };
-            case LVM_ITER_NotAtEnd: {
+            }
+                DISPATCH();
+            CASE(LVM_ITER_NotAtEnd): {
                 RamDomain idx = code[ip + 1];
-                auto& iter = lookUpIterator(idx);
+                auto& iter = ctxt.lookUpIterator(idx);
                 stack.push(iter.first != iter.second);
                 ip += 2;
-                break;
             }
-            case LVM_ITER_Select: {
+                DISPATCH();
+            CASE(LVM_ITER_Select): {
                 RamDomain idx = code[ip + 1];
                 RamDomain tupleId = code[ip + 2];
-                auto& iter = lookUpIterator(idx);
+                auto& iter = ctxt.lookUpIterator(idx);
                 ctxt[tupleId] = *iter.first;
                 ip += 3;
-                break;
             }
-            case LVM_ITER_Inc: {
+                DISPATCH();
+            CASE(LVM_ITER_Inc): {
                 RamDomain idx = code[ip + 1];
-                ++iteratorPool[idx].first;
+                ++ctxt.lookUpIterator(idx).first;
                 ip += 2;
-                break;
             }
-            case LVM_STOP:
+                DISPATCH();
+            CASE(LVM_CompareElementConstant): {
+                RamDomain lhs = ctxt[code[ip + 2]][code[ip + 3]];
+                stack.push(evalComparison(code[ip + 1], lhs, code[ip + 4]));
+                ip += 5;
+            }
+                DISPATCH();
+            CASE(LVM_CompareElements): {
+                RamDomain lhs = ctxt[code[ip + 2]][code[ip + 3]];
+                RamDomain rhs = ctxt[code[ip + 4]][code[ip + 5]];
+                stack.push(evalComparison(code[ip + 1], lhs, rhs));
+                ip += 6;
+            }
+                DISPATCH();
+            CASE(LVM_ProjectElements): {
+                RamDomain arity = code[ip + 1];
+                size_t relId = code[ip + 2];
+                LVMRelation& rel = *getRelation(relId);
+                RamDomain tuple[arity];
+                for (auto i = 0; i < arity; ++i) {
+                    tuple[i] = ctxt[code[ip + 3 + 2 * i]][code[ip + 4 + 2 * i]];
+                }
+                rel.insert(tuple);
+                ip += 3 + 2 * arity;
+            }
+                DISPATCH();
+            CASE(LVM_STOP):
                 assert(stack.size() == 0);
                 return;
-            default:
+            DEFAULT:
                 printf("Unknown. eval()\n");
-                break;
+                DISPATCH();
+        }
+    }
+}
+
+void LVM::executeParallel(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt,
+        std::vector<range<LVMRelation::iterator>>& partitions, size_t iterId, size_t ip) {
+#pragma omp parallel
+    {
+        LVMContext threadCtxt(ctxt);
+#pragma omp for schedule(dynamic)
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            threadCtxt.lookUpIterator(iterId) = std::make_pair(partitions[i].begin(), partitions[i].end());
+            try {
+                this->execute(codeStream, threadCtxt, ip);
+            } catch (std::exception& e) {
+                SignalHandler::instance()->error(e.what());
+            }
         }
     }
 }
 
 }  // end of namespace souffle
+
+#undef SWITCH
+#undef CASE
+#undef DEFAULT
+#undef DISPATCH
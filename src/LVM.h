@@ -26,8 +26,10 @@
 #include "RamTypes.h"
 #include "RelationRepresentation.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <map>
@@ -100,16 +102,13 @@ public:
     void printMain() {
         if (mainProgram.get() == nullptr) {
             LVMGenerator generator(translationUnit.getSymbolTable(), *translationUnit.getProgram()->getMain(),
-                    *isa, relationEncoder);
+                    *isa, relationEncoder, translationUnit.getAnalysis<RamStratumAnalysis>());
             mainProgram = generator.getCodeStream();
         }
         mainProgram->print();
     }
 
 protected:
-    using index_set =
-            btree_multiset<const RamDomain*, LVMIndex::comparator, std::allocator<const RamDomain*>, 512>;
-
     /** Insert Logger */
     void insertTimerAt(size_t index, Logger* timer) {
         if (index >= timers.size()) {
@@ -140,21 +139,6 @@ protected:
         return counter++;
     }
 
-    /** Increment iteration number */
-    void incIterationNumber() {
-        iteration++;
-    }
-
-    /** Get Iteration Number */
-    size_t getIterationNumber() const {
-        return iteration;
-    }
-
-    /** Reset iteration number */
-    void resetIterationNumber() {
-        iteration = 0;
-    }
-
     /** Get a relation */
     LVMRelation* getRelation(size_t id) {
         return environment[id].get();
@@ -170,14 +154,6 @@ protected:
         environment[relAId].swap(environment[relBId]);
     }
 
-    /** Lookup iterator, resize the iterator pool if necessary */
-    std::pair<index_set::iterator, index_set::iterator>& lookUpIterator(size_t idx) {
-        if (idx >= iteratorPool.size()) {
-            iteratorPool.resize(idx + 1);
-        }
-        return iteratorPool[idx];
-    }
-
     /** Obtain the search columns */
     SearchSignature getSearchSignature(const std::string& patterns, size_t arity) {
         SearchSignature res = 0;
@@ -189,6 +165,24 @@ protected:
         return res;
     }
 
+    /**
+     * Estimate the number of tuples visited by a loop nest for the current relation sizes.
+     * Each level is given by a relation id, its arity and the number of columns bound by its search.
+     * A search binding k of n columns of a relation with s tuples is assumed to yield s^((n-k)/n) tuples.
+     */
+    double estimateLoopNestCost(const RamDomain* levels, size_t count) {
+        double tuples = 1;
+        double cost = 0;
+        for (size_t i = 0; i < count; ++i, levels += 3) {
+            const double size = getRelation(levels[0])->size();
+            const RamDomain arity = levels[1];
+            const RamDomain bound = levels[2];
+            tuples *= (bound >= arity) ? std::min(size, 1.0) : std::pow(size, double(arity - bound) / arity);
+            cost += tuples;
+        }
+        return cost;
+    }
+
 private:
     friend LVMProgInterface;
 
@@ -198,6 +192,14 @@ private:
      * */
     void execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t ip = 0);
 
+    /** Execute the loop starting at ip once for every chunk of a partitioned relation.
+     *
+     * The chunks are distributed among the worker threads, each thread runs on its own copy of the
+     * context with the iterator iterId set to the chunk. The loop returns via LVM_Stop_Parallel.
+     * */
+    void executeParallel(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt,
+            std::vector<range<LVMRelation::iterator>>& partitions, size_t iterId, size_t ip);
+
     /** subroutines */
     std::map<std::string, std::unique_ptr<LVMCode>> subroutines;
 
@@ -210,8 +212,8 @@ private:
     /** counters for non-existence check */
     std::map<std::string, std::atomic<size_t>> reads;
 
-    /** List of iters for indexScan operation */
-    std::vector<std::pair<index_set::iterator, index_set::iterator>> iteratorPool;
+    /** Lock for updating the atom profiling counters from parallel operations */
+    Lock profileLock;
 
     /** Hash map from relationName to RamRelationNode in RAM */
     std::unordered_map<std::string, const RamRelation*> relNameToNode;
@@ -223,10 +225,7 @@ private:
     std::vector<Logger*> timers;
 
     /** counter for $ operator */
-    int counter = 0;
-
-    /** iteration number (in a fix-point calculation) */
-    size_t iteration = 0;
+    std::atomic<int> counter{0};
 
     /** Dynamic library for user-defined functors */
     void* dll = nullptr;
@@ -263,6 +263,26 @@ void LVMCode::print() const {
                 printf("%ld\tLVM_IndexScan\n", ip);
                 ip += 1;
                 break;
+            case LVM_ParallelScan:
+                printf("%ld\tLVM_ParallelScan\tIterID:%d\tRelation:%d\tEnd:%d\n", ip, code[ip + 1],
+                        code[ip + 2], code[ip + 3]);
+                ip += 4;
+                break;
+            case LVM_ParallelIndexScan:
+                printf("%ld\tLVM_ParallelIndexScan\tIterID:%d\tRelation:%d\tPattern:%s\tEnd:%d\n", ip,
+                        code[ip + 1], code[ip + 2], symbolTable.resolve(code[ip + 3]).c_str(), code[ip + 5]);
+                ip += 6;
+                break;
+            case LVM_ParallelChoice:
+                printf("%ld\tLVM_ParallelChoice\tIterID:%d\tRelation:%d\tEnd:%d\n", ip, code[ip + 1],
+                        code[ip + 2], code[ip + 3]);
+                ip += 4;
+                break;
+            case LVM_ParallelIndexChoice:
+                printf("%ld\tLVM_ParallelIndexChoice\tIterID:%d\tRelation:%d\tPattern:%s\tEnd:%d\n", ip,
+                        code[ip + 1], code[ip + 2], symbolTable.resolve(code[ip + 3]).c_str(), code[ip + 5]);
+                ip += 6;
+                break;
             case LVM_Search: {
                 printf("%ld\tLVM_Search\t\n", ip);
                 ip += 3;
@@ -273,6 +293,31 @@ void LVMCode::print() const {
                         code[ip + 2], code[ip + 3]);
                 ip += 4;
                 break;
+            case LVM_LeapfrogJoin: {
+                printf("%ld\tLVM_LeapfrogJoin\tJoinID:%d\tVariables:%d\tRelations:%d\n", ip, code[ip + 1],
+                        code[ip + 2], code[ip + 3]);
+                size_t pos = ip + 4;
+                for (RamDomain i = 0; i < code[ip + 3]; ++i) {
+                    RamDomain arity = code[pos + 2];
+                    printf("\t\tRelation:%d\tIndex:%d\tOrder:", code[pos], code[pos + 1]);
+                    for (RamDomain j = 0; j < arity; ++j) {
+                        printf(" %d", code[pos + 3 + j]);
+                    }
+                    printf("\tVariables:");
+                    for (RamDomain j = 0; j < arity; ++j) {
+                        printf(" %d", code[pos + 3 + arity + j]);
+                    }
+                    printf("\n");
+                    pos += 3 + 2 * arity;
+                }
+                ip = pos;
+                break;
+            }
+            case LVM_LeapfrogJoinNext:
+                printf("%ld\tLVM_LeapfrogJoinNext\tJoinID:%d\tID:%d\tEnd:%d\n", ip, code[ip + 1],
+                        code[ip + 2], code[ip + 3]);
+                ip += 4;
+                break;
             case LVM_Filter:
                 printf("%ld\tLVM_Filter\n", ip);
                 ip += 2;
@@ -351,6 +396,30 @@ void LVMCode::print() const {
                 printf("%ld\tLVM_Stratum\t%ld\n", ip, stratumLevel++);
                 ip += 1;
                 break;
+            case LVM_ScheduleStrata: {
+                printf("%ld\tLVM_ScheduleStrata\tEnd:%d\tNumber of strata:%d\n", ip, code[ip + 1],
+                        code[ip + 2]);
+                size_t pos = ip + 3;
+                for (int i = 0; i < code[ip + 2]; ++i) {
+                    printf("Stratum %d start at:%d after:", i, code[pos]);
+                    for (int j = 0; j < code[pos + 1]; ++j) {
+                        printf(" %d", code[pos + 2 + j]);
+                    }
+                    putchar('\n');
+                    pos += 2 + code[pos + 1];
+                }
+                const int numDrops = code[pos++];
+                for (int i = 0; i < numDrops; ++i) {
+                    printf("Drop relation %d after:", code[pos]);
+                    for (int j = 0; j < code[pos + 1]; ++j) {
+                        printf(" %d", code[pos + 2 + j]);
+                    }
+                    putchar('\n');
+                    pos += 2 + code[pos + 1];
+                }
+                ip = pos;
+                break;
+            }
             case LVM_Create: {
                 printf("%ld\tLVM_Create\t Name:%s Arity:%d Struct:%d\n", ip,
                         symbolTable.resolve(code[ip + 1]).c_str(), code[ip + 2], code[ip + 3]);
@@ -379,6 +448,11 @@ void LVMCode::print() const {
                 ip += 3;
                 break;
             }
+            case LVM_LogStatistics: {
+                printf("%ld\tLVM_LogStatistics\tColumns:%d\n", ip, code[ip + 2]);
+                ip += 3 + code[ip + 2];
+                break;
+            }
             case LVM_Load: {
                 printf("%ld\tLVM_Load\t\n", ip);
                 printf("\t%s\t IODirectivesID:%d\n", symbolTable.resolve(code[ip + 1]).c_str(), code[ip + 2]);
@@ -415,6 +489,18 @@ void LVMCode::print() const {
                 printf("%ld\tLVM_Query\t\n", ip);
                 ip += 1;
                 break;
+            case LVM_AdaptiveQuery: {
+                size_t count = code[ip + 1];
+                printf("%ld\tLVM_AdaptiveQuery\tAlternatives:%ld", ip, count);
+                size_t pos = ip + 2;
+                for (size_t i = 0; i < count; ++i) {
+                    printf("\t%d", code[pos]);
+                    pos += 3 + 3 * code[pos + 2];
+                }
+                printf("\n");
+                ip = pos;
+                break;
+            }
             case LVM_Goto:
                 printf("%ld\tLVM_GOTO\t%d\n", ip, code[ip + 1]);
                 ip += 2;
@@ -472,6 +558,27 @@ void LVMCode::print() const {
                 ip += 2;
                 break;
             }
+            case LVM_CompareElementConstant: {
+                printf("%ld\tLVM_CompareElementConstant\tOp:%d\tId:%d\tPos:%d\tConstant:%d\n", ip,
+                        code[ip + 1], code[ip + 2], code[ip + 3], code[ip + 4]);
+                ip += 5;
+                break;
+            }
+            case LVM_CompareElements: {
+                printf("%ld\tLVM_CompareElements\tOp:%d\tId:%d\tPos:%d\tId:%d\tPos:%d\n", ip, code[ip + 1],
+                        code[ip + 2], code[ip + 3], code[ip + 4], code[ip + 5]);
+                ip += 6;
+                break;
+            }
+            case LVM_ProjectElements: {
+                RamDomain arity = code[ip + 1];
+                printf("%ld\tLVM_ProjectElements\tArity:%d\tRelID:%d\t\n", ip, arity, code[ip + 2]);
+                for (RamDomain i = 0; i < arity; ++i) {
+                    printf("\tId:%d\tPos:%d\n", code[ip + 3 + 2 * i], code[ip + 4 + 2 * i]);
+                }
+                ip += 3 + 2 * arity;
+                break;
+            }
             case LVM_NOP:
                 printf("%ld\tLVM_NOP\n", ip);
                 ip += 1;
@@ -91,7 +91,13 @@ enum LVM_Type {
     LVM_IndexScan,
     LVM_Choice,
     LVM_IndexChoice,
+    LVM_ParallelScan,
+    LVM_ParallelIndexScan,
+    LVM_ParallelChoice,
+    LVM_ParallelIndexChoice,
     LVM_UnpackRecord,
+    LVM_LeapfrogJoin,
+    LVM_LeapfrogJoinNext,
     LVM_Aggregate,
     LVM_IndexAggregate,
     LVM_Filter,
@@ -112,16 +118,19 @@ enum LVM_Type {
     LVM_StopLogTimer,
     LVM_DebugInfo,
     LVM_Stratum,
+    LVM_ScheduleStrata,
     LVM_Create,
     LVM_Clear,
     LVM_Drop,
     LVM_LogSize,
+    LVM_LogStatistics,
     LVM_Load,
     LVM_Store,
     LVM_Fact,
     LVM_Merge,
     LVM_Swap,
     LVM_Query,
+    LVM_AdaptiveQuery,
 
     // LVM Branch
     LVM_Goto,
@@ -134,6 +143,8 @@ enum LVM_Type {
     LVM_BTREE,
     LVM_BRIE,
     LVM_EQREL,
+    LVM_COMPRESSED,
+    LVM_HASH,
     LVM_DEFAULT,
 
     LVM_ITER_InitFullIndex,
@@ -142,6 +153,13 @@ enum LVM_Type {
     LVM_ITER_Inc,
     LVM_ITER_NotAtEnd,
 
+    // LVM Superinstructions, fusing frequent instruction sequences
+    LVM_CompareElementConstant,
+    LVM_CompareElements,
+    LVM_ProjectElements,
+
+    // Number of LVM types, must be the last entry
+    LVM_TypeCount
 };
 
 /**
@@ -185,12 +203,42 @@ public:
         return symbolTable;
     }
 
+    /** Check whether the opcodes have been resolved to handler addresses */
+    bool isThreaded() const {
+        return !threadedCode.empty();
+    }
+
+    /** Return the threaded code, holding the handler address of the opcode at each code position */
+    const std::vector<const void*>& getThreadedCode() const {
+        return threadedCode;
+    }
+
+    /**
+     * Resolve the code stream to threaded code.
+     * The handler of a code position is looked up in the handler table (ordered by LVM_Type). Positions
+     * holding operands get an arbitrary handler as they are never dispatched.
+     */
+    void resolveThreadedCode(const void* const* handlers, const void* unknownHandler) {
+        threadedCode.clear();
+        threadedCode.reserve(size());
+        for (RamDomain cur : *this) {
+            if (cur >= 0 && cur < LVM_TypeCount) {
+                threadedCode.push_back(handlers[cur]);
+            } else {
+                threadedCode.push_back(unknownHandler);
+            }
+        }
+    }
+
     /** Print out the code stream */
     virtual void print() const;
 
     virtual ~LVMCode() = default;
 
 private:
+    /** Handler addresses of the opcodes, empty if the code has not been threaded */
+    std::vector<const void*> threadedCode;
+
     /** Store reference to IODirectives */
     std::vector<std::vector<IODirectives>> IODirectivesPool;
 
@@ -16,9 +16,12 @@
 
 #pragma once
 
+#include "LVMRelation.h"
+#include "LeapfrogTrieJoin.h"
 #include "RamTypes.h"
 #include <cassert>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace souffle {
@@ -27,14 +30,29 @@ namespace souffle {
  * Evaluation context for Interpreter operations
  */
 class LVMContext {
+    using iterator = LVMRelation::iterator;
+
     std::vector<const RamDomain*> data;
     std::vector<RamDomain>* returnValues = nullptr;
     std::vector<bool>* returnErrors = nullptr;
     const std::vector<RamDomain>* args = nullptr;
     std::vector<std::unique_ptr<RamDomain[]>> allocatedDataContainer;
+    std::vector<std::pair<iterator, iterator>> iteratorPool;
+    std::vector<std::unique_ptr<LeapfrogTrieJoin>> joinPool;
+
+    /** iteration number (in a fix-point calculation); kept per context as strata may run concurrently */
+    size_t iteration = 0;
 
 public:
     LVMContext(size_t size = 0) : data(size) {}
+
+    /** Create a context for a worker thread of a parallel operation.
+     *  The tuple environment and the subroutine state are shared with the parent context,
+     *  tuples allocated by the parent remain owned by the parent. */
+    LVMContext(const LVMContext& parent)
+            : data(parent.data), returnValues(parent.returnValues), returnErrors(parent.returnErrors),
+              args(parent.args), iteratorPool(parent.iteratorPool), iteration(parent.iteration) {}
+
     virtual ~LVMContext() = default;
 
     const RamDomain*& operator[](size_t index) {
@@ -92,6 +110,37 @@ public:
         assert(args != nullptr && i < args->size() && "argument out of range");
         return (*args)[i];
     }
+
+    /** Increment iteration number */
+    void incIterationNumber() {
+        iteration++;
+    }
+
+    /** Get Iteration Number */
+    size_t getIterationNumber() const {
+        return iteration;
+    }
+
+    /** Reset iteration number */
+    void resetIterationNumber() {
+        iteration = 0;
+    }
+
+    /** Lookup iterator, resize the iterator pool if necessary */
+    std::pair<iterator, iterator>& lookUpIterator(size_t idx) {
+        if (idx >= iteratorPool.size()) {
+            iteratorPool.resize(idx + 1);
+        }
+        return iteratorPool[idx];
+    }
+
+    /** Lookup leapfrog join, resize the join pool if necessary */
+    std::unique_ptr<LeapfrogTrieJoin>& lookUpJoin(size_t idx) {
+        if (idx >= joinPool.size()) {
+            joinPool.resize(idx + 1);
+        }
+        return joinPool[idx];
+    }
 };
 
 }  // end of namespace souffle
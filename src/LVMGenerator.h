@@ -17,6 +17,7 @@
 
 #include "LVMCode.h"
 #include "RamIndexAnalysis.h"
+#include "RamStratumAnalysis.h"
 #include "RamVisitor.h"
 
 namespace souffle {
@@ -64,11 +65,14 @@ public:
      * The transformation is done in the constructor.
      * This is done by traversing the tree twice, in order to find the necessary information (Jump
      * destination) for LVM branch operations.
+     * If the stratum analysis of the main program is given, independent strata are scheduled concurrently.
      */
     LVMGenerator(SymbolTable& symbolTable, const RamStatement& entry, RamIndexAnalysis& isa,
-            RelationEncoder& relationEncoder)
+            RelationEncoder& relationEncoder, const RamStratumAnalysis* stratumAnalysis = nullptr)
             : symbolTable(symbolTable), code(new LVMCode(symbolTable)), isa(isa),
-              relationEncoder(relationEncoder) {
+              relationEncoder(relationEncoder),
+              stratumAnalysis(stratumAnalysis != nullptr && stratumAnalysis->isConcurrent() ? stratumAnalysis
+                                                                                           : nullptr) {
         (*this)(entry, 0);
         (*this).cleanUp();
         (*this)(entry, 0);
@@ -79,6 +83,14 @@ public:
         return std::move(this->code);
     }
 
+    /** Print the number of superinstructions generated for each fused instruction sequence */
+    void printFusionStatistics(std::ostream& os) const {
+        os << "LVM superinstructions:\n";
+        os << "  compare tuple element to constant: " << getFusionCount(LVM_CompareElementConstant) << "\n";
+        os << "  compare two tuple elements:        " << getFusionCount(LVM_CompareElements) << "\n";
+        os << "  project tuple of tuple elements:   " << getFusionCount(LVM_ProjectElements) << "\n";
+    }
+
 protected:
     // Visit RAM Expressions
 
@@ -307,43 +319,49 @@ protected:
     }
 
     void visitConstraint(const RamConstraint& relOp, size_t exitAddress) override {
-        code->push_back(LVM_Constraint);
-        visit(relOp.getLHS(), exitAddress);
-        visit(relOp.getRHS(), exitAddress);
+        LVM_Type op = LVM_NOP;
         switch (relOp.getOperator()) {
             case BinaryConstraintOp::EQ:
-                code->push_back(LVM_OP_EQ);
+                op = LVM_OP_EQ;
                 break;
             case BinaryConstraintOp::NE:
-                code->push_back(LVM_OP_NE);
+                op = LVM_OP_NE;
                 break;
             case BinaryConstraintOp::LT:
-                code->push_back(LVM_OP_LT);
+                op = LVM_OP_LT;
                 break;
             case BinaryConstraintOp::LE:
-                code->push_back(LVM_OP_LE);
+                op = LVM_OP_LE;
                 break;
             case BinaryConstraintOp::GT:
-                code->push_back(LVM_OP_GT);
+                op = LVM_OP_GT;
                 break;
             case BinaryConstraintOp::GE:
-                code->push_back(LVM_OP_GE);
+                op = LVM_OP_GE;
                 break;
             case BinaryConstraintOp::MATCH:
-                code->push_back(LVM_OP_MATCH);
+                op = LVM_OP_MATCH;
                 break;
             case BinaryConstraintOp::NOT_MATCH:
-                code->push_back(LVM_OP_NOT_MATCH);
+                op = LVM_OP_NOT_MATCH;
                 break;
             case BinaryConstraintOp::CONTAINS:
-                code->push_back(LVM_OP_CONTAINS);
+                op = LVM_OP_CONTAINS;
                 break;
             case BinaryConstraintOp::NOT_CONTAINS:
-                code->push_back(LVM_OP_NOT_CONTAINS);
+                op = LVM_OP_NOT_CONTAINS;
                 break;
             default:
                 assert(false && "unsupported operator");
         }
+
+        if (fuseConstraint(op, relOp.getLHS(), relOp.getRHS())) {
+            return;
+        }
+        code->push_back(LVM_Constraint);
+        visit(relOp.getLHS(), exitAddress);
+        visit(relOp.getRHS(), exitAddress);
+        code->push_back(op);
     }
 
     // Visit RAM Operations
@@ -533,6 +551,204 @@ protected:
         setAddress(L2, code->size());
     }
 
+    void visitParallelScan(const RamParallelScan& pScan, size_t exitAddress) override {
+        code->push_back(LVM_ParallelScan);
+        size_t counterLabel = getNewIterator();
+        size_t L1 = getNewAddressLabel();
+        size_t L2 = getNewAddressLabel();
+        size_t address_start = code->size() - 1;
+
+        // Partition the relation, each worker runs the loop below on its own chunk
+        code->push_back(counterLabel);
+        code->push_back(relationEncoder.encodeRelation(pScan.getRelation().getName()));
+        code->push_back(lookupAddress(L2));
+
+        // While iterator is not at end
+        size_t address_L0 = code->size();
+        code->push_back(LVM_ITER_NotAtEnd);
+        code->push_back(counterLabel);
+        code->push_back(LVM_Jmpez);
+        code->push_back(lookupAddress(L1));
+
+        // Select the tuple pointed by iter
+        code->push_back(LVM_ITER_Select);
+        code->push_back(counterLabel);
+        code->push_back(pScan.getTupleId());
+
+        // Perform nested operation
+        visitTupleOperation(pScan, lookupAddress(L1));
+
+        // Increment the Iter and jump to the start of the while loop
+        code->push_back(LVM_ITER_Inc);
+        code->push_back(counterLabel);
+        code->push_back(LVM_Goto);
+        code->push_back(address_L0);
+
+        // End of the chunk, return to the parallel operation
+        setAddress(L1, code->size());
+        code->push_back(LVM_Stop_Parallel);
+        code->push_back(address_start);
+        setAddress(L2, code->size());
+    }
+
+    void visitParallelChoice(const RamParallelChoice& pChoice, size_t exitAddress) override {
+        code->push_back(LVM_ParallelChoice);
+        size_t counterLabel = getNewIterator();
+        size_t L1 = getNewAddressLabel();
+        size_t L2 = getNewAddressLabel();
+        size_t L3 = getNewAddressLabel();
+        size_t address_start = code->size() - 1;
+
+        // Partition the relation, each worker runs the loop below on its own chunk
+        code->push_back(counterLabel);
+        code->push_back(relationEncoder.encodeRelation(pChoice.getRelation().getName()));
+        code->push_back(lookupAddress(L3));
+
+        // While iterator is not at end
+        size_t address_L0 = code->size();
+        code->push_back(LVM_ITER_NotAtEnd);
+        code->push_back(counterLabel);
+        code->push_back(LVM_Jmpez);
+        code->push_back(lookupAddress(L2));
+
+        // Select the tuple pointed by iter
+        code->push_back(LVM_ITER_Select);
+        code->push_back(counterLabel);
+        code->push_back(pChoice.getTupleId());
+
+        // If condition is met, perform nested operation and exit.
+        visit(pChoice.getCondition(), lookupAddress(L2));
+        code->push_back(LVM_Jmpnz);
+        code->push_back(lookupAddress(L1));
+
+        // Else increment the iter and jump to the start of the while loop.
+        code->push_back(LVM_ITER_Inc);
+        code->push_back(counterLabel);
+        code->push_back(LVM_Goto);
+        code->push_back(address_L0);
+
+        setAddress(L1, code->size());
+        visitTupleOperation(pChoice, lookupAddress(L2));
+
+        // End of the chunk, return to the parallel operation
+        setAddress(L2, code->size());
+        code->push_back(LVM_Stop_Parallel);
+        code->push_back(address_start);
+        setAddress(L3, code->size());
+    }
+
+    void visitParallelIndexScan(const RamParallelIndexScan& piscan, size_t exitAddress) override {
+        size_t counterLabel = getNewIterator();
+        size_t L1 = getNewAddressLabel();
+        size_t L2 = getNewAddressLabel();
+
+        // Obtain the pattern for index
+        auto patterns = piscan.getRangePattern();
+        std::string types;
+        auto arity = piscan.getRelation().getArity();
+        for (size_t i = 0; i < arity; i++) {
+            if (!isRamUndefValue(patterns[i])) {
+                visit(patterns[i], exitAddress);
+            }
+            types += (isRamUndefValue(patterns[i]) ? "_" : "V");
+        }
+
+        // Partition the range of the index, each worker runs the loop below on its own chunk
+        size_t address_start = code->size();
+        code->push_back(LVM_ParallelIndexScan);
+        code->push_back(counterLabel);
+        code->push_back(relationEncoder.encodeRelation(piscan.getRelation().getName()));
+        code->push_back(symbolTable.lookup(types));
+        code->push_back(getIndexPos(piscan));
+        code->push_back(lookupAddress(L2));
+
+        // While iter is not at end
+        size_t address_L0 = code->size();
+        code->push_back(LVM_ITER_NotAtEnd);
+        code->push_back(counterLabel);
+        code->push_back(LVM_Jmpez);
+        code->push_back(lookupAddress(L1));
+
+        // Select the tuple pointed by the iter
+        code->push_back(LVM_ITER_Select);
+        code->push_back(counterLabel);
+        code->push_back(piscan.getTupleId());
+
+        // Perform nested operation
+        visitTupleOperation(piscan, lookupAddress(L1));
+
+        // Increment the iter and jump to the start of while loop.
+        code->push_back(LVM_ITER_Inc);
+        code->push_back(counterLabel);
+        code->push_back(LVM_Goto);
+        code->push_back(address_L0);
+
+        // End of the chunk, return to the parallel operation
+        setAddress(L1, code->size());
+        code->push_back(LVM_Stop_Parallel);
+        code->push_back(address_start);
+        setAddress(L2, code->size());
+    }
+
+    void visitParallelIndexChoice(const RamParallelIndexChoice& piChoice, size_t exitAddress) override {
+        size_t counterLabel = getNewIterator();
+        size_t L1 = getNewAddressLabel();
+        size_t L2 = getNewAddressLabel();
+        size_t L3 = getNewAddressLabel();
+
+        // Obtain the pattern for index
+        auto patterns = piChoice.getRangePattern();
+        std::string types;
+        auto arity = piChoice.getRelation().getArity();
+        for (size_t i = 0; i < arity; i++) {
+            if (!isRamUndefValue(patterns[i])) {
+                visit(patterns[i], exitAddress);
+            }
+            types += (isRamUndefValue(patterns[i]) ? "_" : "V");
+        }
+
+        // Partition the range of the index, each worker runs the loop below on its own chunk
+        size_t address_start = code->size();
+        code->push_back(LVM_ParallelIndexChoice);
+        code->push_back(counterLabel);
+        code->push_back(relationEncoder.encodeRelation(piChoice.getRelation().getName()));
+        code->push_back(symbolTable.lookup(types));
+        code->push_back(getIndexPos(piChoice));
+        code->push_back(lookupAddress(L3));
+
+        // While iter is not at end.
+        size_t address_L0 = code->size();
+        code->push_back(LVM_ITER_NotAtEnd);
+        code->push_back(counterLabel);
+        code->push_back(LVM_Jmpez);
+        code->push_back(lookupAddress(L2));
+
+        // Select the tuple pointed by iter
+        code->push_back(LVM_ITER_Select);
+        code->push_back(counterLabel);
+        code->push_back(piChoice.getTupleId());
+
+        // If condition is true, perform nested operation and return.
+        visit(piChoice.getCondition(), lookupAddress(L2));
+        code->push_back(LVM_Jmpnz);
+        code->push_back(lookupAddress(L1));
+
+        // Else increment the iter and continue
+        code->push_back(LVM_ITER_Inc);
+        code->push_back(counterLabel);
+        code->push_back(LVM_Goto);
+        code->push_back(address_L0);
+
+        setAddress(L1, code->size());
+        visitTupleOperation(piChoice, lookupAddress(L2));
+
+        // End of the chunk, return to the parallel operation
+        setAddress(L2, code->size());
+        code->push_back(LVM_Stop_Parallel);
+        code->push_back(address_start);
+        setAddress(L3, code->size());
+    }
+
     void visitUnpackRecord(const RamUnpackRecord& lookup, size_t exitAddress) override {
         // (xiaowen): In the case where reference we want to look up is null, we should return.
         // This can be expressed by the LVM instructions or delegate to CPP code.
@@ -547,6 +763,47 @@ protected:
         setAddress(L0, code->size());
     }
 
+    void visitLeapfrogJoin(const RamLeapfrogJoin& join, size_t exitAddress) override {
+        size_t joinLabel = getNewJoin();
+        size_t L1 = getNewAddressLabel();
+        auto relations = join.getRelations();
+
+        // Init the join with the relations, the indexes ordered by the variables of their columns,
+        // these orders and the variables
+        code->push_back(LVM_LeapfrogJoin);
+        code->push_back(joinLabel);
+        code->push_back(join.getNumVariables());
+        code->push_back(relations.size());
+        for (size_t i = 0; i < relations.size(); ++i) {
+            auto order = join.getOrder(i);
+            const MinIndexSelection::LexOrder lexOrder(order.begin(), order.end());
+            code->push_back(relationEncoder.encodeRelation(relations[i]->getName()));
+            code->push_back(isa.getIndexes(*relations[i]).getOrderNum(lexOrder));
+            code->push_back(order.size());
+            for (size_t column : order) {
+                code->push_back(column);
+            }
+            for (size_t variable : join.getSortedVariables(i)) {
+                code->push_back(variable);
+            }
+        }
+
+        // While the join finds another binding
+        size_t address_L0 = code->size();
+        code->push_back(LVM_LeapfrogJoinNext);
+        code->push_back(joinLabel);
+        code->push_back(join.getTupleId());
+        code->push_back(lookupAddress(L1));
+
+        // Perform nested operation
+        visitTupleOperation(join, lookupAddress(L1));
+
+        code->push_back(LVM_Goto);
+        code->push_back(address_L0);
+
+        setAddress(L1, code->size());
+    }
+
     void visitAggregate(const RamAggregate& aggregate, size_t exitAddress) override {
         code->push_back(LVM_Aggregate);
         size_t counterLabel = getNewIterator();
@@ -809,6 +1066,23 @@ protected:
         size_t arity = project.getRelation().getArity();
         std::string relationName = project.getRelation().getName();
         auto values = project.getValues();
+
+        // Project tuple elements only: fuse the element accesses into the projection
+        if (all_of(values, [](const RamExpression* value) {
+                return dynamic_cast<const RamTupleElement*>(value) != nullptr;
+            })) {
+            code->push_back(LVM_ProjectElements);
+            code->push_back(arity);
+            code->push_back(relationEncoder.encodeRelation(relationName));
+            for (auto& value : values) {
+                auto* element = static_cast<const RamTupleElement*>(value);
+                code->push_back(element->getTupleId());
+                code->push_back(element->getElement());
+            }
+            fusions[LVM_ProjectElements]++;
+            return;
+        }
+
         for (auto& value : values) {
             assert(value);
             visit(value, exitAddress);
@@ -837,6 +1111,10 @@ protected:
     /** Visit RAM stmt*/
 
     void visitSequence(const RamSequence& seq, size_t exitAddress) override {
+        if (stratumAnalysis != nullptr && &seq == stratumAnalysis->getMain()) {
+            visitStrata(exitAddress);
+            return;
+        }
         code->push_back(LVM_Sequence);
         for (const auto& cur : seq.getStatements()) {
             visit(cur, exitAddress);
@@ -878,6 +1156,48 @@ protected:
         setAddress(endAddress, code->size());
     }
 
+    /**
+     * Emit the strata of the main program as tasks of a stratum scheduler. Each stratum returns via
+     * LVM_Stop_Parallel; its deferred drops are run by the scheduler once their relations expired.
+     */
+    void visitStrata(size_t exitAddress) {
+        const auto& strata = stratumAnalysis->getStrata();
+        code->push_back(LVM_ScheduleStrata);
+        size_t endAddress = getNewAddressLabel();
+        code->push_back(lookupAddress(endAddress));
+        code->push_back(strata.size());
+        std::vector<size_t> startAddresses(strata.size());
+        for (size_t i = 0; i < strata.size(); ++i) {
+            startAddresses[i] = getNewAddressLabel();
+            code->push_back(lookupAddress(startAddresses[i]));
+            const auto& predecessors = stratumAnalysis->getPredecessors(i);
+            code->push_back(predecessors.size());
+            for (size_t predecessor : predecessors) {
+                code->push_back(predecessor);
+            }
+        }
+        const auto& drops = stratumAnalysis->getDeferredDrops();
+        code->push_back(drops.size());
+        for (const RamDrop* drop : drops) {
+            code->push_back(relationEncoder.encodeRelation(drop->getRelation().getName()));
+            const auto& users = stratumAnalysis->getUsers(*drop);
+            code->push_back(users.size());
+            for (size_t user : users) {
+                code->push_back(user);
+            }
+        }
+
+        for (size_t i = 0; i < strata.size(); ++i) {
+            setAddress(startAddresses[i], code->size());
+            for (const RamStatement* stmt : stratumAnalysis->getStatements(i)) {
+                visit(stmt, exitAddress);
+            }
+            code->push_back(LVM_Stop_Parallel);
+            code->push_back(LVM_NOP);
+        }
+        setAddress(endAddress, code->size());
+    }
+
     void visitLoop(const RamLoop& loop, size_t exitAddress) override {
         size_t address_L0 = code->size();
         code->push_back(LVM_Loop);
@@ -937,7 +1257,7 @@ protected:
         code->push_back(LVM_Create);
         code->push_back(relationEncoder.encodeRelation(create.getRelation().getName()));
         code->push_back(create.getRelation().getArity());
-        switch (create.getRelation().getRepresentation()) {
+        switch (isa.getRepresentation(create.getRelation())) {
             case RelationRepresentation::BTREE:
                 code->push_back(LVM_BTREE);
                 break;
@@ -947,6 +1267,12 @@ protected:
             case RelationRepresentation::EQREL:
                 code->push_back(LVM_EQREL);
                 break;
+            case RelationRepresentation::COMPRESSED:
+                code->push_back(LVM_COMPRESSED);
+                break;
+            case RelationRepresentation::HASH:
+                code->push_back(LVM_HASH);
+                break;
             case RelationRepresentation::DEFAULT:
                 code->push_back(LVM_DEFAULT);
             default:
@@ -975,6 +1301,15 @@ protected:
         code->push_back(symbolTable.lookup(size.getMessage()));
     }
 
+    void visitLogStatistics(const RamLogStatistics& statistics, size_t exitAddress) override {
+        code->push_back(LVM_LogStatistics);
+        code->push_back(relationEncoder.encodeRelation(statistics.getRelation().getName()));
+        code->push_back(statistics.getMessages().size());
+        for (const auto& message : statistics.getMessages()) {
+            code->push_back(symbolTable.lookup(message));
+        }
+    }
+
     void visitLoad(const RamLoad& load, size_t exitAddress) override {
         code->push_back(LVM_Load);
         code->push_back(relationEncoder.encodeRelation(load.getRelation().getName()));
@@ -1008,6 +1343,50 @@ protected:
         visit(insert.getOperation(), exitAddress);
     }
 
+    void visitAdaptiveQuery(const RamAdaptiveQuery& adaptive, size_t exitAddress) override {
+        code->push_back(LVM_AdaptiveQuery);
+        auto queries = adaptive.getQueries();
+        code->push_back(queries.size());
+
+        // For each alternative: its address, profile text and loop nest, outermost level first
+        std::vector<size_t> startLabels;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            startLabels.push_back(getNewAddressLabel());
+            code->push_back(lookupAddress(startLabels[i]));
+            code->push_back(symbolTable.lookup(adaptive.getProfileText(i)));
+            std::vector<RamDomain> levels;
+            visitDepthFirst(*queries[i], [&](const RamRelationOperation& op) {
+                const RamRelation& rel = op.getRelation();
+                size_t bound = 0;
+                if (dynamic_cast<const RamAbstractChoice*>(&op) != nullptr ||
+                        dynamic_cast<const RamAbstractAggregate*>(&op) != nullptr) {
+                    // yields at most one tuple
+                    bound = rel.getArity();
+                } else if (const auto* indexOp = dynamic_cast<const RamIndexOperation*>(&op)) {
+                    for (const auto* value : indexOp->getRangePattern()) {
+                        bound += isRamUndefValue(value) ? 0 : 1;
+                    }
+                }
+                levels.push_back(relationEncoder.encodeRelation(rel.getName()));
+                levels.push_back(rel.getArity());
+                levels.push_back(bound);
+            });
+            code->push_back(levels.size() / 3);
+            for (RamDomain cur : levels) {
+                code->push_back(cur);
+            }
+        }
+
+        size_t endLabel = getNewAddressLabel();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            setAddress(startLabels[i], code->size());
+            visit(queries[i], exitAddress);
+            code->push_back(LVM_Goto);
+            code->push_back(lookupAddress(endLabel));
+        }
+        setAddress(endLabel, code->size());
+    }
+
     void visitMerge(const RamMerge& merge, size_t exitAddress) override {
         std::string source = merge.getSourceRelation().getName();
         std::string target = merge.getTargetRelation().getName();
@@ -1049,26 +1428,101 @@ private:
     /** Current iterator index */
     size_t iteratorIndex = 0;
 
+    /** Current leapfrog join index */
+    size_t joinIndex = 0;
+
     /** Current timer index for logger */
     size_t timerIndex = 0;
 
+    /** Number of generated superinstructions per opcode */
+    std::map<LVM_Type, size_t> fusions;
+
     /** RamIndexAnalysis */
     RamIndexAnalysis& isa;
 
     /** Relation Encoder */
     RelationEncoder& relationEncoder;
 
+    /** RamStratumAnalysis of the main program if its strata are scheduled concurrently */
+    const RamStratumAnalysis* stratumAnalysis;
+
     /** Clean up all the content except for addressMap
      *  This is for the double traverse when transforming from RAM -> LVM Bytecode.
      * */
     void cleanUp() {
         code->clear();
+        fusions.clear();
         code->getIODirectives().clear();
         currentAddressLabel = 0;
         iteratorIndex = 0;
+        joinIndex = 0;
         timerIndex = 0;
     }
 
+    /**
+     * Fuse a numeric comparison of a tuple element with a constant or with another tuple element into a
+     * superinstruction. Return false if the constraint does not match any of these patterns.
+     */
+    bool fuseConstraint(LVM_Type op, const RamExpression& lhs, const RamExpression& rhs) {
+        if (op != LVM_OP_EQ && op != LVM_OP_NE && op != LVM_OP_LT && op != LVM_OP_LE && op != LVM_OP_GT &&
+                op != LVM_OP_GE) {
+            return false;
+        }
+        auto* lhsElement = dynamic_cast<const RamTupleElement*>(&lhs);
+        auto* rhsElement = dynamic_cast<const RamTupleElement*>(&rhs);
+        auto* lhsNumber = dynamic_cast<const RamNumber*>(&lhs);
+        auto* rhsNumber = dynamic_cast<const RamNumber*>(&rhs);
+
+        if (lhsElement != nullptr && rhsElement != nullptr) {
+            code->push_back(LVM_CompareElements);
+            code->push_back(op);
+            code->push_back(lhsElement->getTupleId());
+            code->push_back(lhsElement->getElement());
+            code->push_back(rhsElement->getTupleId());
+            code->push_back(rhsElement->getElement());
+            fusions[LVM_CompareElements]++;
+            return true;
+        }
+
+        // A constant on the left-hand side is moved to the right by mirroring the operator
+        if (lhsNumber != nullptr && rhsElement != nullptr) {
+            std::swap(lhsElement, rhsElement);
+            std::swap(lhsNumber, rhsNumber);
+            switch (op) {
+                case LVM_OP_LT:
+                    op = LVM_OP_GT;
+                    break;
+                case LVM_OP_LE:
+                    op = LVM_OP_GE;
+                    break;
+                case LVM_OP_GT:
+                    op = LVM_OP_LT;
+                    break;
+                case LVM_OP_GE:
+                    op = LVM_OP_LE;
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (lhsElement != nullptr && rhsNumber != nullptr) {
+            code->push_back(LVM_CompareElementConstant);
+            code->push_back(op);
+            code->push_back(lhsElement->getTupleId());
+            code->push_back(lhsElement->getElement());
+            code->push_back(rhsNumber->getConstant());
+            fusions[LVM_CompareElementConstant]++;
+            return true;
+        }
+        return false;
+    }
+
+    /** Return the number of generated superinstructions of an opcode */
+    size_t getFusionCount(LVM_Type opcode) const {
+        auto it = fusions.find(opcode);
+        return it == fusions.end() ? 0 : it->second;
+    }
+
     /** Get new Address Label */
     size_t getNewAddressLabel() {
         return currentAddressLabel++;
@@ -1079,6 +1533,11 @@ private:
         return iteratorIndex++;
     }
 
+    /** Get new leapfrog join */
+    size_t getNewJoin() {
+        return joinIndex++;
+    }
+
     /** Get new Timer */
     size_t getNewTimer() {
         return timerIndex++;
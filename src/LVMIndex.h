@@ -15,15 +15,157 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
 #include <utility>
+#include <vector>
 
 #include "BTree.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
+#include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "Util.h"
 
 namespace souffle {
 
-/* B-Tree indexes as default implementation for indexes */
+/*
+ * Slot of the calling thread among the live threads using LVM indexes
+ *
+ * Slots are dense and handed back when their thread terminates, so that state kept per thread by an index
+ * can be held in an array indexed by slot. OpenMP thread numbers do not serve, since the OpenMP teams of
+ * strata evaluated concurrently reuse the same thread numbers.
+ */
+class LVMThreadSlot {
+public:
+    /** Obtain the slot of the calling thread */
+    static size_t get() {
+        static thread_local Holder holder;
+        return holder.slot;
+    }
+
+private:
+    /** Holds the slot of a thread for its lifetime */
+    struct Holder {
+        const size_t slot;
+
+        Holder() : slot(acquire()) {}
+
+        ~Holder() {
+            release(slot);
+        }
+    };
+
+    /** Free slots and the number of slots handed out so far */
+    struct Registry {
+        std::mutex lock;
+        std::vector<size_t> free;
+        size_t next = 0;
+    };
+
+    static Registry& registry() {
+        static Registry res;
+        return res;
+    }
+
+    static size_t acquire() {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        if (reg.free.empty()) {
+            return reg.next++;
+        }
+        size_t res = reg.free.back();
+        reg.free.pop_back();
+        return res;
+    }
+
+    static void release(size_t slot) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        reg.free.push_back(slot);
+    }
+};
+
+/*
+ * Operation hints of the threads using an index
+ *
+ * The hints are held in blocks of doubling size indexed by the slot of the thread, which are allocated
+ * when a thread of a new slot first uses the index and released with the index. A thread inheriting the
+ * slot of a terminated thread inherits its hints, which remain valid hints for the index.
+ */
+template <typename Hints>
+class LVMThreadHints {
+public:
+    LVMThreadHints() {
+        for (auto& block : blocks) {
+            block.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    LVMThreadHints(const LVMThreadHints&) : LVMThreadHints() {}
+
+    LVMThreadHints& operator=(const LVMThreadHints&) = delete;
+
+    ~LVMThreadHints() {
+        for (auto& block : blocks) {
+            delete[] block.load(std::memory_order_relaxed);
+        }
+    }
+
+    /** Obtain the operation hints of the calling thread */
+    Hints& get() {
+        const size_t slot = LVMThreadSlot::get() + FIRST_BLOCK_SIZE;
+        const size_t block = (63 - __builtin_clzll(slot)) - FIRST_BLOCK_BITS;
+        padded_hints* cur = blocks[block].load(std::memory_order_acquire);
+        if (cur == nullptr) {
+            // threads of slots of the same block may race to allocate it, the losers discard theirs
+            padded_hints* fresh = new padded_hints[FIRST_BLOCK_SIZE << block];
+            if (blocks[block].compare_exchange_strong(cur, fresh, std::memory_order_acq_rel)) {
+                cur = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
+        return cur[slot - (FIRST_BLOCK_SIZE << block)].hints;
+    }
+
+    /** Invalidate the operation hints of all threads, not concurrently with operations on the index */
+    void invalidate() {
+        for (size_t i = 0; i < MAX_BLOCKS; ++i) {
+            padded_hints* cur = blocks[i].load(std::memory_order_relaxed);
+            if (cur != nullptr) {
+                for (size_t j = 0; j < (FIRST_BLOCK_SIZE << i); ++j) {
+                    cur[j].hints.clear();
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr size_t FIRST_BLOCK_BITS = 3;
+    static constexpr size_t FIRST_BLOCK_SIZE = 1ul << FIRST_BLOCK_BITS;
+    static constexpr size_t MAX_BLOCKS = 64 - FIRST_BLOCK_BITS;
+
+    /** Operation hints of one thread, padded so that the hints of different threads share no cache line */
+    struct padded_hints {
+        Hints hints;
+        char padding[64 - sizeof(Hints) % 64];
+    };
+
+    /** Blocks holding the hints, block i holds FIRST_BLOCK_SIZE << i slots */
+    std::array<std::atomic<padded_hints*>, MAX_BLOCKS> blocks;
+};
+
+/*
+ * B-Tree indexes as default implementation for indexes
+ *
+ * The index stores tuple pointers. Its order must cover all columns of the tuples, so that an insertion
+ * fails exactly if the tuple is contained. NodeSize is the size of the b-tree nodes in bytes, see
+ * RelationNodeSize.h.
+ */
+template <unsigned NodeSize = 512>
 class LVMIndex {
     using LexOrder = std::vector<int>;
 
@@ -64,10 +206,12 @@ public:
         }
     };
 
-    /* btree for storing tuple pointers with a given lexicographical order */
-    using index_set = btree_multiset<const RamDomain*, comparator, std::allocator<const RamDomain*>, 512>;
+    /* btree for storing tuple pointers with a given lexicographical order, which covers all columns */
+    using index_set = btree_set<const RamDomain*, comparator, std::allocator<const RamDomain*>, NodeSize>;
+
+    using iterator = typename index_set::iterator;
 
-    using iterator = index_set::iterator;
+    using operation_hints = typename index_set::template btree_operation_hints<1>;
 
     LVMIndex(LexOrder order) : theOrder(std::move(order)), set(comparator(theOrder), comparator(theOrder)) {}
 
@@ -77,34 +221,40 @@ public:
         return theOrder;
     }
 
-    /**
-     * add tuple to the index
-     *
-     * precondition: tuple does not exist in the index
-     */
-    void insert(const RamDomain* tuple) {
-        set.insert(tuple, operation_hints);
+    /** add tuple to the index, return true if no equal tuple was contained */
+    bool insert(const RamDomain* tuple) {
+        return set.insert(tuple, hints.get());
     }
 
     /**
-     * add tuples to the index via an iterator
+     * add tuples to the index via an iterator, ignoring those contained
      *
-     * precondition: the tuples do not exist in the index
+     * The tuples are sorted into a b-tree of their own, which is merged with the index in linear time if
+     * it is large compared to the index. Must not run concurrently with other operations on the index.
      */
     template <class Iter>
     void insert(const Iter& a, const Iter& b) {
-        set.insert(a, b);
+        index_set fresh{comparator(theOrder), comparator(theOrder)};
+        fresh.insert(a, b);
+        set.insertAll(fresh);
+        hints.invalidate();
     };
 
     /** check whether tuple exists in index */
     bool exists(const RamDomain* value) {
-        return set.find(value, operation_hints) != set.end();
+        return set.find(value, hints.get()) != set.end();
     }
 
     /** purge all hashes of index */
     void purge() {
         set.clear();
-        operation_hints.clear();
+        hints.invalidate();
+    }
+
+    /** purge all hashes of index, keeping the memory of the b-tree for reuse */
+    void reset() {
+        set.reset();
+        hints.invalidate();
     }
 
     /** enables the index to be printed */
@@ -121,8 +271,9 @@ public:
 
     /** return start and end iterator of a range */
     inline std::pair<iterator, iterator> lowerUpperBound(const RamDomain* low, const RamDomain* high) {
+        operation_hints& threadHints = hints.get();
         return std::pair<iterator, iterator>(
-                set.lower_bound(low, operation_hints), set.upper_bound(high, operation_hints));
+                set.lower_bound(low, threadHints), set.upper_bound(high, threadHints));
     }
 
     /** return start and end iterator of the index set */
@@ -138,6 +289,11 @@ public:
         return set.end();
     }
 
+    /** partition the index into chunks of roughly equal size for parallel iteration */
+    std::vector<range<iterator>> partition() const {
+        return set.getChunks(400);
+    }
+
 private:
     /** retain the index order used to construct an object of this class */
     const LexOrder theOrder;
@@ -145,8 +301,143 @@ private:
     /** set storing tuple pointers of table */
     index_set set;
 
-    /** Operation hints */
-    index_set::btree_operation_hints<1> operation_hints;
+    /** Operation hints of the threads using the index */
+    LVMThreadHints<operation_hints> hints;
+};
+
+/*
+ * B-Tree index storing tuples of a fixed arity inline
+ *
+ * The columns of the tuples are permuted into the lexicographical order of the index, completed by the
+ * columns it does not cover, so that the tuples are compared by the comparator of the full index of
+ * compiled relations, unrolled for the arity. The bound columns of a search form a prefix of the order.
+ */
+template <size_t Arity, unsigned NodeSize = 512>
+class LVMDirectIndex {
+    using LexOrder = std::vector<int>;
+
+public:
+    /* tuple with its columns permuted into the order of the index */
+    using tuple_type = ram::Tuple<RamDomain, Arity>;
+
+    /* lexicographical comparison of all columns of permuted tuples */
+    using comparator = typename ram::index_utils::get_full_index<Arity>::type::comparator;
+
+    /* btree for storing the permuted tuples */
+    using index_set = btree_set<tuple_type, comparator, std::allocator<tuple_type>, NodeSize>;
+
+    using iterator = typename index_set::iterator;
+
+    using operation_hints = typename index_set::operation_hints;
+
+    /* column order of the permuted tuples, columns[i] is the column of the relation at position i */
+    using column_order = std::array<int, Arity>;
+
+    LVMDirectIndex(LexOrder order) {
+        for (size_t i = 0; i < Arity; ++i) {
+            if (std::find(order.begin(), order.end(), static_cast<int>(i)) == order.end()) {
+                order.push_back(i);
+            }
+        }
+        assert(order.size() == Arity && "invalid order of index");
+        for (size_t i = 0; i < Arity; ++i) {
+            columns[i] = order[i];
+            identity = identity && order[i] == static_cast<int>(i);
+        }
+    }
+
+    /** the column order of the permuted tuples */
+    const column_order& order() const {
+        return columns;
+    }
+
+    /** whether the permuted tuples follow the column order of the relation */
+    bool isIdentity() const {
+        return identity;
+    }
+
+    /** add tuple to the index, return true if it was not contained */
+    bool insert(const RamDomain* tuple) {
+        return set.insert(toEntry(tuple), hints.get());
+    }
+
+    /**
+     * add the tuples of an index of the same order, ignoring those contained, and return the number of
+     * tuples added
+     *
+     * Large indexes are merged with this index in linear time. Must not run concurrently with other
+     * operations on the index.
+     */
+    size_t insert(const LVMDirectIndex& other) {
+        assert(columns == other.columns);
+        size_t added = set.insertAll(other.set);
+        hints.invalidate();
+        return added;
+    }
+
+    /** check whether tuple exists in index */
+    bool exists(const RamDomain* tuple) {
+        return set.contains(toEntry(tuple), hints.get());
+    }
+
+    /** purge all tuples of index */
+    void purge() {
+        set.clear();
+        hints.invalidate();
+    }
+
+    /** purge all tuples of index, keeping the memory of the b-tree for reuse */
+    void reset() {
+        set.reset();
+        hints.invalidate();
+    }
+
+    /** number of tuples of index */
+    size_t size() const {
+        return set.size();
+    }
+
+    /** return start and end iterator of a range, the bounds are given in the column order of the relation */
+    inline std::pair<iterator, iterator> lowerUpperBound(const RamDomain* low, const RamDomain* high) {
+        operation_hints& threadHints = hints.get();
+        return std::pair<iterator, iterator>(
+                set.lower_bound(toEntry(low), threadHints), set.upper_bound(toEntry(high), threadHints));
+    }
+
+    inline iterator begin() const {
+        return set.begin();
+    }
+
+    inline iterator end() const {
+        return set.end();
+    }
+
+    /** partition the index into chunks of roughly equal size for parallel iteration */
+    std::vector<range<iterator>> partition() const {
+        return set.getChunks(400);
+    }
+
+private:
+    /** permute a tuple into the column order of the index */
+    tuple_type toEntry(const RamDomain* tuple) const {
+        tuple_type entry;
+        for (size_t i = 0; i < Arity; ++i) {
+            entry[i] = tuple[columns[i]];
+        }
+        return entry;
+    }
+
+    /** column order of the permuted tuples */
+    column_order columns;
+
+    /** whether the column order is the column order of the relation */
+    bool identity = true;
+
+    /** set storing the permuted tuples */
+    index_set set;
+
+    /** Operation hints of the threads using the index */
+    LVMThreadHints<operation_hints> hints;
 };
 
 }  // end of namespace souffle
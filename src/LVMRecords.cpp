@@ -15,9 +15,14 @@
  ***********************************************************************/
 
 #include "LVMRecords.h"
+#include "ParallelUtils.h"
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <limits>
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace souffle {
@@ -27,49 +32,88 @@ namespace {
 using namespace std;
 
 /**
- * A bidirectional mapping between tuples and reference indices.
+ * A bidirectional mapping between tuples of a fixed arity and reference indices.
+ *
+ * The mapping from tuples to indices is split into shards selected by the hash of the tuple, each guarded
+ * by its own lock. Tuples are stored in append-only blocks which are never moved, so that unpacking does not
+ * require any synchronisation.
  */
 class LVMRecordMap {
+    /** Number of tuples per block */
+    static const size_t BLOCK_SIZE = 1 << 16;
+
+    /** Maximal number of blocks, covering all positive indices */
+    static const size_t MAX_BLOCKS = (size_t(numeric_limits<RamDomain>::max()) + 1) / BLOCK_SIZE;
+
+    /** Number of shards of the mapping from tuples to indices, a power of two */
+    static const size_t SHARDS = 64;
+
+    /** Hash function of tuples */
+    struct TupleHash {
+        size_t operator()(const vector<RamDomain>& tuple) const {
+            size_t seed = tuple.size();
+            for (RamDomain value : tuple) {
+                seed ^= hash<RamDomain>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            }
+            return seed;
+        }
+    };
+
+    /** Shard of the mapping from tuples to indices */
+    struct Shard {
+        Lock access;
+        unordered_map<vector<RamDomain>, RamDomain, TupleHash> r2i;
+    };
+
     /** The arity of the stored tuples */
     int arity;
 
     /** The mapping from tuples to references/indices */
-    map<vector<RamDomain>, RamDomain> r2i;
+    array<Shard, SHARDS> shards;
 
-    /** The mapping from indices to tuples */
-    vector<vector<RamDomain>> i2r;
+    /** The mapping from indices to tuples, block i holds the tuples from index i * BLOCK_SIZE onwards */
+    unique_ptr<atomic<RamDomain*>[]> i2r;
+
+    /** The next free index, index 0 is left free for the Nil element */
+    atomic<RamDomain> next{1};
 
 public:
-    LVMRecordMap(int arity) : arity(arity), i2r(1) {}  // note: index 0 element left free
+    LVMRecordMap(int arity) : arity(arity), i2r(new atomic<RamDomain*>[MAX_BLOCKS]) {
+        for (size_t i = 0; i < MAX_BLOCKS; ++i) {
+            i2r[i].store(nullptr, memory_order_relaxed);
+        }
+    }
+
+    ~LVMRecordMap() {
+        for (size_t i = 0; i < MAX_BLOCKS; ++i) {
+            delete[] i2r[i].load(memory_order_relaxed);
+        }
+    }
 
     /**
      * Packs the given tuple -- and may create a new reference if necessary.
      */
     RamDomain pack(const RamDomain* tuple) {
-        vector<RamDomain> tmp(arity);
-        for (int i = 0; i < arity; i++) {
-            tmp[i] = tuple[i];
+        vector<RamDomain> tmp(tuple, tuple + arity);
+        Shard& shard = shards[TupleHash()(tmp) & (SHARDS - 1)];
+
+        auto lease = shard.access.acquire();
+        (void)lease;  // avoid warning;
+        auto pos = shard.r2i.find(tmp);
+        if (pos != shard.r2i.end()) {
+            return pos->second;
         }
 
-        RamDomain index;
-#pragma omp critical(record_pack)
-        {
-            auto pos = r2i.find(tmp);
-            if (pos != r2i.end()) {
-                index = pos->second;
-            } else {
-#pragma omp critical(record_unpack)
-                {
-                    i2r.push_back(tmp);
-                    index = i2r.size() - 1;
-                    r2i[tmp] = index;
-
-                    // assert that new index is smaller than the range
-                    assert(index != std::numeric_limits<RamDomain>::max());
-                }
-            }
-        }
+        RamDomain index = next.fetch_add(1, memory_order_relaxed);
+
+        // assert that new index is smaller than the range
+        assert(index != std::numeric_limits<RamDomain>::max());
 
+        RamDomain* record = getBlock(index / BLOCK_SIZE) + (index % BLOCK_SIZE) * arity;
+        for (int i = 0; i < arity; i++) {
+            record[i] = tuple[i];
+        }
+        shard.r2i.emplace(std::move(tmp), index);
         return index;
     }
 
@@ -77,31 +121,54 @@ public:
      * Obtains a pointer to the tuple addressed by the given index.
      */
     RamDomain* unpack(RamDomain index) {
-        RamDomain* res;
-
-#pragma omp critical(record_unpack)
-        res = &(i2r[index][0]);
+        return i2r[index / BLOCK_SIZE].load(memory_order_acquire) + (index % BLOCK_SIZE) * arity;
+    }
 
-        return res;
+private:
+    /** Obtain a block of tuples, allocating it if necessary */
+    RamDomain* getBlock(size_t blockIndex) {
+        RamDomain* block = i2r[blockIndex].load(memory_order_acquire);
+        if (block != nullptr) {
+            return block;
+        }
+        // zero-arity records still obtain a block to mark the index as used
+        RamDomain* newBlock = new RamDomain[BLOCK_SIZE * max(arity, 1)];
+        if (i2r[blockIndex].compare_exchange_strong(block, newBlock, memory_order_acq_rel)) {
+            return newBlock;
+        }
+        // another thread allocated the block first
+        delete[] newBlock;
+        return block;
     }
 };
 
-/**
- * The static access function for record maps of certain arities.
- */
+/** Number of arities whose record maps can be found without synchronisation */
+const int MAX_FAST_ARITY = 64;
+
 LVMRecordMap& getForArity(int arity) {
-    // the static container -- filled on demand
-    static map<int, LVMRecordMap> maps;
+    // the static containers -- filled on demand
+    static array<atomic<LVMRecordMap*>, MAX_FAST_ARITY> fastMaps{};
+    static map<int, unique_ptr<LVMRecordMap>> maps;
+    static Lock mapsLock;
+
+    if (arity < MAX_FAST_ARITY) {
+        LVMRecordMap* res = fastMaps[arity].load(memory_order_acquire);
+        if (res != nullptr) {
+            return *res;
+        }
+    }
 
-    // get container if present
+    // get container if present, create new container if required
+    auto lease = mapsLock.acquire();
+    (void)lease;  // avoid warning;
     auto pos = maps.find(arity);
-    if (pos != maps.end()) {
-        return pos->second;
+    if (pos == maps.end()) {
+        pos = maps.emplace(arity, unique_ptr<LVMRecordMap>(new LVMRecordMap(arity))).first;
+        if (arity < MAX_FAST_ARITY) {
+            fastMaps[arity].store(pos->second.get(), memory_order_release);
+        }
     }
-
-    // create new container if required
-    maps.emplace(arity, arity);
-    return getForArity(arity);
+    return *pos->second;
 }
 }  // namespace
 
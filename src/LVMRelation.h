@@ -16,12 +16,19 @@
 
 #pragma once
 
+#include "Brie.h"
+#include "CompressedSet.h"
+#include "EquivalenceRelation.h"
+#include "HashIndex.h"
 #include "LVMIndex.h"
 #include "ParallelUtils.h"
 #include "RamIndexAnalysis.h"
 #include "RamTypes.h"
 
-#include <deque>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <utility>
@@ -29,11 +36,175 @@
 
 namespace souffle {
 
+/**
+ * Iterator over the tuples of a relation which is not stored in indirect B-tree indexes
+ */
+class LVMIteratorBase {
+public:
+    virtual ~LVMIteratorBase() = default;
+
+    /** Move to the next tuple */
+    virtual void next() = 0;
+
+    /** Return the current tuple, valid until the iterator is moved */
+    virtual const RamDomain* get() const = 0;
+
+    /** Check equivalence with an iterator of the same relation */
+    virtual bool equal(const LVMIteratorBase& other) const = 0;
+
+    /** Clone iterator */
+    virtual LVMIteratorBase* clone() const = 0;
+};
+
+/**
+ * Iterator over the tuples of an LVM relation
+ *
+ * Iterators of indirect B-tree indexes of the default node size are held directly so that they do not pay
+ * for a virtual call, iterators of other representations are held behind LVMIteratorBase.
+ */
+class LVMIterator : public std::iterator<std::forward_iterator_tag, const RamDomain*> {
+public:
+    LVMIterator() = default;
+
+    LVMIterator(LVMIndex<>::iterator it) : indexIter(std::move(it)) {}
+
+    explicit LVMIterator(LVMIteratorBase* it) : iter(it) {}
+
+    LVMIterator(const LVMIterator& other)
+            : indexIter(other.indexIter), iter(other.iter ? other.iter->clone() : nullptr) {}
+
+    LVMIterator(LVMIterator&& other) = default;
+
+    LVMIterator& operator=(const LVMIterator& other) {
+        indexIter = other.indexIter;
+        iter.reset(other.iter ? other.iter->clone() : nullptr);
+        return *this;
+    }
+
+    LVMIterator& operator=(LVMIterator&& other) = default;
+
+    const RamDomain* operator*() const {
+        return iter ? iter->get() : *indexIter;
+    }
+
+    LVMIterator& operator++() {
+        if (iter) {
+            iter->next();
+        } else {
+            ++indexIter;
+        }
+        return *this;
+    }
+
+    bool operator==(const LVMIterator& other) const {
+        if (iter || other.iter) {
+            return iter && other.iter && iter->equal(*other.iter);
+        }
+        return indexIter == other.indexIter;
+    }
+
+    bool operator!=(const LVMIterator& other) const {
+        return !(*this == other);
+    }
+
+private:
+    /** Iterator of a B-tree index */
+    LVMIndex<>::iterator indexIter;
+
+    /** Iterator of any other representation, null for B-tree indexes */
+    std::unique_ptr<LVMIteratorBase> iter;
+};
+
+/**
+ * Adapter turning an iterator over tuples of a data structure into an LVMIteratorBase.
+ * Tuples stored with a column order different from the relation are permuted back on access.
+ */
+template <typename Iter, size_t Arity>
+class LVMPermutedIterator : public LVMIteratorBase {
+public:
+    /** Create an iterator, order[i] is the column of the relation stored at position i */
+    LVMPermutedIterator(Iter it, const std::array<int, Arity>& order, bool identity)
+            : it(std::move(it)), order(order), identity(identity) {}
+
+    void next() override {
+        ++it;
+    }
+
+    const RamDomain* get() const override {
+        const auto& entry = *it;
+        if (identity) {
+            return entry.data;
+        }
+        for (size_t i = 0; i < Arity; ++i) {
+            tuple[order[i]] = entry[i];
+        }
+        return tuple.data();
+    }
+
+    bool equal(const LVMIteratorBase& other) const override {
+        return it == static_cast<const LVMPermutedIterator&>(other).it;
+    }
+
+    LVMIteratorBase* clone() const override {
+        return new LVMPermutedIterator(*this);
+    }
+
+private:
+    Iter it;
+
+    /** Column order of the stored tuples */
+    const std::array<int, Arity> order;
+
+    /** Whether the stored tuples follow the column order of the relation */
+    const bool identity;
+
+    /** Buffer of the current tuple in the column order of the relation */
+    mutable std::array<RamDomain, Arity> tuple;
+};
+
+/**
+ * Adapter turning an iterator of a B-tree index with a non-default node size into an LVMIteratorBase.
+ */
+template <typename Iter>
+class LVMIndexIterator : public LVMIteratorBase {
+public:
+    LVMIndexIterator(Iter it) : it(std::move(it)) {}
+
+    void next() override {
+        ++it;
+    }
+
+    const RamDomain* get() const override {
+        return *it;
+    }
+
+    bool equal(const LVMIteratorBase& other) const override {
+        return it == static_cast<const LVMIndexIterator&>(other).it;
+    }
+
+    LVMIteratorBase* clone() const override {
+        return new LVMIndexIterator(*this);
+    }
+
+private:
+    Iter it;
+};
+
+/** Turn an iterator of a B-tree index into an LVMIterator, held directly for the default node size */
+inline LVMIterator makeIndexIterator(const LVMIndex<>::iterator& it) {
+    return LVMIterator(it);
+}
+
+template <typename Iter>
+LVMIterator makeIndexIterator(const Iter& it) {
+    return LVMIterator(new LVMIndexIterator<Iter>(it));
+}
+
 class LVMRelation {
     using LexOrder = std::vector<int>;
 
 public:
-    using iterator = LVMIndex::iterator;
+    using iterator = LVMIterator;
 
     LVMRelation(size_t relArity, const MinIndexSelection* orderSet, std::string& relName,
             std::vector<std::string>& attributeTypes)
@@ -88,6 +259,11 @@ public:
     /** Purge table */
     virtual void purge() = 0;
 
+    /** Purge table, keeping allocated memory for refilling it */
+    virtual void reset() {
+        purge();
+    }
+
     /** check whether a tuple exists in the relation */
     virtual bool exists(const RamDomain* tuple) const = 0;
 
@@ -96,6 +272,9 @@ public:
 
     virtual iterator end() const = 0;
 
+    /** Partition the relation for parallel iteration, uses full-order index as default */
+    virtual std::vector<range<iterator>> partition() const = 0;
+
     /** Return range iterator */
     virtual std::pair<iterator, iterator> lowerUpperBound(
             const RamDomain* low, const RamDomain* high, size_t indexPosition) const = 0;
@@ -114,7 +293,7 @@ protected:
     const size_t arity;
 
     /** Number of tuples in relation */
-    size_t num_tuples = 0;
+    std::atomic<size_t> num_tuples{0};
 
     /** IndexSet */
     const MinIndexSelection* orderSet;
@@ -127,19 +306,42 @@ protected:
 };
 
 /**
- * Interpreter Relation
+ * Interpreter Indirect Relation
+ *
+ * Tuples are stored in blocks and indexed by b-trees of tuple pointers whose nodes have NodeSize bytes.
+ * Relations whose arity exceeds the supported arities of direct relations are stored this way.
  */
+template <unsigned NodeSize = 512>
 class LVMIndirectRelation : public LVMRelation {
+    using index_type = LVMIndex<NodeSize>;
+
 public:
     LVMIndirectRelation(size_t relArity, const MinIndexSelection* orderSet, std::string& relName,
             std::vector<std::string>& attributeTypes)
             : LVMRelation(relArity, orderSet, relName, attributeTypes) {
-        for (auto& order : orderSet->getAllOrders()) {
-            indices.push_back(LVMIndex(order));
+        for (auto order : orderSet->getAllOrders()) {
+            // the remaining columns complete the order of the index, which thereby holds each tuple once
+            for (size_t i = 0; i < relArity; ++i) {
+                if (std::find(order.begin(), order.end(), static_cast<int>(i)) == order.end()) {
+                    order.push_back(i);
+                }
+            }
+            indices.push_back(index_type(order));
         }
     }
 
-    /** Insert tuple */
+    ~LVMIndirectRelation() override {
+        for (auto& cur : blocks) {
+            delete[] cur.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Insert tuple, safe for concurrent insertions
+     *
+     * The first index decides which of concurrent insertions of the same tuple succeeds; the storage slots
+     * of the others remain unused.
+     */
     void insert(const RamDomain* tuple) override {
         assert(tuple);
 
@@ -148,64 +350,97 @@ public:
             return;
         }
 
-        int blockIndex = num_tuples / (BLOCK_SIZE / arity);
-        int tupleIndex = (num_tuples % (BLOCK_SIZE / arity)) * arity;
-
-        if (tupleIndex == 0) {
-            blockList.push_back(std::make_unique<RamDomain[]>(BLOCK_SIZE));
+        const RamDomain* newTuple = store(tuple);
+        if (!indices[0].insert(newTuple)) {
+            return;
         }
 
-        RamDomain* newTuple = &blockList[blockIndex][tupleIndex];
-        for (size_t i = 0; i < arity; ++i) {
-            newTuple[i] = tuple[i];
+        // update the other indexes with new tuple
+        for (size_t i = 1; i < indices.size(); ++i) {
+            indices[i].insert(newTuple);
         }
-
-        // update all indexes with new tuple
-        for (auto& cur : indices) {
-            cur.insert(newTuple);
-        }
-
-        // increment relation size
         num_tuples++;
     }
 
     /** Merge another relation into this relation */
     void insert(const LVMRelation& other) override {
         assert(getArity() == other.getArity());
-        for (const auto& cur : other) {
-            insert(cur);
+
+        // collect the new tuples of each partition in parallel; iterators of other
+        // representations may reuse their buffer, so the tuples are copied
+        auto chunks = other.partition();
+        std::vector<std::vector<RamDomain>> fresh(chunks.size());
+#pragma omp parallel for schedule(dynamic)
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            for (const RamDomain* cur : chunks[i]) {
+                if (!exists(cur)) {
+                    fresh[i].insert(fresh[i].end(), cur, cur + arity);
+                }
+            }
         }
+
+        // store them, then add them to each index as a whole
+        std::vector<const RamDomain*> added;
+        for (const auto& chunk : fresh) {
+            for (size_t pos = 0; pos < chunk.size(); pos += arity) {
+                added.push_back(store(&chunk[pos]));
+            }
+        }
+        for (auto& cur : indices) {
+            cur.insert(added.begin(), added.end());
+        }
+        num_tuples += added.size();
     }
 
     /** Purge table */
     void purge() override {
-        blockList.clear();
+        for (auto& cur : blocks) {
+            delete[] cur.exchange(nullptr, std::memory_order_relaxed);
+        }
+        numSlots = 0;
         for (auto& cur : indices) {
             cur.purge();
         }
         num_tuples = 0;
     }
 
-    /** check whether a tuple exists in the relation */
+    /** Purge table, keeping the tuple storage and the memory of the indexes for refilling it */
+    void reset() override {
+        numSlots = 0;
+        for (auto& cur : indices) {
+            cur.reset();
+        }
+        num_tuples = 0;
+    }
+
+    /** check whether a tuple exists in the relation, every index orders complete tuples */
     bool exists(const RamDomain* tuple) const override {
-        LVMIndex* index = getIndex(getTotalIndexKey());
-        return index->exists(tuple);
+        return indices[0].exists(tuple);
     }
 
     /** Iterator for relation, uses full-order index as default */
     iterator begin() const override {
-        return indices[0].begin();
+        return makeIndexIterator(indices[0].begin());
     }
 
     iterator end() const override {
-        return indices[0].end();
+        return makeIndexIterator(indices[0].end());
+    }
+
+    /** Partition the relation for parallel iteration, uses full-order index as default */
+    std::vector<range<iterator>> partition() const override {
+        std::vector<range<iterator>> res;
+        for (const auto& chunk : indices[0].partition()) {
+            res.push_back(range<iterator>(makeIndexIterator(chunk.begin()), makeIndexIterator(chunk.end())));
+        }
+        return res;
     }
 
     /** Return range iterator */
     std::pair<iterator, iterator> lowerUpperBound(
             const RamDomain* low, const RamDomain* high, size_t indexPosition) const override {
-        auto idx = this->getIndexByPos(indexPosition);
-        return idx->lowerUpperBound(low, high);
+        auto bounds = this->getIndexByPos(indexPosition)->lowerUpperBound(low, high);
+        return std::make_pair(makeIndexIterator(bounds.first), makeIndexIterator(bounds.second));
     }
 
     /** Extend tuple */
@@ -222,7 +457,7 @@ public:
     void extend(const LVMRelation& rel) override {}
 
     /** get index for a given search signature. Order are encoded as bits for each column */
-    LVMIndex* getIndex(const SearchSignature& col) const {
+    index_type* getIndex(const SearchSignature& col) const {
         // Special case in provenance program, a 0 searchSignature is considered as a full search
         if (col == 0) {
             return getIndex(getTotalIndexKey());
@@ -231,7 +466,7 @@ public:
     }
 
     /** get index for a given order. Order are encoded as bits for each column */
-    LVMIndex* getIndexByPos(int idx) const {
+    index_type* getIndexByPos(int idx) const {
         return &indices[idx];
     }
 
@@ -241,15 +476,293 @@ public:
     }
 
 private:
-    /** Size of blocks containing tuples */
-    static const int BLOCK_SIZE = 1024;
+    /**
+     * Copy a tuple into the tuple storage without indexing it, safe for concurrent calls
+     *
+     * Each call claims the next slot of the storage. Block b of the storage holds FIRST_BLOCK_SIZE << b
+     * tuples and is allocated by the first call claiming one of its slots; blocks never move, so the
+     * stored tuples stay in place.
+     */
+    const RamDomain* store(const RamDomain* tuple) {
+        const size_t slot = numSlots.fetch_add(1, std::memory_order_relaxed) + FIRST_BLOCK_SIZE;
+        const size_t block = (63 - __builtin_clzll(slot)) - FIRST_BLOCK_BITS;
+        const size_t offset = slot - (FIRST_BLOCK_SIZE << block);
+
+        RamDomain* cur = blocks[block].load(std::memory_order_acquire);
+        if (cur == nullptr) {
+            RamDomain* fresh = new RamDomain[(FIRST_BLOCK_SIZE << block) * arity];
+            if (blocks[block].compare_exchange_strong(cur, fresh, std::memory_order_acq_rel)) {
+                cur = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
 
-    std::deque<std::unique_ptr<RamDomain[]>> blockList;
+        RamDomain* newTuple = &cur[offset * arity];
+        std::copy(tuple, tuple + arity, newTuple);
+        return newTuple;
+    }
+
+    /** Number of tuples of the first block of the tuple storage, as a power of two */
+    static constexpr size_t FIRST_BLOCK_BITS = 10;
+    static constexpr size_t FIRST_BLOCK_SIZE = size_t(1) << FIRST_BLOCK_BITS;
+
+    /** Blocks of the tuple storage, doubling in size */
+    std::array<std::atomic<RamDomain*>, 64 - FIRST_BLOCK_BITS> blocks{};
+
+    /** Number of claimed slots of the tuple storage */
+    std::atomic<size_t> numSlots{0};
 
     /** List of indices */
-    mutable std::vector<LVMIndex> indices;
+    mutable std::vector<index_type> indices;
 };
 
+/**
+ * Interpreter Direct Relation
+ *
+ * Tuples of a fixed arity are stored inline in one b-tree per index, with the columns permuted into the
+ * lexicographical order of the index. The nodes of the b-trees have NodeSize bytes. The hot searches of
+ * the index selection are additionally served by hash indexes keyed by their columns.
+ */
+template <size_t Arity, unsigned NodeSize = 512>
+class LVMDirectRelation : public LVMRelation {
+    using index_type = LVMDirectIndex<Arity, NodeSize>;
+    using index_iterator = LVMPermutedIterator<typename index_type::iterator, Arity>;
+    using hash_index_type = HashIndex<Arity>;
+    using hash_entry_type = typename hash_index_type::entry_type;
+    using hash_iterator = LVMPermutedIterator<typename hash_index_type::iterator, Arity>;
+
+public:
+    LVMDirectRelation(const MinIndexSelection* orderSet, std::string& relName,
+            std::vector<std::string>& attributeTypes)
+            : LVMRelation(Arity, orderSet, relName, attributeTypes) {
+        for (auto& order : orderSet->getAllOrders()) {
+            indices.push_back(std::make_unique<index_type>(order));
+        }
+        for (auto search : orderSet->getHashSearches()) {
+            hashSignatures.push_back(search);
+            hashIndices.push_back(std::make_unique<hash_index_type>(search));
+        }
+        for (size_t i = 0; i < Arity; ++i) {
+            identityOrder[i] = i;
+        }
+    }
+
+    /** Insert tuple, safe for concurrent insertions as the first index decides whether it is new */
+    void insert(const RamDomain* tuple) override {
+        if (indices[0]->insert(tuple)) {
+            for (size_t i = 1; i < indices.size(); ++i) {
+                indices[i]->insert(tuple);
+            }
+            if (!hashIndices.empty()) {
+                const hash_entry_type entry = toHashEntry(tuple);
+                for (auto& cur : hashIndices) {
+                    cur->insert(entry);
+                }
+            }
+            num_tuples++;
+        }
+    }
+
+    /** Merge another relation into this relation */
+    void insert(const LVMRelation& other) override {
+        assert(getArity() == other.getArity());
+
+        // indexes of the same order are merged as a whole, each of them ignores the tuples it contains;
+        // hash indexes must only receive new tuples, hence they require tuple-wise insertions
+        auto* direct = dynamic_cast<const LVMDirectRelation*>(&other);
+        if (direct != nullptr && direct->getOrders() == getOrders() && hashIndices.empty()) {
+            num_tuples += indices[0]->insert(*direct->indices[0]);
+            for (size_t i = 1; i < indices.size(); ++i) {
+                indices[i]->insert(*direct->indices[i]);
+            }
+            return;
+        }
+
+        for (const auto& cur : other) {
+            insert(cur);
+        }
+    }
+
+    /** Purge table */
+    void purge() override {
+        for (auto& cur : indices) {
+            cur->purge();
+        }
+        for (auto& cur : hashIndices) {
+            cur->clear();
+        }
+        num_tuples = 0;
+    }
+
+    /** Purge table, keeping the memory of the indexes for refilling it */
+    void reset() override {
+        for (auto& cur : indices) {
+            cur->reset();
+        }
+        for (auto& cur : hashIndices) {
+            cur->reset();
+        }
+        num_tuples = 0;
+    }
+
+    /** check whether a tuple exists in the relation, every index holds complete tuples */
+    bool exists(const RamDomain* tuple) const override {
+        return indices[0]->exists(tuple);
+    }
+
+    /** Iterator for relation, uses the first index as default */
+    iterator begin() const override {
+        return makeIterator(indices[0]->begin(), 0);
+    }
+
+    iterator end() const override {
+        return makeIterator(indices[0]->end(), 0);
+    }
+
+    /** Partition the relation for parallel iteration, uses the first index as default */
+    std::vector<range<iterator>> partition() const override {
+        std::vector<range<iterator>> res;
+        for (const auto& chunk : indices[0]->partition()) {
+            res.push_back(range<iterator>(makeIterator(chunk.begin(), 0), makeIterator(chunk.end(), 0)));
+        }
+        return res;
+    }
+
+    /** Return range iterator, searches binding the columns of a hash index are answered by it */
+    std::pair<iterator, iterator> lowerUpperBound(
+            const RamDomain* low, const RamDomain* high, size_t indexPosition) const override {
+        if (!hashIndices.empty()) {
+            SearchSignature search = 0;
+            for (size_t i = 0; i < Arity; ++i) {
+                if (low[i] == high[i]) {
+                    search |= SearchSignature(1) << i;
+                }
+            }
+            auto pos = std::find(hashSignatures.begin(), hashSignatures.end(), search);
+            if (pos != hashSignatures.end()) {
+                auto bounds = hashIndices[pos - hashSignatures.begin()]->equalRange(toHashEntry(low));
+                return std::make_pair(makeHashIterator(bounds.begin()), makeHashIterator(bounds.end()));
+            }
+        }
+        auto bounds = indices[indexPosition]->lowerUpperBound(low, high);
+        return std::make_pair(
+                makeIterator(bounds.first, indexPosition), makeIterator(bounds.second, indexPosition));
+    }
+
+    /** Extend tuple */
+    std::vector<RamDomain*> extend(const RamDomain* tuple) override {
+        std::vector<RamDomain*> newTuples;
+
+        // A standard relation does not generate extra new knowledge on insertion.
+        newTuples.push_back(new RamDomain[2]{tuple[0], tuple[1]});
+
+        return newTuples;
+    }
+
+    /** Extend relation */
+    void extend(const LVMRelation& rel) override {}
+
+private:
+    /** Column orders of the indexes */
+    std::vector<typename index_type::column_order> getOrders() const {
+        std::vector<typename index_type::column_order> res;
+        for (const auto& cur : indices) {
+            res.push_back(cur->order());
+        }
+        return res;
+    }
+
+    /** Wrap an iterator of the index at the given position */
+    iterator makeIterator(const typename index_type::iterator& it, size_t indexPosition) const {
+        const index_type& index = *indices[indexPosition];
+        return iterator(new index_iterator(it, index.order(), index.isIdentity()));
+    }
+
+    /** Copy a tuple into an entry of the hash indexes */
+    static hash_entry_type toHashEntry(const RamDomain* tuple) {
+        hash_entry_type entry;
+        std::copy(tuple, tuple + Arity, entry.data);
+        return entry;
+    }
+
+    /** Wrap an iterator of a hash index */
+    iterator makeHashIterator(const typename hash_index_type::iterator& it) const {
+        return iterator(new hash_iterator(it, identityOrder, true));
+    }
+
+    /** List of indices */
+    std::vector<std::unique_ptr<index_type>> indices;
+
+    /** The columns bound by the hot searches served by the hash indexes */
+    std::vector<SearchSignature> hashSignatures;
+
+    /** One hash index per hot search */
+    std::vector<std::unique_ptr<hash_index_type>> hashIndices;
+
+    /** The identity order of the tuples of the hash indexes */
+    std::array<int, Arity> identityOrder;
+};
+
+/**
+ * Create a direct relation whose indexes use nodes of NodeSize bytes, return nullptr if its arity
+ * exceeds the supported arities of direct relations
+ */
+template <unsigned NodeSize>
+std::unique_ptr<LVMRelation> createDirectRelation(size_t arity, const MinIndexSelection* orderSet,
+        std::string& relName, std::vector<std::string>& attributeTypes) {
+    switch (arity) {
+        case 1:
+            return std::make_unique<LVMDirectRelation<1, NodeSize>>(orderSet, relName, attributeTypes);
+        case 2:
+            return std::make_unique<LVMDirectRelation<2, NodeSize>>(orderSet, relName, attributeTypes);
+        case 3:
+            return std::make_unique<LVMDirectRelation<3, NodeSize>>(orderSet, relName, attributeTypes);
+        case 4:
+            return std::make_unique<LVMDirectRelation<4, NodeSize>>(orderSet, relName, attributeTypes);
+        case 5:
+            return std::make_unique<LVMDirectRelation<5, NodeSize>>(orderSet, relName, attributeTypes);
+        case 6:
+            return std::make_unique<LVMDirectRelation<6, NodeSize>>(orderSet, relName, attributeTypes);
+        case 7:
+            return std::make_unique<LVMDirectRelation<7, NodeSize>>(orderSet, relName, attributeTypes);
+        case 8:
+            return std::make_unique<LVMDirectRelation<8, NodeSize>>(orderSet, relName, attributeTypes);
+        default:
+            return nullptr;
+    }
+}
+
+/** Create a b-tree relation of the given node size, relations of large arities store tuple pointers */
+template <unsigned NodeSize>
+std::unique_ptr<LVMRelation> createBTreeRelation(size_t arity, const MinIndexSelection* orderSet,
+        std::string& relName, std::vector<std::string>& attributeTypes) {
+    auto res = createDirectRelation<NodeSize>(arity, orderSet, relName, attributeTypes);
+    if (res == nullptr) {
+        res = std::make_unique<LVMIndirectRelation<NodeSize>>(arity, orderSet, relName, attributeTypes);
+    }
+    return res;
+}
+
+/** Create a b-tree relation whose indexes use nodes of the given number of bytes, 0 for the default size */
+inline std::unique_ptr<LVMRelation> createBTreeRelation(size_t nodeSize, size_t arity,
+        const MinIndexSelection* orderSet, std::string& relName, std::vector<std::string>& attributeTypes) {
+    switch (nodeSize) {
+        case 128:
+            return createBTreeRelation<128>(arity, orderSet, relName, attributeTypes);
+        case 256:
+            return createBTreeRelation<256>(arity, orderSet, relName, attributeTypes);
+        case 1024:
+            return createBTreeRelation<1024>(arity, orderSet, relName, attributeTypes);
+        case 2048:
+            return createBTreeRelation<2048>(arity, orderSet, relName, attributeTypes);
+        case 4096:
+            return createBTreeRelation<4096>(arity, orderSet, relName, attributeTypes);
+        default:
+            return createBTreeRelation<512>(arity, orderSet, relName, attributeTypes);
+    }
+}
+
 /**
  * Interpreter Nullary relation
  */
@@ -259,12 +772,11 @@ public:
     LVMNullaryRelation(std::string relName, std::vector<std::string>& attributeTypes)
             : LVMRelation(0, nullptr, relName, attributeTypes), nullaryIndex(std::vector<int>()) {}
 
-    /** Insert tuple into nullary relation */
+    /** Insert tuple into nullary relation, the empty order of the index admits a single tuple */
     void insert(const RamDomain* tuple) override {
-        if (!inserted) {
-            nullaryIndex.insert(tuple);
+        if (!inserted && nullaryIndex.insert(tuple)) {
+            inserted = true;
         }
-        inserted = true;
     }
 
     /** Merge another relation into this relation */
@@ -285,6 +797,7 @@ public:
 
     /** Purge table */
     void purge() override {
+        nullaryIndex.purge();
         inserted = false;
     }
 
@@ -302,6 +815,11 @@ public:
         return nullaryIndex.end();
     }
 
+    /** Partition the relation for parallel iteration, a nullary relation forms a single chunk */
+    std::vector<range<iterator>> partition() const override {
+        return {range<iterator>(begin(), end())};
+    }
+
     /** Return range iterator */
     std::pair<iterator, iterator> lowerUpperBound(
             const RamDomain* low, const RamDomain* high, size_t indexPosition) const override {
@@ -323,85 +841,530 @@ public:
 
 private:
     /** Nullary can hold only one tuple */
-    bool inserted = false;
+    std::atomic<bool> inserted{false};
 
     /** Nullary index with empty search signature */
-    LVMIndex nullaryIndex;
+    LVMIndex<> nullaryIndex;
 };
 
 /**
- * Interpreter Equivalence Relation
+ * Interpreter Brie Relation
+ *
+ * Tuples are stored in one trie per index, with the columns permuted into the lexicographical order of
+ * the index so that the bound columns of every search form a prefix. Any set offering the interface of
+ * a trie may replace it, e.g. a CompressedSet for compressed relations.
  */
+template <size_t Arity, typename Set = Trie<Arity>>
+class LVMBrieRelation : public LVMRelation {
+    using trie_type = Set;
+    using entry_type = typename trie_type::entry_type;
+    using trie_iterator = LVMPermutedIterator<typename trie_type::iterator, Arity>;
 
-class LVMEqRelation : public LVMIndirectRelation {
 public:
-    LVMEqRelation(size_t relArity, const MinIndexSelection* orderSet, std::string relName,
+    LVMBrieRelation(const MinIndexSelection* orderSet, std::string& relName,
             std::vector<std::string>& attributeTypes)
-            : LVMIndirectRelation(relArity, orderSet, relName, attributeTypes) {}
+            : LVMRelation(Arity, orderSet, relName, attributeTypes) {
+        for (auto order : orderSet->getAllOrders()) {
+            // a trie stores full tuples, so the remaining columns complete the order of the index
+            for (size_t i = 0; i < Arity; ++i) {
+                if (std::find(order.begin(), order.end(), static_cast<int>(i)) == order.end()) {
+                    order.push_back(i);
+                }
+            }
+            std::array<int, Arity> columns;
+            bool identity = true;
+            for (size_t i = 0; i < Arity; ++i) {
+                columns[i] = order[i];
+                identity = identity && order[i] == static_cast<int>(i);
+            }
+            orders.push_back(columns);
+            identities.push_back(identity);
+            tries.push_back(std::make_unique<trie_type>());
+        }
+    }
 
-    /** Insert tuple */
+    /** Insert tuple, safe for concurrent insertions as the first trie decides whether it is new */
     void insert(const RamDomain* tuple) override {
-        // TODO: (pnappa) an eqrel check here is all that appears to be needed for implicit additions
-        // TODO: future optimisation would require this as a member datatype
-        // brave soul required to pass this quest
-        // // specialisation for eqrel defs
-        // std::unique_ptr<binaryrelation> eqreltuples;
-        // in addition, it requires insert functions to insert into that, and functions
-        // which allow reading of stored values must be changed to accommodate.
-        // e.g. insert =>  eqRelTuples->insert(tuple[0], tuple[1]);
+        if (tries[0]->insert(toEntry(tuple, 0))) {
+            for (size_t i = 1; i < tries.size(); ++i) {
+                tries[i]->insert(toEntry(tuple, i));
+            }
+            num_tuples++;
+        }
+    }
+
+    /** Merge another relation into this relation */
+    void insert(const LVMRelation& other) override {
+        assert(getArity() == other.getArity());
+
+        // tries of the same layout are merged as a whole
+        auto* brie = dynamic_cast<const LVMBrieRelation*>(&other);
+        if (brie != nullptr && brie->orders == orders) {
+            // tries do not count their tuples, hence the new ones are counted by lookups before merging
+            size_t added = 0;
+            auto chunks = brie->tries[0]->partition(400);
+#pragma omp parallel for schedule(dynamic) reduction(+ : added)
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                typename trie_type::op_context ctxt;
+                for (const auto& cur : chunks[i]) {
+                    added += !tries[0]->contains(cur, ctxt);
+                }
+            }
+            for (size_t i = 0; i < tries.size(); ++i) {
+                tries[i]->insertAll(*brie->tries[i]);
+            }
+            num_tuples += added;
+            return;
+        }
 
-        // for now, we just have a naive & extremely slow version, otherwise known as a O(n^2) insertion
-        // ):
+        for (const auto& cur : other) {
+            insert(cur);
+        }
+    }
+
+    /** Purge table */
+    void purge() override {
+        for (auto& cur : tries) {
+            cur->clear();
+        }
+        num_tuples = 0;
+    }
 
-        for (auto* newTuple : extend(tuple)) {
-            LVMIndirectRelation::insert(newTuple);
-            delete[] newTuple;
+    /** Purge table, keeping the memory of the tries for refilling it */
+    void reset() override {
+        for (auto& cur : tries) {
+            cur->reset();
         }
+        num_tuples = 0;
     }
 
-    /** Find the new knowledge generated by inserting a tuple */
+    /** check whether a tuple exists in the relation */
+    bool exists(const RamDomain* tuple) const override {
+        return tries[0]->contains(toEntry(tuple, 0));
+    }
+
+    /** Iterator for relation, uses the first trie as default */
+    iterator begin() const override {
+        return makeIterator(tries[0]->begin(), 0);
+    }
+
+    iterator end() const override {
+        return makeIterator(tries[0]->end(), 0);
+    }
+
+    /** Partition the relation for parallel iteration, uses the first trie as default */
+    std::vector<range<iterator>> partition() const override {
+        std::vector<range<iterator>> res;
+        for (const auto& chunk : tries[0]->partition(400)) {
+            res.push_back(range<iterator>(makeIterator(chunk.begin(), 0), makeIterator(chunk.end(), 0)));
+        }
+        return res;
+    }
+
+    /** Return range iterator, the bound columns of the search must form a prefix of the index */
+    std::pair<iterator, iterator> lowerUpperBound(
+            const RamDomain* low, const RamDomain* high, size_t indexPosition) const override {
+        const auto& order = orders[indexPosition];
+        unsigned levels = 0;
+        while (levels < Arity && low[order[levels]] == high[order[levels]]) {
+            levels++;
+        }
+        auto bounds =
+                PrefixQuery<0>::getBoundaries(*tries[indexPosition], toEntry(low, indexPosition), levels);
+        return std::make_pair(
+                makeIterator(bounds.begin(), indexPosition), makeIterator(bounds.end(), indexPosition));
+    }
+
+    /** Extend tuple */
     std::vector<RamDomain*> extend(const RamDomain* tuple) override {
         std::vector<RamDomain*> newTuples;
 
-        newTuples.push_back(new RamDomain[2]{tuple[0], tuple[0]});
+        // A standard relation does not generate extra new knowledge on insertion.
         newTuples.push_back(new RamDomain[2]{tuple[0], tuple[1]});
-        newTuples.push_back(new RamDomain[2]{tuple[1], tuple[0]});
-        newTuples.push_back(new RamDomain[2]{tuple[1], tuple[1]});
 
-        std::vector<const RamDomain*> relevantStored;
-        for (const RamDomain* vals : *this) {
-            if (vals[0] == tuple[0] || vals[0] == tuple[1] || vals[1] == tuple[0] || vals[1] == tuple[1]) {
-                relevantStored.push_back(vals);
+        return newTuples;
+    }
+
+    /** Extend relation */
+    void extend(const LVMRelation& rel) override {}
+
+private:
+    /** Prefix query of a trie whose prefix length is only known at runtime */
+    template <unsigned Levels, bool Last = (Levels == Arity)>
+    struct PrefixQuery {
+        static range<typename trie_type::iterator> getBoundaries(
+                const trie_type& trie, const entry_type& entry, unsigned levels) {
+            if (levels == Levels) {
+                return trie.template getBoundaries<Levels>(entry);
             }
+            return PrefixQuery<Levels + 1>::getBoundaries(trie, entry, levels);
         }
+    };
 
-        for (const auto vals : relevantStored) {
-            newTuples.push_back(new RamDomain[2]{vals[0], tuple[0]});
-            newTuples.push_back(new RamDomain[2]{vals[0], tuple[1]});
-            newTuples.push_back(new RamDomain[2]{vals[1], tuple[0]});
-            newTuples.push_back(new RamDomain[2]{vals[1], tuple[1]});
-            newTuples.push_back(new RamDomain[2]{tuple[0], vals[0]});
-            newTuples.push_back(new RamDomain[2]{tuple[0], vals[1]});
-            newTuples.push_back(new RamDomain[2]{tuple[1], vals[0]});
-            newTuples.push_back(new RamDomain[2]{tuple[1], vals[1]});
+    template <unsigned Levels>
+    struct PrefixQuery<Levels, true> {
+        static range<typename trie_type::iterator> getBoundaries(
+                const trie_type& trie, const entry_type& entry, unsigned levels) {
+            return trie.template getBoundaries<Levels>(entry);
+        }
+    };
+
+    /** Convert a tuple into an entry of the trie at the given index position */
+    entry_type toEntry(const RamDomain* tuple, size_t indexPosition) const {
+        entry_type entry;
+        const auto& order = orders[indexPosition];
+        for (size_t i = 0; i < Arity; ++i) {
+            entry[i] = tuple[order[i]];
         }
+        return entry;
+    }
 
-        return newTuples;
+    /** Wrap an iterator of the trie at the given index position */
+    iterator makeIterator(const typename trie_type::iterator& it, size_t indexPosition) const {
+        return iterator(new trie_iterator(it, orders[indexPosition], identities[indexPosition]));
     }
-    /** Extend this relation with new knowledge generated by inserting all tuples from a relation */
-    void extend(const LVMRelation& rel) override {
-        std::vector<RamDomain*> newTuples;
-        // store all values that will be implicitly relevant to the those that we will insert
-        for (const auto* tuple : rel) {
-            for (auto* newTuple : extend(tuple)) {
-                newTuples.push_back(newTuple);
+
+    /** Column orders of the tries */
+    std::vector<std::array<int, Arity>> orders;
+
+    /** Whether the column order of a trie is the column order of the relation */
+    std::vector<bool> identities;
+
+    /** One trie per index */
+    std::vector<std::unique_ptr<trie_type>> tries;
+};
+
+/** Create a brie relation, return nullptr if its arity exceeds the supported arities of brie relations */
+inline std::unique_ptr<LVMRelation> createBrieRelation(size_t arity, const MinIndexSelection* orderSet,
+        std::string& relName, std::vector<std::string>& attributeTypes) {
+    switch (arity) {
+        case 1:
+            return std::make_unique<LVMBrieRelation<1>>(orderSet, relName, attributeTypes);
+        case 2:
+            return std::make_unique<LVMBrieRelation<2>>(orderSet, relName, attributeTypes);
+        case 3:
+            return std::make_unique<LVMBrieRelation<3>>(orderSet, relName, attributeTypes);
+        case 4:
+            return std::make_unique<LVMBrieRelation<4>>(orderSet, relName, attributeTypes);
+        case 5:
+            return std::make_unique<LVMBrieRelation<5>>(orderSet, relName, attributeTypes);
+        case 6:
+            return std::make_unique<LVMBrieRelation<6>>(orderSet, relName, attributeTypes);
+        case 7:
+            return std::make_unique<LVMBrieRelation<7>>(orderSet, relName, attributeTypes);
+        case 8:
+            return std::make_unique<LVMBrieRelation<8>>(orderSet, relName, attributeTypes);
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * Interpreter Compressed Relation
+ *
+ * A brie relation storing the tuples of every index in front-coded blocks, see CompressedSet.
+ */
+template <size_t Arity>
+using LVMCompressedRelation = LVMBrieRelation<Arity, CompressedSet<Arity>>;
+
+/**
+ * Create a compressed relation, return nullptr if its arity exceeds MaxArity.
+ *
+ * Compressed relations are meant for wide relations, hence they support larger arities than brie relations.
+ */
+template <size_t MaxArity = 16>
+std::unique_ptr<LVMRelation> createCompressedRelation(size_t arity, const MinIndexSelection* orderSet,
+        std::string& relName, std::vector<std::string>& attributeTypes) {
+    if (arity == MaxArity) {
+        return std::make_unique<LVMCompressedRelation<MaxArity>>(orderSet, relName, attributeTypes);
+    }
+    return createCompressedRelation<MaxArity - 1>(arity, orderSet, relName, attributeTypes);
+}
+
+template <>
+inline std::unique_ptr<LVMRelation> createCompressedRelation<0>(size_t arity,
+        const MinIndexSelection* orderSet, std::string& relName, std::vector<std::string>& attributeTypes) {
+    return nullptr;
+}
+
+/**
+ * Interpreter Hash Relation
+ *
+ * Tuples are stored in a hash set and, for every search binding only some of the columns, in a hash
+ * index keyed by the bound columns. Searches are identified by their bound columns rather than by
+ * the position of an index, hence they must be among the searches of the index selection.
+ */
+template <size_t Arity>
+class LVMHashRelation : public LVMRelation {
+    using index_type = HashIndex<Arity>;
+    using entry_type = typename index_type::entry_type;
+    using hash_iterator = LVMPermutedIterator<typename index_type::iterator, Arity>;
+
+public:
+    LVMHashRelation(const MinIndexSelection* orderSet, std::string& relName,
+            std::vector<std::string>& attributeTypes)
+            : LVMRelation(Arity, orderSet, relName, attributeTypes) {
+        const SearchSignature full = (SearchSignature(1) << Arity) - 1;
+        signatures.push_back(full);
+        for (auto search : orderSet->getSearches()) {
+            if (search != full) {
+                signatures.push_back(search);
             }
         }
-        for (const auto* newTuple : newTuples) {
-            LVMIndirectRelation::insert(newTuple);
-            delete[] newTuple;
+        for (auto search : signatures) {
+            indices.push_back(std::make_unique<index_type>(search));
+        }
+        for (size_t i = 0; i < Arity; ++i) {
+            order[i] = i;
         }
     }
+
+    /** Insert tuple, safe for concurrent insertions as the hash set decides whether it is new */
+    void insert(const RamDomain* tuple) override {
+        const entry_type entry = toEntry(tuple);
+        if (indices[0]->insert(entry)) {
+            for (size_t i = 1; i < indices.size(); ++i) {
+                indices[i]->insert(entry);
+            }
+            num_tuples++;
+        }
+    }
+
+    /** Merge another relation into this relation */
+    void insert(const LVMRelation& other) override {
+        assert(getArity() == other.getArity());
+        for (const auto& cur : other) {
+            insert(cur);
+        }
+    }
+
+    /** Purge table */
+    void purge() override {
+        for (auto& cur : indices) {
+            cur->clear();
+        }
+        num_tuples = 0;
+    }
+
+    /** Purge table, keeping the memory of the indices for refilling it */
+    void reset() override {
+        for (auto& cur : indices) {
+            cur->reset();
+        }
+        num_tuples = 0;
+    }
+
+    /** check whether a tuple exists in the relation */
+    bool exists(const RamDomain* tuple) const override {
+        return indices[0]->contains(toEntry(tuple));
+    }
+
+    /** Iterator for relation, uses the hash set as default */
+    iterator begin() const override {
+        return makeIterator(indices[0]->begin());
+    }
+
+    iterator end() const override {
+        return makeIterator(indices[0]->end());
+    }
+
+    /** Partition the relation for parallel iteration, uses the hash set as default */
+    std::vector<range<iterator>> partition() const override {
+        std::vector<range<iterator>> res;
+        for (const auto& chunk : indices[0]->partition(400)) {
+            res.push_back(range<iterator>(makeIterator(chunk.begin()), makeIterator(chunk.end())));
+        }
+        return res;
+    }
+
+    /** Return range iterator, the columns bound by the search are those with equal bounds */
+    std::pair<iterator, iterator> lowerUpperBound(
+            const RamDomain* low, const RamDomain* high, size_t indexPosition) const override {
+        SearchSignature search = 0;
+        for (size_t i = 0; i < Arity; ++i) {
+            if (low[i] == high[i]) {
+                search |= SearchSignature(1) << i;
+            }
+        }
+        if (search == 0) {
+            return std::make_pair(begin(), end());
+        }
+        auto pos = std::find(signatures.begin(), signatures.end(), search);
+        assert(pos != signatures.end() && "search without hash index");
+        auto bounds = indices[pos - signatures.begin()]->equalRange(toEntry(low));
+        return std::make_pair(makeIterator(bounds.begin()), makeIterator(bounds.end()));
+    }
+
+    /** Extend tuple */
+    std::vector<RamDomain*> extend(const RamDomain* tuple) override {
+        std::vector<RamDomain*> newTuples;
+
+        // A standard relation does not generate extra new knowledge on insertion.
+        newTuples.push_back(new RamDomain[2]{tuple[0], tuple[1]});
+
+        return newTuples;
+    }
+
+    /** Extend relation */
+    void extend(const LVMRelation& rel) override {}
+
+private:
+    static entry_type toEntry(const RamDomain* tuple) {
+        entry_type entry;
+        std::copy(tuple, tuple + Arity, entry.data);
+        return entry;
+    }
+
+    iterator makeIterator(const typename index_type::iterator& it) const {
+        return iterator(new hash_iterator(it, order, true));
+    }
+
+    /** The columns bound by the searches of the indices, the first index holds all columns */
+    std::vector<SearchSignature> signatures;
+
+    /** One hash index per search */
+    std::vector<std::unique_ptr<index_type>> indices;
+
+    /** The identity order of the iterated tuples */
+    std::array<int, Arity> order;
+};
+
+/** Create a hash relation, return nullptr if its arity exceeds MaxArity */
+template <size_t MaxArity = 16>
+std::unique_ptr<LVMRelation> createHashRelation(size_t arity, const MinIndexSelection* orderSet,
+        std::string& relName, std::vector<std::string>& attributeTypes) {
+    if (arity == MaxArity) {
+        return std::make_unique<LVMHashRelation<MaxArity>>(orderSet, relName, attributeTypes);
+    }
+    return createHashRelation<MaxArity - 1>(arity, orderSet, relName, attributeTypes);
+}
+
+template <>
+inline std::unique_ptr<LVMRelation> createHashRelation<0>(size_t arity, const MinIndexSelection* orderSet,
+        std::string& relName, std::vector<std::string>& attributeTypes) {
+    return nullptr;
+}
+
+/**
+ * Interpreter Equivalence Relation
+ *
+ * A binary relation stored as an equivalence relation, whose reflexive, symmetric and transitive closure
+ * is maintained by the disjoint sets of the data structure.
+ */
+class LVMEqRelation : public LVMRelation {
+    using tuple_type = ram::Tuple<RamDomain, 2>;
+    using eqrel_type = EquivalenceRelation<tuple_type>;
+    using eqrel_iterator = LVMPermutedIterator<eqrel_type::iterator, 2>;
+
+public:
+    LVMEqRelation(const MinIndexSelection* orderSet, std::string relName,
+            std::vector<std::string>& attributeTypes)
+            : LVMRelation(2, orderSet, relName, attributeTypes) {}
+
+    /** Gets the number of contained tuples */
+    size_t size() const override {
+        return eqrel.size();
+    }
+
+    /** Check whether relation is empty */
+    bool empty() const override {
+        return eqrel.size() == 0;
+    }
+
+    /** Insert tuple, safe for concurrent insertions */
+    void insert(const RamDomain* tuple) override {
+        eqrel.insert(tuple[0], tuple[1]);
+    }
+
+    /** Merge another relation into this relation */
+    void insert(const LVMRelation& other) override {
+        assert(getArity() == other.getArity());
+        if (auto* otherEqRel = dynamic_cast<const LVMEqRelation*>(&other)) {
+            eqrel.insertAll(otherEqRel->eqrel);
+            return;
+        }
+        for (const auto& cur : other) {
+            insert(cur);
+        }
+    }
+
+    /** Purge table */
+    void purge() override {
+        eqrel.clear();
+    }
+
+    /** check whether a tuple exists in the relation */
+    bool exists(const RamDomain* tuple) const override {
+        return eqrel.contains(tuple[0], tuple[1]);
+    }
+
+    /** Iterator for relation */
+    iterator begin() const override {
+        return makeIterator(eqrel.begin());
+    }
+
+    iterator end() const override {
+        return makeIterator(eqrel.end());
+    }
+
+    /** Partition the relation for parallel iteration */
+    std::vector<range<iterator>> partition() const override {
+        std::vector<range<iterator>> res;
+        for (const auto& chunk : eqrel.partition(400)) {
+            res.push_back(range<iterator>(makeIterator(chunk.begin()), makeIterator(chunk.end())));
+        }
+        return res;
+    }
+
+    /**
+     * Return range iterator.
+     * As the relation is symmetric, a search binding only the second column is answered by a search on
+     * the first column whose pairs are swapped.
+     */
+    std::pair<iterator, iterator> lowerUpperBound(
+            const RamDomain* low, const RamDomain* high, size_t indexPosition) const override {
+        bool firstBound = low[0] == high[0];
+        bool secondBound = low[1] == high[1];
+        if (firstBound && secondBound) {
+            auto bounds = eqrel.getBoundaries<2>(tuple_type{{low[0], low[1]}});
+            return std::make_pair(makeIterator(bounds.begin()), makeIterator(bounds.end()));
+        }
+        if (firstBound || secondBound) {
+            RamDomain value = firstBound ? low[0] : low[1];
+            auto bounds = eqrel.getBoundaries<1>(tuple_type{{value, value}});
+            return std::make_pair(
+                    makeIterator(bounds.begin(), !firstBound), makeIterator(bounds.end(), !firstBound));
+        }
+        return std::make_pair(begin(), end());
+    }
+
+    /** Extend tuple, the closure is maintained by the equivalence relation itself */
+    std::vector<RamDomain*> extend(const RamDomain* tuple) override {
+        std::vector<RamDomain*> newTuples;
+        newTuples.push_back(new RamDomain[2]{tuple[0], tuple[1]});
+        return newTuples;
+    }
+
+    /**
+     * Extend this relation with the knowledge implied by an old relation, i.e. add the disjoint sets of
+     * the old relation intersecting the sets of this relation
+     */
+    void extend(const LVMRelation& rel) override {
+        if (auto* otherEqRel = dynamic_cast<const LVMEqRelation*>(&rel)) {
+            eqrel.extend(otherEqRel->eqrel);
+        }
+    }
+
+private:
+    /** Wrap an iterator of the equivalence relation, optionally swapping the columns of its pairs */
+    static iterator makeIterator(const eqrel_type::iterator& it, bool swapped = false) {
+        static const std::array<int, 2> identityOrder = {{0, 1}};
+        static const std::array<int, 2> swappedOrder = {{1, 0}};
+        return iterator(new eqrel_iterator(it, swapped ? swappedOrder : identityOrder, !swapped));
+    }
+
+    /** Equivalence relation storing the pairs */
+    eqrel_type eqrel;
 };
 
 }  // end of namespace souffle
@@ -0,0 +1,292 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file LeapfrogTrieJoin.h
+ *
+ * A worst-case optimal multi-way join (leapfrog triejoin) over relations
+ * stored in sorted indexes. It is used for rule bodies whose atoms form a
+ * cycle, for which any sequence of binary joins may produce intermediate
+ * results asymptotically larger than the final result.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A view of a relation as a trie whose levels are the columns of a lexicographical order.
+ *
+ * The iterator starts above the root; open() descends to the first key of the next level
+ * below the current key and up() returns to the parent key. On each level the keys are
+ * enumerated in ascending order by next() and seek().
+ */
+class TrieIterator {
+public:
+    virtual ~TrieIterator() = default;
+
+    /** Descend to the first key of the level below the current key */
+    virtual void open() = 0;
+
+    /** Return to the key of the parent level */
+    virtual void up() = 0;
+
+    /** Check whether all keys of the current level have been visited */
+    virtual bool atEnd() const = 0;
+
+    /** Obtain the current key */
+    virtual RamDomain key() const = 0;
+
+    /** Move to the next key of the current level */
+    virtual void next() = 0;
+
+    /** Move to the least key of the current level that is not less than the given value */
+    virtual void seek(RamDomain value) = 0;
+};
+
+/**
+ * A trie iterator over a sorted index whose lexicographical order starts with the given
+ * columns. The index is accessed by a function returning the range of tuples between a
+ * lower and an upper bound tuple, e.g. the lowerUpperBound operation of an index.
+ */
+template <typename Bounds>
+class IndexTrieIterator : public TrieIterator {
+    using range = typename std::decay<decltype(std::declval<Bounds&>()(
+            std::declval<const RamDomain*>(), std::declval<const RamDomain*>()))>::type;
+
+public:
+    IndexTrieIterator(Bounds bounds, std::vector<size_t> order, size_t arity)
+            : bounds(std::move(bounds)), order(std::move(order)), low(arity, MIN_RAM_DOMAIN),
+              high(arity, MAX_RAM_DOMAIN) {}
+
+    void open() override {
+        assert(ranges.size() < order.size() && "opening a level below the leaves");
+        if (!ranges.empty()) {
+            const size_t column = order[ranges.size() - 1];
+            low[column] = high[column] = key();
+        }
+        ranges.push_back(bounds(low.data(), high.data()));
+    }
+
+    void up() override {
+        assert(!ranges.empty() && "moving up from the root");
+        ranges.pop_back();
+        if (!ranges.empty()) {
+            const size_t column = order[ranges.size() - 1];
+            low[column] = MIN_RAM_DOMAIN;
+            high[column] = MAX_RAM_DOMAIN;
+        }
+    }
+
+    bool atEnd() const override {
+        return ranges.back().first == ranges.back().second;
+    }
+
+    RamDomain key() const override {
+        return (*ranges.back().first)[order[ranges.size() - 1]];
+    }
+
+    void next() override {
+        const RamDomain current = key();
+        if (current == MAX_RAM_DOMAIN) {
+            ranges.back().first = ranges.back().second;
+        } else {
+            seek(current + 1);
+        }
+    }
+
+    void seek(RamDomain value) override {
+        if (key() >= value) {
+            return;
+        }
+        // the least tuple below the parent keys whose column is not less than the value
+        const size_t column = order[ranges.size() - 1];
+        low[column] = value;
+        ranges.back().first = bounds(low.data(), high.data()).first;
+        low[column] = MIN_RAM_DOMAIN;
+    }
+
+private:
+    /** Obtains the range of tuples between two bounds */
+    Bounds bounds;
+
+    /** Columns of the levels of the trie */
+    const std::vector<size_t> order;
+
+    /** Bounds fixing the keys of the levels above the current level */
+    std::vector<RamDomain> low;
+    std::vector<RamDomain> high;
+
+    /** Remaining tuples below the parent keys, one range per open level */
+    std::vector<range> ranges;
+};
+
+/** Create a trie iterator over an index accessed by the given bounds function */
+template <typename Bounds>
+std::unique_ptr<TrieIterator> makeIndexTrieIterator(Bounds bounds, std::vector<size_t> order, size_t arity) {
+    return std::make_unique<IndexTrieIterator<Bounds>>(std::move(bounds), std::move(order), arity);
+}
+
+/**
+ * Leapfrog triejoin (Veldhuizen, 2014) of relations over a sequence of variables.
+ *
+ * Each relation is given as a trie iterator whose levels are bound to variables in ascending
+ * order. Variables are bound one after another; the value of a variable is found by
+ * leapfrogging the iterators of the relations containing it, i.e. repeatedly seeking the
+ * iterator with the least key to the greatest key until all keys agree. The running time is
+ * bounded by the worst-case size of the result up to a logarithmic factor.
+ */
+class LeapfrogTrieJoin {
+public:
+    explicit LeapfrogTrieJoin(size_t numVariables)
+            : binding(numVariables), participants(numVariables), levels(numVariables),
+              positions(numVariables) {}
+
+    /**
+     * Add a relation whose trie levels are bound to the given variables. The variables must
+     * be ascending, i.e. the variables are bound in the order of the trie levels.
+     */
+    void addIterator(std::unique_ptr<TrieIterator> iterator, const std::vector<size_t>& variables) {
+        assert(std::is_sorted(variables.begin(), variables.end()) && "variables out of order");
+        for (size_t variable : variables) {
+            assert(variable < participants.size() && "variable out of range");
+            participants[variable].push_back(iterators.size());
+        }
+        iterators.push_back(std::move(iterator));
+    }
+
+    /** Move to the next binding of all variables; return false when there is none */
+    bool next() {
+        if (exhausted || binding.empty()) {
+            return false;
+        }
+        size_t depth;
+        bool found;
+        if (!started) {
+            started = true;
+            depth = 0;
+            found = openLevel(depth);
+        } else {
+            depth = binding.size() - 1;
+            found = nextKey(depth);
+        }
+        while (true) {
+            if (found) {
+                if (depth + 1 == binding.size()) {
+                    return true;
+                }
+                found = openLevel(++depth);
+            } else {
+                closeLevel(depth);
+                if (depth == 0) {
+                    exhausted = true;
+                    return false;
+                }
+                found = nextKey(--depth);
+            }
+        }
+    }
+
+    /** Obtain the values of the variables of the current binding */
+    const RamDomain* getBinding() const {
+        return binding.data();
+    }
+
+private:
+    /** Open the level of a variable in all its relations and find its first value */
+    bool openLevel(size_t depth) {
+        auto& level = levels[depth];
+        level = participants[depth];
+        assert(!level.empty() && "variable does not occur in any relation");
+        for (size_t idx : level) {
+            iterators[idx]->open();
+        }
+        for (size_t idx : level) {
+            if (iterators[idx]->atEnd()) {
+                return false;
+            }
+        }
+        std::sort(level.begin(), level.end(),
+                [&](size_t a, size_t b) { return iterators[a]->key() < iterators[b]->key(); });
+        positions[depth] = 0;
+        return search(depth);
+    }
+
+    /** Close the level of a variable in all its relations */
+    void closeLevel(size_t depth) {
+        for (size_t idx : participants[depth]) {
+            iterators[idx]->up();
+        }
+    }
+
+    /** Find the next value of a variable */
+    bool nextKey(size_t depth) {
+        const auto& level = levels[depth];
+        size_t& pos = positions[depth];
+        auto& iterator = *iterators[level[pos]];
+        iterator.next();
+        if (iterator.atEnd()) {
+            return false;
+        }
+        pos = (pos + 1) % level.size();
+        return search(depth);
+    }
+
+    /** Leapfrog the iterators of a variable until their keys agree */
+    bool search(size_t depth) {
+        const auto& level = levels[depth];
+        size_t& pos = positions[depth];
+        const size_t size = level.size();
+        RamDomain maxKey = iterators[level[(pos + size - 1) % size]]->key();
+        while (true) {
+            auto& iterator = *iterators[level[pos]];
+            if (iterator.key() == maxKey) {
+                binding[depth] = maxKey;
+                return true;
+            }
+            iterator.seek(maxKey);
+            if (iterator.atEnd()) {
+                return false;
+            }
+            maxKey = iterator.key();
+            pos = (pos + 1) % size;
+        }
+    }
+
+    /** Values of the variables */
+    std::vector<RamDomain> binding;
+
+    /** Trie iterators of the relations */
+    std::vector<std::unique_ptr<TrieIterator>> iterators;
+
+    /** Relations containing each variable */
+    std::vector<std::vector<size_t>> participants;
+
+    /** Relations containing each variable, sorted by their keys when the level was opened */
+    std::vector<std::vector<size_t>> levels;
+
+    /** Position of the iterator with the least key for each variable */
+    std::vector<size_t> positions;
+
+    bool started = false;
+    bool exhausted = false;
+};
+
+}  // end of namespace souffle
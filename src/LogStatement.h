@@ -54,6 +54,14 @@ public:
         return line.str();
     }
 
+    static const std::string nRelationDistinct(
+            const std::string& relationName, const SrcLocation& srcLocation, const size_t column) {
+        const char* messageType = "@n-relation-distinct";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << srcLocation << ";" << column << ";";
+        return line.str();
+    }
+
     static const std::string tNonrecursiveRule(
             const std::string& relationName, const SrcLocation& srcLocation, const std::string& datalogText) {
         const char* messageType = "@t-nonrecursive-rule";
@@ -88,6 +96,15 @@ public:
         return line.str();
     }
 
+    static const std::string joinOrder(const std::string& relationName, const int version,
+            const SrcLocation& srcLocation, const std::string& datalogText, const std::string& atoms) {
+        const char* messageType = "@join-order";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << version << ";" << srcLocation << ";"
+             << datalogText << ";" << atoms << ";";
+        return line.str();
+    }
+
     static const std::string tRecursiveRelation(
             const std::string& relationName, const SrcLocation& srcLocation) {
         const char* messageType = "@t-recursive-relation";
@@ -3,6 +3,7 @@
 #include "ParallelUtils.h"
 #include <array>
 #include <atomic>
+#include <cassert>
 #include <cstring>
 #include <iostream>
 #include <list>
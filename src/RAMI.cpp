@@ -21,6 +21,7 @@
 #include "Global.h"
 #include "IODirectives.h"
 #include "IOSystem.h"
+#include "LeapfrogTrieJoin.h"
 #include "Logger.h"
 #include "ParallelUtils.h"
 #include "ProfileEvent.h"
@@ -33,6 +34,7 @@
 #include "RamProgram.h"
 #include "RamVisitor.h"
 #include "ReadStream.h"
+#include "RelationStats.h"
 #include "SignalHandler.h"
 #include "SymbolTable.h"
 #include "Util.h"
@@ -597,6 +599,33 @@ void RAMI::evalOp(const RamOperation& op, const RAMIContext& args) {
             return visitTupleOperation(lookup);
         }
 
+        bool visitLeapfrogJoin(const RamLeapfrogJoin& join) override {
+            // build a trie over the index of each relation ordered by the variables of its columns
+            LeapfrogTrieJoin leapfrog(join.getNumVariables());
+            auto relations = join.getRelations();
+            for (size_t i = 0; i < relations.size(); ++i) {
+                const RAMIRelation& rel = interpreter.getRelation(*relations[i]);
+                auto order = join.getOrder(i);
+                const MinIndexSelection::LexOrder lexOrder(order.begin(), order.end());
+                const MinIndexSelection& orderSet = interpreter.isa->getIndexes(*relations[i]);
+                RAMIIndex* idx = rel.getIndexByPos(orderSet.getOrderNum(lexOrder));
+                auto bounds = [idx](const RamDomain* low, const RamDomain* high) {
+                    return idx->lowerUpperBound(low, high);
+                };
+                leapfrog.addIterator(makeIndexTrieIterator(bounds, std::move(order), rel.getArity()),
+                        join.getSortedVariables(i));
+            }
+
+            // run nested part for each binding of the variables
+            while (leapfrog.next()) {
+                ctxt[join.getTupleId()] = leapfrog.getBinding();
+                if (!visitTupleOperation(join)) {
+                    break;
+                }
+            }
+            return true;
+        }
+
         bool visitAggregate(const RamAggregate& aggregate) override {
             // get the targeted relation
             const RAMIRelation& rel = interpreter.getRelation(aggregate.getRelation());
@@ -939,7 +968,7 @@ void RAMI::evalStmt(const RamStatement& stmt, const RAMIContext& args) {
 
         bool visitClear(const RamClear& clear) override {
             RAMIRelation& rel = interpreter.getRelation(clear.getRelation());
-            rel.purge();
+            rel.reset();
             return true;
         }
 
@@ -955,6 +984,17 @@ void RAMI::evalStmt(const RamStatement& stmt, const RAMIContext& args) {
             return true;
         }
 
+        bool visitLogStatistics(const RamLogStatistics& statistics) override {
+            const RAMIRelation& rel = interpreter.getRelation(statistics.getRelation());
+            const auto& messages = statistics.getMessages();
+            RelationStats stats = RelationStats::extractFrom(messages.size(), rel.begin(), rel.end());
+            for (size_t i = 0; i < messages.size(); ++i) {
+                ProfileEventSingleton::instance().makeQuantityEvent(
+                        messages[i], stats.getDistinctValues(i), interpreter.getIterationNumber());
+            }
+            return true;
+        }
+
         bool visitLoad(const RamLoad& load) override {
             for (IODirectives ioDirectives : load.getIODirectives()) {
                 try {
@@ -1010,6 +1050,11 @@ void RAMI::evalStmt(const RamStatement& stmt, const RAMIContext& args) {
             return true;
         }
 
+        bool visitAdaptiveQuery(const RamAdaptiveQuery& adaptive) override {
+            // the join order is only chosen at runtime by the LVM
+            return visit(adaptive.getQueries()[0]);
+        }
+
         bool visitMerge(const RamMerge& merge) override {
             // get involved relation
             RAMIRelation& src = interpreter.getRelation(merge.getSourceRelation());
@@ -93,10 +93,13 @@ public:
      * add tuples to the index via an iterator
      *
      * precondition: the tuples do not exist in the index
+     *
+     * Large ranges rebuild the underlying b-tree, which invalidates the hints.
      */
     template <class Iter>
     void insert(const Iter& a, const Iter& b) {
         set.insert(a, b);
+        operation_hints.clear();
     };
 
     /** check whether tuple exists in index */
@@ -110,6 +113,12 @@ public:
         operation_hints.clear();
     }
 
+    /** purge all hashes of index, keeping the memory of the b-tree for reuse */
+    void reset() {
+        set.reset();
+        operation_hints.clear();
+    }
+
     /** enables the index to be printed */
     void print(std::ostream& out) const {
         set.printStats(out);
@@ -98,32 +98,33 @@ public:
             return;
         }
 
-        int blockIndex = num_tuples / (BLOCK_SIZE / arity);
-        int tupleIndex = (num_tuples % (BLOCK_SIZE / arity)) * arity;
-
-        if (tupleIndex == 0) {
-            blockList.push_back(std::make_unique<RamDomain[]>(BLOCK_SIZE));
-        }
-
-        RamDomain* newTuple = &blockList[blockIndex][tupleIndex];
-        for (size_t i = 0; i < arity; ++i) {
-            newTuple[i] = tuple[i];
-        }
+        const RamDomain* newTuple = store(tuple);
 
         // update all indexes with new tuple
         for (auto& cur : indices) {
             cur.insert(newTuple);
         }
-
-        // increment relation size
-        num_tuples++;
     }
 
     /** Merge another relation into this relation */
-    void insert(const RAMIRelation& other) {
+    virtual void insert(const RAMIRelation& other) {
         assert(getArity() == other.getArity());
+        if (arity == 0) {
+            for (const auto& cur : other) {
+                insert(cur);
+            }
+            return;
+        }
+
+        // store the new tuples first, then add them to each index as a whole
+        std::vector<const RamDomain*> added;
         for (const auto& cur : other) {
-            insert(cur);
+            if (!exists(cur)) {
+                added.push_back(store(cur));
+            }
+        }
+        for (auto& cur : indices) {
+            cur.insert(added.begin(), added.end());
         }
     }
 
@@ -136,6 +137,15 @@ public:
         num_tuples = 0;
     }
 
+    /** Purge table, keeping the memory of the indexes for refilling it */
+    void reset() {
+        blockList.clear();
+        for (auto& cur : indices) {
+            cur.reset();
+        }
+        num_tuples = 0;
+    }
+
     /** get index for a given search signature. Order are encoded as bits for each column */
     RAMIIndex* getIndex(const SearchSignature& col) const {
         // Special case in provenance program, a 0 searchSignature is considered as a full search
@@ -248,6 +258,25 @@ public:
     virtual void extend(const RAMIRelation& rel) {}
 
 private:
+    /** Copy a tuple into the block storage without indexing it */
+    const RamDomain* store(const RamDomain* tuple) {
+        int blockIndex = num_tuples / (BLOCK_SIZE / arity);
+        int tupleIndex = (num_tuples % (BLOCK_SIZE / arity)) * arity;
+
+        if (tupleIndex == 0) {
+            blockList.push_back(std::make_unique<RamDomain[]>(BLOCK_SIZE));
+        }
+
+        RamDomain* newTuple = &blockList[blockIndex][tupleIndex];
+        for (size_t i = 0; i < arity; ++i) {
+            newTuple[i] = tuple[i];
+        }
+
+        // increment relation size
+        num_tuples++;
+        return newTuple;
+    }
+
     /** Arity of relation */
     const size_t arity;
 
@@ -307,6 +336,13 @@ public:
         }
     }
 
+    /** Merge another relation into this relation, extending every inserted tuple */
+    void insert(const RAMIRelation& other) override {
+        for (const auto& cur : other) {
+            insert(cur);
+        }
+    }
+
     /** Find the new knowledge generated by inserting a tuple */
     std::vector<RamDomain*> extend(const RamDomain* tuple) override {
         std::vector<RamDomain*> newTuples;
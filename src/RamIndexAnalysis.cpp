@@ -15,11 +15,17 @@
  ***********************************************************************/
 
 #include "RamIndexAnalysis.h"
+#include "Global.h"
 #include "RamCondition.h"
 #include "RamNode.h"
 #include "RamOperation.h"
 #include "RamTranslationUnit.h"
 #include "RamVisitor.h"
+#include "profile/ProgramRun.h"
+#include "profile/Reader.h"
+#include "profile/Relation.h"
+#include "profile/Rule.h"
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
@@ -154,6 +160,7 @@ void MinIndexSelection::solve() {
             chainToOrder.back().insert(cur);
         }
 
+        addRequiredOrders();
         return;
     }
 
@@ -203,6 +210,37 @@ void MinIndexSelection::solve() {
         }
         assert(k == search && "incorrect lexicographical order");
     }
+
+    addRequiredOrders();
+    selectHashSearches();
+}
+
+void MinIndexSelection::addRequiredOrders() {
+    for (const LexOrder& required : requiredOrders) {
+        bool covered = std::any_of(orders.begin(), orders.end(),
+                [&](const LexOrder& order) { return isPrefix(required, order); });
+        if (!covered) {
+            orders.push_back(required);
+            chainToOrder.push_back(Chain());
+        }
+    }
+}
+
+void MinIndexSelection::selectHashSearches() {
+    size_t total = 0;
+    for (const auto& cur : frequencies) {
+        total += cur.second;
+    }
+
+    for (const auto& cur : frequencies) {
+        SearchSignature search = cur.first;
+        if (cur.second == 0 || cur.second < total * HOT_SEARCH_RATIO) {
+            continue;
+        }
+        if (searches.find(search) != searches.end()) {
+            hashSearches.insert(search);
+        }
+    }
 }
 
 MinIndexSelection::Chain MinIndexSelection::getChain(
@@ -287,9 +325,22 @@ void RamIndexAnalysis::run(const RamTranslationUnit& translationUnit) {
         } else if (const auto* ramRel = dynamic_cast<const RamRelation*>(&node)) {
             MinIndexSelection& indexes = getIndexes(*ramRel);
             indexes.addSearch(getSearchSignature(ramRel));
+        } else if (const auto* join = dynamic_cast<const RamLeapfrogJoin*>(&node)) {
+            // the tries of a leapfrog join need indexes ordered by the variables of the columns
+            const auto relations = join->getRelations();
+            for (size_t i = 0; i < relations.size(); ++i) {
+                const auto order = join->getOrder(i);
+                getIndexes(*relations[i]).addRequiredOrder(
+                        MinIndexSelection::LexOrder(order.begin(), order.end()));
+            }
         }
     });
 
+    // provenance relies on ordered indexes over the annotations of its relations, hence no hash indexes
+    if (Global::config().has("profile-use") && !Global::config().has("provenance")) {
+        addProfiledFrequencies(translationUnit);
+    }
+
     // A swap happen between rel A and rel B indicates A should include all indices of B, vice versa.
     visitDepthFirst(*translationUnit.getProgram(), [&](const RamSwap& swap) {
         // Note: this naive approach will not work if there exists chain or cyclic swapping.
@@ -312,6 +363,26 @@ void RamIndexAnalysis::run(const RamTranslationUnit& translationUnit) {
         for (const auto& signature : indexesB.getSearches()) {
             indexesA.addSearch(signature);
         }
+
+        // Both relations share the profiled frequencies so that they are given the same indexes
+        const MinIndexSelection::SearchFrequencies frequenciesA = indexesA.getSearchFrequencies();
+        const MinIndexSelection::SearchFrequencies frequenciesB = indexesB.getSearchFrequencies();
+        for (const auto& cur : frequenciesB) {
+            indexesA.addSearchFrequency(cur.first, cur.second);
+        }
+        for (const auto& cur : frequenciesA) {
+            indexesB.addSearchFrequency(cur.first, cur.second);
+        }
+
+        // Both relations provide the orders required by either of them
+        const std::set<MinIndexSelection::LexOrder> requiredA = indexesA.getRequiredOrders();
+        const std::set<MinIndexSelection::LexOrder> requiredB = indexesB.getRequiredOrders();
+        for (const auto& order : requiredB) {
+            indexesA.addRequiredOrder(order);
+        }
+        for (const auto& order : requiredA) {
+            indexesB.addRequiredOrder(order);
+        }
     });
 
     // find optimal indexes for relations
@@ -329,6 +400,63 @@ void RamIndexAnalysis::run(const RamTranslationUnit& translationUnit) {
     }
 }
 
+void RamIndexAnalysis::addProfiledFrequencies(const RamTranslationUnit& translationUnit) {
+    auto programRun = std::make_shared<profile::ProgramRun>(profile::ProgramRun());
+    profile::Reader(Global::config().get("profile-use"), programRun).processFile();
+
+    // frequencies of the atoms of a clause by nesting level, summed over all iterations
+    std::map<std::string, std::map<size_t, size_t>> levelFrequencies;
+    auto addRule = [&](const profile::Rule& rule) {
+        for (const auto& atom : rule.getAtoms()) {
+            levelFrequencies[atom.rule][atom.level] += atom.frequency;
+        }
+    };
+    for (const auto& cur : programRun->getRelationMap()) {
+        for (const auto& rule : cur.second->getRuleMap()) {
+            addRule(*rule.second);
+        }
+        for (const auto& rule : cur.second->getRuleRecList()) {
+            addRule(*rule);
+        }
+    }
+
+    visitDepthFirst(*translationUnit.getProgram(), [&](const RamIndexOperation& search) {
+        // the profile text of a scan is "@frequency-atom;relation;version;clause;atom;original clause;level;"
+        // where the texts are escaped by stringify(); the profile stores them unescaped
+        std::vector<std::string> fields(1);
+        const std::string& text = search.getProfileText();
+        const std::map<char, char> escapes = {{';', ';'}, {'"', '"'}, {'n', '\n'}, {'t', '\t'}};
+        for (size_t i = 0; i < text.size(); ++i) {
+            auto escape = i + 1 < text.size() ? escapes.find(text[i + 1]) : escapes.end();
+            if (text[i] == '\\' && escape != escapes.end()) {
+                fields.back() += escape->second;
+                ++i;
+            } else if (text[i] == ';') {
+                fields.emplace_back();
+            } else {
+                fields.back() += text[i];
+            }
+        }
+        if (fields.size() < 7 || fields[0] != "@frequency-atom") {
+            return;
+        }
+
+        auto clause = levelFrequencies.find(fields[3]);
+        if (clause == levelFrequencies.end()) {
+            return;
+        }
+        size_t level = std::stoul(fields[6]);
+
+        // a search at the outermost level is looked up once
+        size_t lookups = 1;
+        auto enclosing = clause->second.lower_bound(level);
+        if (enclosing != clause->second.begin()) {
+            lookups = std::prev(enclosing)->second;
+        }
+        getIndexes(search.getRelation()).addSearchFrequency(getSearchSignature(&search), lookups);
+    });
+}
+
 MinIndexSelection& RamIndexAnalysis::getIndexes(const RamRelation& rel) {
     auto pos = minIndexCover.find(&rel);
     if (pos != minIndexCover.end()) {
@@ -359,9 +487,20 @@ void RamIndexAnalysis::print(std::ostream& os) const {
                     os << rel.getArg(i) << " ";
                 }
             }
+            auto frequency = indexes.getSearchFrequencies().find(cols);
+            if (frequency != indexes.getSearchFrequencies().end()) {
+                os << "(lookups: " << frequency->second << ")";
+            }
+            if (indexes.getHashSearches().count(cols) != 0) {
+                os << "(hash index)";
+            }
             os << "\n";
         }
 
+        if (getRepresentation(rel) == RelationRepresentation::HASH) {
+            os << "\tRepresentation: " << RelationRepresentation::HASH << "\n";
+        }
+
         os << "\tNumber of Indexes: " << indexes.getAllOrders().size() << "\n";
         for (auto& order : indexes.getAllOrders()) {
             os << "\t\t";
@@ -414,6 +553,23 @@ SearchSignature RamIndexAnalysis::getSearchSignature(const RamRelation* ramRel)
     return res;
 }
 
+RelationRepresentation RamIndexAnalysis::getRepresentation(const RamRelation& rel) const {
+    if (rel.getRepresentation() != RelationRepresentation::HASH) {
+        return rel.getRepresentation();
+    }
+    // provenance relies on ordered indexes over the annotations of its relations
+    if (rel.isNullary() || Global::config().has("provenance")) {
+        return RelationRepresentation::DEFAULT;
+    }
+    // range searches and leapfrog joins require ordered indexes
+    auto pos = minIndexCover.find(&rel);
+    if (pos != minIndexCover.end() && (!pos->second.hasOnlyPointSearches(rel.getArity()) ||
+                                              !pos->second.getRequiredOrders().empty())) {
+        return RelationRepresentation::DEFAULT;
+    }
+    return RelationRepresentation::HASH;
+}
+
 bool RamIndexAnalysis::isTotalSignature(const RamAbstractExistenceCheck* existCheck) const {
     for (const auto& cur : existCheck->getValues()) {
         if (isRamUndefValue(cur)) {
@@ -21,6 +21,7 @@
 #include "RamRelation.h"
 #include "RamStatement.h"
 #include "RamTypes.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <functional>
@@ -156,6 +157,10 @@ public:
     using Chain = std::set<SearchSignature>;
     using ChainOrderMap = std::vector<Chain>;
     using SearchSet = std::set<SearchSignature>;
+    using SearchFrequencies = std::map<SearchSignature, size_t>;
+
+    /* share of the profiled lookups of a relation that makes a search hot */
+    static constexpr double HOT_SEARCH_RATIO = 0.5;
 
     MinIndexSelection() = default;
     ~MinIndexSelection() = default;
@@ -172,6 +177,44 @@ public:
         return searches;
     }
 
+    /** @Brief Add the number of lookups of a search observed in a profiled run */
+    inline void addSearchFrequency(SearchSignature cols, size_t frequency) {
+        if (cols != 0) {
+            frequencies[cols] += frequency;
+        }
+    }
+
+    /** @Brief Get the number of lookups of searches observed in a profiled run */
+    const SearchFrequencies& getSearchFrequencies() const {
+        return frequencies;
+    }
+
+    /** @Brief Get the hot searches to be served by a hash index keyed by their columns */
+    const SearchSet& getHashSearches() const {
+        return hashSearches;
+    }
+
+    /** @Brief Require an index whose lexicographical order starts with the given columns */
+    inline void addRequiredOrder(const LexOrder& order) {
+        requiredOrders.insert(order);
+    }
+
+    /** @Brief Get orders required as prefixes of indexes */
+    const std::set<LexOrder>& getRequiredOrders() const {
+        return requiredOrders;
+    }
+
+    /** @Brief Get index whose lexicographical order starts with the given columns */
+    int getOrderNum(const LexOrder& order) const {
+        for (size_t i = 0; i < orders.size(); ++i) {
+            if (isPrefix(order, orders[i])) {
+                return i;
+            }
+        }
+        std::cerr << "Cannot find lexicographical order with the required prefix" << std::endl;
+        abort();
+    }
+
     /** @Brief Get index for a search */
     const LexOrder getLexOrder(SearchSignature cols) const {
         int idx = map(cols);
@@ -203,6 +246,16 @@ public:
     /** @Brief map the keys in the key set to lexicographical order */
     void solve();
 
+    /** @Brief check whether every search binds all or all but one of the given number of columns */
+    bool hasOnlyPointSearches(size_t arity) const {
+        for (auto search : searches) {
+            if (card(search) + 1 < arity) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     /** @Brief convert from a representation of A vertices to B vertices */
     static SearchSignature toB(SearchSignature a) {
         SearchSignature msb = 1;
@@ -233,10 +286,13 @@ public:
     }
 
 protected:
-    SearchSet searches;          // set of search patterns on table
-    OrderCollection orders;      // collection of lexicographical orders
-    ChainOrderMap chainToOrder;  // maps order index to set of searches covered by chain
-    MaxMatching matching;        // matching problem for finding minimal number of orders
+    SearchSet searches;                 // set of search patterns on table
+    SearchFrequencies frequencies;      // profiled number of lookups of search patterns
+    SearchSet hashSearches;             // hot search patterns served by hash indexes
+    std::set<LexOrder> requiredOrders;  // orders that must be prefixes of indexes
+    OrderCollection orders;             // collection of lexicographical orders
+    ChainOrderMap chainToOrder;         // maps order index to set of searches covered by chain
+    MaxMatching matching;               // matching problem for finding minimal number of orders
 
     /** @Brief count the number of bits in key */
     static size_t card(SearchSignature cols) {
@@ -298,6 +354,28 @@ protected:
     /** @Brief get all chains from the matching */
     const ChainOrderMap getChainsFromMatching(const MaxMatching::Matchings& match, const SearchSet& nodes);
 
+    /** @Brief check whether an order is a prefix of another order */
+    static bool isPrefix(const LexOrder& prefix, const LexOrder& order) {
+        return prefix.size() <= order.size() && std::equal(prefix.begin(), prefix.end(), order.begin());
+    }
+
+    /** @Brief add an index for each required order that is not a prefix of an index
+     *
+     * The new indexes serve no search, i.e. their chains are empty; they are only
+     * accessed by their order, e.g. by the tries of a leapfrog join.
+     */
+    void addRequiredOrders();
+
+    /** @Brief select the hot searches to be served by hash indexes
+     *
+     * The chain cover treats all searches alike and serves a search that dominates the
+     * profiled lookups of a relation by a range lookup on a prefix of an order. Another order
+     * would answer it by the same prefix lookup, hence such a search is additionally served
+     * by a hash index keyed by its columns, wherever the representation of the relation
+     * supports one. It stays in its chain for all other representations.
+     */
+    void selectHashSearches();
+
     /** @Brief get all nodes which are unmatched from A-> B */
     const SearchSet getUnmatchedKeys(const MaxMatching::Matchings& match, const SearchSet& nodes) {
         SearchSet unmatched;
@@ -375,7 +453,25 @@ public:
      */
     bool isTotalSignature(const RamAbstractExistenceCheck* existCheck) const;
 
+    /**
+     * @Brief Get the data structure representing a relation
+     * @param relation
+     * @result the representation of the relation; a hash representation falls back to the default
+     * unless every search of the relation binds all or all but one column
+     */
+    RelationRepresentation getRepresentation(const RamRelation& rel) const;
+
 private:
+    /**
+     * @Brief add the number of lookups of each index operation in the profile given by --profile-use
+     * @param translationUnit
+     *
+     * An index operation is matched with the profile by the atom-frequency text of its scan. A
+     * search is looked up once per tuple of the enclosing loop, hence its number of lookups is the
+     * frequency of the innermost atom above it in the same clause.
+     */
+    void addProfiledFrequencies(const RamTranslationUnit& translationUnit);
+
     /**
      * minimal index cover for relations, i.e., maps a relation to a set of indexes
      */
@@ -98,6 +98,11 @@ int RamLevelAnalysis::getLevel(const RamNode* node) const {
             return visit(unpack.getExpression());
         }
 
+        // leapfrog join
+        int visitLeapfrogJoin(const RamLeapfrogJoin& join) override {
+            return -1;
+        }
+
         // filter
         int visitFilter(const RamFilter& filter) override {
             return visit(filter.getCondition());
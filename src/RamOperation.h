@@ -22,10 +22,12 @@
 #include "RamRelation.h"
 #include "RamTypes.h"
 #include "Util.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <iosfwd>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -889,6 +891,120 @@ protected:
     }
 };
 
+/**
+ * @class RamLeapfrogJoin
+ * @brief Multi-way join of relations by a leapfrog triejoin
+ *
+ * Binds the elements of a tuple, the variables of the join, to all values
+ * such that every relation contains the tuple of the variables of its
+ * columns. The relations are searched by indexes whose lexicographical
+ * order starts with the columns sorted by their variables.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * LEAPFROG JOIN edge(t0.0,t0.1), edge(t0.1,t0.2), edge(t0.2,t0.0) INTO t0
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamLeapfrogJoin : public RamTupleOperation {
+public:
+    RamLeapfrogJoin(std::vector<std::unique_ptr<RamRelationReference>> relRefs,
+            std::vector<std::vector<size_t>> variables, size_t numVariables, int ident,
+            std::unique_ptr<RamOperation> nested, std::string profileText = "")
+            : RamTupleOperation(ident, std::move(nested), std::move(profileText)),
+              relationRefs(std::move(relRefs)), variables(std::move(variables)), numVariables(numVariables) {
+        assert(relationRefs.size() == this->variables.size() && "number of relations and atoms differ");
+    }
+
+    /** @brief Get joined relations */
+    std::vector<const RamRelation*> getRelations() const {
+        std::vector<const RamRelation*> res;
+        for (const auto& ref : relationRefs) {
+            res.push_back(ref->get());
+        }
+        return res;
+    }
+
+    /** @brief Get variables of the columns of the i-th relation */
+    const std::vector<size_t>& getVariables(size_t i) const {
+        return variables[i];
+    }
+
+    /** @brief Get number of variables, i.e. the arity of the bound tuple */
+    size_t getNumVariables() const {
+        return numVariables;
+    }
+
+    /** @brief Get columns of the i-th relation sorted by their variables, i.e. the order of its trie */
+    std::vector<size_t> getOrder(size_t i) const {
+        std::vector<size_t> order(variables[i].size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+                [&](size_t a, size_t b) { return variables[i][a] < variables[i][b]; });
+        return order;
+    }
+
+    /** @brief Get variables of the levels of the trie of the i-th relation */
+    std::vector<size_t> getSortedVariables(size_t i) const {
+        std::vector<size_t> res(variables[i]);
+        std::sort(res.begin(), res.end());
+        return res;
+    }
+
+    std::vector<const RamNode*> getChildNodes() const override {
+        auto res = RamTupleOperation::getChildNodes();
+        for (const auto& ref : relationRefs) {
+            res.push_back(ref.get());
+        }
+        return res;
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "LEAPFROG JOIN ";
+        for (size_t i = 0; i < relationRefs.size(); ++i) {
+            os << (i > 0 ? ", " : "") << relationRefs[i]->get()->getName() << "(";
+            os << join(variables[i], ",", [&](std::ostream& out, size_t var) {
+                out << "t" << getTupleId() << "." << var;
+            });
+            os << ")";
+        }
+        os << " INTO t" << getTupleId() << std::endl;
+        RamTupleOperation::print(os, tabpos + 1);
+    }
+
+    RamLeapfrogJoin* clone() const override {
+        std::vector<std::unique_ptr<RamRelationReference>> refs;
+        for (const auto& ref : relationRefs) {
+            refs.emplace_back(ref->clone());
+        }
+        return new RamLeapfrogJoin(std::move(refs), variables, numVariables, getTupleId(),
+                std::unique_ptr<RamOperation>(getOperation().clone()), getProfileText());
+    }
+
+    void apply(const RamNodeMapper& map) override {
+        RamTupleOperation::apply(map);
+        for (auto& ref : relationRefs) {
+            ref = map(std::move(ref));
+        }
+    }
+
+protected:
+    /** Joined relations */
+    std::vector<std::unique_ptr<RamRelationReference>> relationRefs;
+
+    /** Variables of the columns of each relation */
+    const std::vector<std::vector<size_t>> variables;
+
+    /** Number of variables */
+    const size_t numVariables;
+
+    bool equal(const RamNode& node) const override {
+        assert(nullptr != dynamic_cast<const RamLeapfrogJoin*>(&node));
+        const auto& other = static_cast<const RamLeapfrogJoin&>(node);
+        return RamTupleOperation::equal(other) && equal_targets(relationRefs, other.relationRefs) &&
+               variables == other.variables && numVariables == other.numVariables;
+    }
+};
+
 /**
  * @class RamAbstractConditional
  * @brief Abstract conditional statement
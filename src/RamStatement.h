@@ -503,6 +503,95 @@ protected:
     }
 };
 
+/**
+ * @class RamAdaptiveQuery
+ * @brief Alternative loop nests of a rule, one of which is evaluated
+ *
+ * All queries compute the same tuples, joining the atoms of a rule in
+ * different orders. An evaluator may choose any of them each time the
+ * statement is executed, e.g., based on the current sizes of the scanned
+ * relations. The profile text of a query, if not empty, is logged when
+ * the query is chosen.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * ADAPTIVE QUERY
+ *  ALTERNATIVE
+ *   QUERY
+ *    FOR t0 in A
+ *     ...
+ *  ALTERNATIVE
+ *   QUERY
+ *    FOR t0 in B
+ *     ...
+ * END ADAPTIVE QUERY
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class RamAdaptiveQuery : public RamStatement {
+public:
+    RamAdaptiveQuery() = default;
+
+    /** @brief Add an alternative */
+    void add(std::unique_ptr<RamQuery> query, std::string profileText = "") {
+        queries.push_back(std::move(query));
+        profileTexts.push_back(std::move(profileText));
+    }
+
+    /** @brief Get alternatives */
+    std::vector<RamQuery*> getQueries() const {
+        return toPtrVector(queries);
+    }
+
+    /** @brief Get profile text of the i-th alternative */
+    const std::string& getProfileText(size_t i) const {
+        return profileTexts[i];
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "ADAPTIVE QUERY" << std::endl;
+        for (const auto& query : queries) {
+            os << times(" ", tabpos + 1) << "ALTERNATIVE" << std::endl;
+            query->print(os, tabpos + 2);
+        }
+        os << times(" ", tabpos) << "END ADAPTIVE QUERY" << std::endl;
+    }
+
+    std::vector<const RamNode*> getChildNodes() const override {
+        std::vector<const RamNode*> res;
+        for (const auto& cur : queries) {
+            res.push_back(cur.get());
+        }
+        return res;
+    }
+
+    RamAdaptiveQuery* clone() const override {
+        auto* res = new RamAdaptiveQuery();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            res->add(std::unique_ptr<RamQuery>(queries[i]->clone()), profileTexts[i]);
+        }
+        return res;
+    }
+
+    void apply(const RamNodeMapper& map) override {
+        for (auto& query : queries) {
+            query = map(std::move(query));
+        }
+    }
+
+protected:
+    /** alternative queries */
+    std::vector<std::unique_ptr<RamQuery>> queries;
+
+    /** profile texts of the alternatives */
+    std::vector<std::string> profileTexts;
+
+    bool equal(const RamNode& node) const override {
+        assert(nullptr != dynamic_cast<const RamAdaptiveQuery*>(&node));
+        const auto& other = static_cast<const RamAdaptiveQuery&>(node);
+        return equal_targets(queries, other.queries) && profileTexts == other.profileTexts;
+    }
+};
+
 /**
  * @class RamListStatement
  * @brief Abstract class for a list of RAM statements
@@ -1034,6 +1123,46 @@ protected:
     }
 };
 
+/**
+ * @class RamLogStatistics
+ * @brief Log the estimated number of distinct values of each column of a relation.
+ *
+ * The i-th message is logged with the estimate of the i-th column.
+ */
+class RamLogStatistics : public RamRelationStatement {
+public:
+    RamLogStatistics(std::unique_ptr<RamRelationReference> relRef, std::vector<std::string> messages)
+            : RamRelationStatement(std::move(relRef)), messages(std::move(messages)) {}
+
+    /** @brief Get logging messages, one per column */
+    const std::vector<std::string>& getMessages() const {
+        return messages;
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "LOGSTATISTICS " << getRelation().getName();
+        os << " TEXT ";
+        os << join(messages, ", ", [](std::ostream& out, const std::string& msg) {
+            out << "\"" << stringify(msg) << "\"";
+        });
+        os << std::endl;
+    }
+
+    RamLogStatistics* clone() const override {
+        return new RamLogStatistics(std::unique_ptr<RamRelationReference>(relationRef->clone()), messages);
+    }
+
+protected:
+    /** logging messages */
+    std::vector<std::string> messages;
+
+    bool equal(const RamNode& node) const override {
+        assert(nullptr != dynamic_cast<const RamLogStatistics*>(&node));
+        const auto& other = static_cast<const RamLogStatistics&>(node);
+        return RamRelationStatement::equal(other) && getMessages() == other.getMessages();
+    }
+};
+
 #ifdef USE_MPI
 
 class RamRecv : public RamRelationStatement {
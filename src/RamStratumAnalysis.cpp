@@ -0,0 +1,172 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamStratumAnalysis.cpp
+ *
+ * Implementation of the RAM Stratum Analysis
+ *
+ ***********************************************************************/
+
+#include "RamStratumAnalysis.h"
+#include "Global.h"
+#include "RamOperation.h"
+#include "RamProgram.h"
+#include "RamStatement.h"
+#include "RamTranslationUnit.h"
+#include "RamVisitor.h"
+
+#include <string>
+
+namespace souffle {
+
+void RamStratumAnalysis::run(const RamTranslationUnit& translationUnit) {
+    main = translationUnit.getProgram()->getMain();
+
+    // only a main program consisting of strata is analysed
+    const auto* sequence = dynamic_cast<const RamSequence*>(main);
+    if (sequence == nullptr) {
+        return;
+    }
+    for (const RamStatement* stmt : sequence->getStatements()) {
+        const auto* stratum = dynamic_cast<const RamStratum*>(stmt);
+        if (stratum == nullptr) {
+            strata.clear();
+            return;
+        }
+        strata.push_back(stratum);
+    }
+
+    concurrent = strata.size() > 1 && std::stoi(Global::config().get("jobs")) != 1 &&
+                 !Global::config().has("profile") && !Global::config().has("engine");
+
+    statements.resize(strata.size());
+    predecessors.resize(strata.size());
+
+    // the last stratum writing each relation and the strata reading it since
+    std::map<const RamRelation*, size_t> lastWriter;
+    std::map<const RamRelation*, std::vector<size_t>> lastReaders;
+    // the last stratum performing IO of each kind other than files
+    std::map<std::string, size_t> lastIO;
+    // the strata accessing each relation and the stratum of each deferred drop
+    std::map<const RamRelation*, std::set<size_t>> accesses;
+    std::map<const RamDrop*, size_t> dropStratum;
+
+    for (size_t i = 0; i < strata.size(); ++i) {
+        // split the stratum into its statements and deferred drops
+        const RamStatement& body = strata[i]->getBody();
+        std::vector<const RamStatement*> stmts;
+        if (const auto* seq = dynamic_cast<const RamSequence*>(&body)) {
+            for (const RamStatement* stmt : seq->getStatements()) {
+                stmts.push_back(stmt);
+            }
+        } else {
+            stmts.push_back(&body);
+        }
+        for (const RamStatement* stmt : stmts) {
+            if (const auto* drop = dynamic_cast<const RamDrop*>(stmt)) {
+                deferredDrops.push_back(drop);
+                dropStratum[drop] = i;
+            } else {
+                statements[i].push_back(stmt);
+            }
+        }
+
+        // collect the accessed and written relations, and the kinds of IO
+        std::set<const RamRelation*> reads;
+        std::set<const RamRelation*> writes;
+        std::set<std::string> io;
+        const auto addIO = [&](const RamAbstractLoadStore& loadStore) {
+            for (const auto& directives : loadStore.getIODirectives()) {
+                const std::string& type = directives.getIOType();
+                if (type != "file") {
+                    io.insert(type.compare(0, 3, "std") == 0 ? "std" : type);
+                }
+            }
+        };
+        for (const RamStatement* stmt : statements[i]) {
+            visitDepthFirst(*stmt, [&](const RamRelationReference& ref) { reads.insert(ref.get()); });
+            visitDepthFirst(*stmt, [&](const RamCreate& create) { writes.insert(&create.getRelation()); });
+            visitDepthFirst(*stmt, [&](const RamClear& clear) { writes.insert(&clear.getRelation()); });
+            visitDepthFirst(*stmt, [&](const RamDrop& drop) { writes.insert(&drop.getRelation()); });
+            visitDepthFirst(*stmt, [&](const RamProject& project) { writes.insert(&project.getRelation()); });
+            visitDepthFirst(*stmt, [&](const RamMerge& merge) { writes.insert(&merge.getTargetRelation()); });
+            visitDepthFirst(*stmt, [&](const RamSwap& swap) {
+                writes.insert(&swap.getFirstRelation());
+                writes.insert(&swap.getSecondRelation());
+            });
+            visitDepthFirst(*stmt, [&](const RamLoad& load) {
+                writes.insert(&load.getRelation());
+                addIO(load);
+            });
+            visitDepthFirst(*stmt, [&](const RamStore& store) { addIO(store); });
+        }
+
+        // a stratum follows the last writer of the relations it accesses and the readers of the
+        // relations it writes
+        auto& preds = predecessors[i];
+        for (const RamRelation* rel : reads) {
+            auto pos = lastWriter.find(rel);
+            if (pos != lastWriter.end()) {
+                preds.insert(pos->second);
+            }
+            accesses[rel].insert(i);
+        }
+        for (const RamRelation* rel : writes) {
+            for (size_t reader : lastReaders[rel]) {
+                preds.insert(reader);
+            }
+        }
+        for (const std::string& kind : io) {
+            auto pos = lastIO.find(kind);
+            if (pos != lastIO.end()) {
+                preds.insert(pos->second);
+            }
+            lastIO[kind] = i;
+        }
+        preds.erase(i);
+
+        for (const RamRelation* rel : reads) {
+            lastReaders[rel].push_back(i);
+        }
+        for (const RamRelation* rel : writes) {
+            lastWriter[rel] = i;
+            lastReaders[rel].clear();
+        }
+    }
+
+    // a deferred drop waits for all strata accessing its relation
+    for (const RamDrop* drop : deferredDrops) {
+        auto& dropUsers = users[drop];
+        dropUsers = accesses[&drop->getRelation()];
+        dropUsers.insert(dropStratum[drop]);
+    }
+}
+
+void RamStratumAnalysis::print(std::ostream& os) const {
+    os << "------ Stratum Dependencies -------\n";
+    os << (concurrent ? "Concurrent" : "Sequential") << " evaluation of " << strata.size() << " strata\n";
+    for (size_t i = 0; i < strata.size(); ++i) {
+        os << "Stratum " << strata[i]->getIndex() << " after";
+        for (size_t pred : predecessors[i]) {
+            os << " " << strata[pred]->getIndex();
+        }
+        os << "\n";
+    }
+    for (const RamDrop* drop : deferredDrops) {
+        os << "Drop " << drop->getRelation().getName() << " after";
+        for (size_t user : users.at(drop)) {
+            os << " " << strata[user]->getIndex();
+        }
+        os << "\n";
+    }
+    os << "------ End of Stratum Dependencies -------\n";
+}
+
+}  // end of namespace souffle
@@ -0,0 +1,106 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamStratumAnalysis.h
+ *
+ * Computes the dependencies between the strata of a RAM program such that
+ * independent strata can be evaluated concurrently.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamAnalysis.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace souffle {
+
+class RamDrop;
+class RamStatement;
+class RamStratum;
+
+/**
+ * @class RamStratumAnalysis
+ * @brief A Ram Analysis computing the dependency DAG of the strata of the main program
+ *
+ * A stratum depends on an earlier stratum if one of them writes a relation the other one
+ * accesses, or if both of them perform console IO, which keeps the order of their output.
+ *
+ * The drops at the end of a stratum remove relations expired in the sequential order of the
+ * strata. When strata are evaluated concurrently, such a drop is deferred until all strata
+ * using the relation finished; it neither belongs to the statements of its stratum nor
+ * causes any dependency.
+ *
+ * Strata are evaluated concurrently only if more than one job is requested, and neither
+ * profiling nor a communication engine is enabled.
+ */
+class RamStratumAnalysis : public RamAnalysis {
+public:
+    static constexpr const char* name = "stratum-analysis";
+
+    void run(const RamTranslationUnit& translationUnit) override;
+
+    void print(std::ostream& os) const override;
+
+    /** @brief Check whether the strata of the main program are evaluated concurrently */
+    bool isConcurrent() const {
+        return concurrent;
+    }
+
+    /** @brief Get the main program whose strata are analysed */
+    const RamStatement* getMain() const {
+        return main;
+    }
+
+    /** @brief Get the strata of the main program in their sequential order */
+    const std::vector<const RamStratum*>& getStrata() const {
+        return strata;
+    }
+
+    /** @brief Get the statements of a stratum without its deferred drops */
+    const std::vector<const RamStatement*>& getStatements(size_t stratum) const {
+        return statements[stratum];
+    }
+
+    /** @brief Get the earlier strata a stratum depends on */
+    const std::set<size_t>& getPredecessors(size_t stratum) const {
+        return predecessors[stratum];
+    }
+
+    /** @brief Get the deferred drops in the sequential order of the strata */
+    const std::vector<const RamDrop*>& getDeferredDrops() const {
+        return deferredDrops;
+    }
+
+    /** @brief Get the strata which must finish before a deferred drop */
+    const std::set<size_t>& getUsers(const RamDrop& drop) const {
+        return users.at(&drop);
+    }
+
+protected:
+    bool concurrent = false;
+
+    const RamStatement* main = nullptr;
+
+    std::vector<const RamStratum*> strata;
+
+    std::vector<std::vector<const RamStatement*>> statements;
+
+    std::vector<std::set<size_t>> predecessors;
+
+    std::vector<const RamDrop*> deferredDrops;
+
+    std::map<const RamDrop*, std::set<size_t>> users;
+};
+
+}  // end of namespace souffle
@@ -106,6 +106,7 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Project);
         FORWARD(SubroutineReturnValue);
         FORWARD(UnpackRecord);
+        FORWARD(LeapfrogJoin);
         FORWARD(ParallelScan);
         FORWARD(Scan);
         FORWARD(ParallelIndexScan);
@@ -123,9 +124,11 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Load);
         FORWARD(Store);
         FORWARD(Query);
+        FORWARD(AdaptiveQuery);
         FORWARD(Clear);
         FORWARD(Drop);
         FORWARD(LogSize);
+        FORWARD(LogStatistics);
 
         FORWARD(Merge);
         FORWARD(Swap);
@@ -175,9 +178,11 @@ protected:
     LINK(Store, AbstractLoadStore);
     LINK(AbstractLoadStore, RelationStatement);
     LINK(Query, Statement);
+    LINK(AdaptiveQuery, Statement);
     LINK(Clear, RelationStatement);
     LINK(Drop, RelationStatement);
     LINK(LogSize, RelationStatement);
+    LINK(LogStatistics, RelationStatement);
 
     LINK(RelationStatement, Statement);
 
@@ -201,6 +206,7 @@ protected:
     LINK(Project, Operation);
     LINK(SubroutineReturnValue, Operation);
     LINK(UnpackRecord, TupleOperation);
+    LINK(LeapfrogJoin, TupleOperation);
     LINK(Scan, RelationOperation);
     LINK(ParallelScan, Scan);
     LINK(IndexScan, IndexOperation);
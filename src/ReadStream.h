@@ -18,6 +18,8 @@
 #include "RamTypes.h"
 #include "SymbolTable.h"
 
+#include <algorithm>
+#include <exception>
 #include <memory>
 #include <string>
 #include <vector>
@@ -31,22 +33,81 @@ public:
               arity(symbolMask.size() - (prov ? 2 : 0)) {}
     template <typename T>
     void readAll(T& relation) {
-        auto lease = symbolTable.acquireLock();
-        (void)lease;
-        while (const auto next = readNextTuple()) {
-            const RamDomain* ramDomain = next.get();
-            relation.insert(ramDomain);
+        const size_t tupleSize = symbolMask.size();
+        std::vector<RamDomain> buffer(std::max<size_t>(BATCH_SIZE * tupleSize, 1));
+        size_t position = 0;
+        while (const size_t count = readNextTuples(buffer.data(), BATCH_SIZE)) {
+            for (size_t i = 0; i < count; ++i, ++position) {
+                if (position % sampling != 0) {
+                    continue;
+                }
+                const RamDomain* ramDomain = buffer.data() + i * tupleSize;
+                relation.insert(ramDomain);
+            }
         }
     }
 
+    /** Keep only every n-th tuple read by readAll, e.g. for a sample run collecting statistics */
+    void setSampling(size_t n) {
+        sampling = std::max<size_t>(n, 1);
+    }
+
     virtual ~ReadStream() = default;
 
 protected:
+    /** Number of tuples requested per call to readNextTuples by readAll */
+    static constexpr size_t BATCH_SIZE = 1024;
+
     virtual std::unique_ptr<RamDomain[]> readNextTuple() = 0;
+
+    /**
+     * Read up to count tuples into buffer, stored back to back with symbolMask.size() elements
+     * each.
+     *
+     * Returns the number of tuples read, 0 once the input is exhausted. An error after the
+     * first tuple of a batch is raised by the following call, so no tuple is lost.
+     */
+    virtual size_t readNextTuples(RamDomain* buffer, size_t count) {
+        const size_t tupleSize = symbolMask.size();
+        return fillBatch(buffer, count, [&](RamDomain* tuple) {
+            const auto next = readNextTuple();
+            if (!next) {
+                return false;
+            }
+            std::copy(next.get(), next.get() + tupleSize, tuple);
+            return true;
+        });
+    }
+
+    /** Fill a batch by calling readOne for each slot until it returns false */
+    template <typename F>
+    size_t fillBatch(RamDomain* buffer, size_t count, F readOne) {
+        if (pendingError) {
+            std::exception_ptr error = pendingError;
+            pendingError = nullptr;
+            std::rethrow_exception(error);
+        }
+        const size_t tupleSize = symbolMask.size();
+        size_t read = 0;
+        try {
+            while (read < count && readOne(buffer + read * tupleSize)) {
+                ++read;
+            }
+        } catch (...) {
+            if (read == 0) {
+                throw;
+            }
+            pendingError = std::current_exception();
+        }
+        return read;
+    }
+
     const std::vector<bool>& symbolMask;
     SymbolTable& symbolTable;
     const bool isProvenance;
     const uint8_t arity;
+    std::exception_ptr pendingError;
+    size_t sampling = 1;
 };
 
 class ReadStreamFactory {
@@ -0,0 +1,215 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ReadStreamBinary.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BinaryFormat.h"
+#include "IODirectives.h"
+#include "RamTypes.h"
+#include "ReadStream.h"
+#include "SymbolTable.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace souffle {
+
+/**
+ * Reads a relation in the binary fact format described in BinaryFormat.h.
+ *
+ * The file is mapped into memory; every symbol of the embedded dictionary is interned once
+ * and symbol columns are remapped while tuples are copied out.
+ */
+class ReadFileBinary : public ReadStream {
+public:
+    ReadFileBinary(const std::vector<bool>& symbolMask, SymbolTable& symbolTable,
+            const IODirectives& ioDirectives, const bool provenance = false)
+            : ReadStream(symbolMask, symbolTable, provenance),
+              baseName(souffle::baseName(getFileName(ioDirectives))) {
+        const std::string fileName = getFileName(ioDirectives);
+        fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (ioDirectives.has("intermediate")) {
+                return;
+            }
+            throw std::invalid_argument("Cannot open fact file " + baseName + "\n");
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size = static_cast<size_t>(info.st_size);
+            void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                fd = -1;
+                throw std::invalid_argument("Cannot map fact file " + baseName + "\n");
+            }
+            data = static_cast<const char*>(mapping);
+        }
+        readHeader();
+    }
+
+    ~ReadFileBinary() override {
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+protected:
+    /**
+     * Read and return the next tuple.
+     *
+     * Returns nullptr if no tuple was readable.
+     * @return
+     */
+    std::unique_ptr<RamDomain[]> readNextTuple() override {
+        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(symbolMask.size());
+        if (readNextTuples(tuple.get(), 1) == 0) {
+            return nullptr;
+        }
+        return tuple;
+    }
+
+    size_t readNextTuples(RamDomain* buffer, size_t count) override {
+        const size_t tupleSize = symbolMask.size();
+        return fillBatch(buffer, count, [&](RamDomain* tuple) {
+            if (position == blockSize && !readBlock()) {
+                return false;
+            }
+            std::fill(tuple, tuple + tupleSize, 0);
+            const RamDomain* column = columns + position;
+            for (size_t col = 0; col < arity; ++col, column += blockSize) {
+                if (!symbolMask.at(col)) {
+                    tuple[col] = *column;
+                } else if (static_cast<size_t>(*column) < symbols.size()) {
+                    tuple[col] = symbols[*column];
+                } else {
+                    throwError("undefined symbol in column " + std::to_string(col + 1));
+                }
+            }
+            ++position;
+            return true;
+        });
+    }
+
+    void readHeader() {
+        if (!BinaryFormat::hasMagic(data, size)) {
+            throwError("not a binary fact file");
+        }
+        offset = BinaryFormat::MAGIC_SIZE;
+        if (readValue<uint32_t>() != BinaryFormat::VERSION) {
+            throwError("unsupported version");
+        }
+        if (readValue<uint32_t>() != sizeof(RamDomain)) {
+            throwError("written with a different RAM domain size");
+        }
+        if (readValue<uint32_t>() != arity) {
+            throwError("arity mismatch");
+        }
+        for (size_t col = 0; col < arity; ++col) {
+            if ((readValue<uint8_t>() != 0) != symbolMask.at(col)) {
+                throwError("attribute type mismatch in column " + std::to_string(col + 1));
+            }
+        }
+        offset += BinaryFormat::padding(offset);
+    }
+
+    /** Move to the next block, interning the symbols it introduces; false at the end of the file */
+    bool readBlock() {
+        if (offset >= size) {
+            return false;
+        }
+        blockSize = readValue<uint64_t>();
+        const auto newSymbols = readValue<uint64_t>();
+        for (uint64_t i = 0; i < newSymbols; ++i) {
+            const auto length = readValue<uint32_t>();
+            require(length);
+            symbols.push_back(symbolTable.unsafeLookup(std::string(data + offset, length)));
+            offset += length;
+        }
+        offset += BinaryFormat::padding(offset);
+        const size_t columnBytes = arity * blockSize * sizeof(RamDomain);
+        require(columnBytes);
+        columns = reinterpret_cast<const RamDomain*>(data + offset);
+        offset += columnBytes;
+        position = 0;
+        return true;
+    }
+
+    template <typename T>
+    T readValue() {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    void require(size_t bytes) {
+        if (offset + bytes > size) {
+            throwError("unexpected end of file");
+        }
+    }
+
+    [[noreturn]] void throwError(const std::string& reason) const {
+        throw std::invalid_argument("Cannot load binary fact file " + baseName + ": " + reason + "\n");
+    }
+
+    static std::string getFileName(const IODirectives& ioDirectives) {
+        if (ioDirectives.has("filename")) {
+            return ioDirectives.get("filename");
+        }
+        return ioDirectives.getRelationName() + ".facts";
+    }
+
+    std::string baseName;
+    int fd = -1;
+    const char* data = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+    /** global symbol numbers of the file-local symbols seen so far */
+    std::vector<RamDomain> symbols;
+    /** columns of the current block */
+    const RamDomain* columns = nullptr;
+    size_t blockSize = 0;
+    size_t position = 0;
+};
+
+class ReadFileBinaryFactory : public ReadStreamFactory {
+public:
+    std::unique_ptr<ReadStream> getReader(const std::vector<bool>& symbolMask, SymbolTable& symbolTable,
+            const IODirectives& ioDirectives, const bool provenance) override {
+        return std::make_unique<ReadFileBinary>(symbolMask, symbolTable, ioDirectives, provenance);
+    }
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+    ~ReadFileBinaryFactory() override = default;
+};
+
+} /* namespace souffle */
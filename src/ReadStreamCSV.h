@@ -15,6 +15,7 @@
 #pragma once
 
 #include "IODirectives.h"
+#include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "ReadStream.h"
 #include "SymbolTable.h"
@@ -22,15 +23,24 @@
 
 #ifdef USE_LIBZ
 #include "gzfstream.h"
-#else
-#include <fstream>
 #endif
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace souffle {
 
@@ -56,20 +66,35 @@ protected:
      * @return
      */
     std::unique_ptr<RamDomain[]> readNextTuple() override {
-        if (file.eof()) {
+        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(symbolMask.size());
+        if (!readTuple(tuple.get())) {
             return nullptr;
         }
-        std::string line;
-        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(symbolMask.size());
+        return tuple;
+    }
 
+    size_t readNextTuples(RamDomain* buffer, size_t count) override {
+        return fillBatch(buffer, count, [&](RamDomain* tuple) { return readTuple(tuple); });
+    }
+
+    /**
+     * Read the next line into tuple, which must hold symbolMask.size() elements.
+     *
+     * Returns false if no tuple was readable.
+     */
+    bool readTuple(RamDomain* tuple) {
+        if (file.eof()) {
+            return false;
+        }
         if (!getline(file, line)) {
-            return nullptr;
+            return false;
         }
         // Handle Windows line endings on non-Windows systems
         if (!line.empty() && line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
+            line.pop_back();
         }
         ++lineNumber;
+        std::fill(tuple, tuple + symbolMask.size(), 0);
 
         size_t start = 0, end = 0, columnsFilled = 0;
         for (uint32_t column = 0; columnsFilled < arity; column++) {
@@ -108,17 +133,18 @@ protected:
             }
         }
 
-        return tuple;
+        return true;
     }
 
-    std::string getDelimiter(const IODirectives& ioDirectives) const {
+public:
+    static std::string getDelimiter(const IODirectives& ioDirectives) {
         if (ioDirectives.has("delimiter")) {
             return ioDirectives.get("delimiter");
         }
         return "\t";
     }
 
-    std::map<int, int> getInputColumnMap(const IODirectives& ioDirectives, const unsigned arity) const {
+    static std::map<int, int> getInputColumnMap(const IODirectives& ioDirectives, const unsigned arity) {
         std::string columnString = "";
         if (ioDirectives.has("columns")) {
             columnString = ioDirectives.get("columns");
@@ -144,8 +170,11 @@ protected:
         return inputMap;
     }
 
+protected:
     const std::string delimiter;
     std::istream& file;
+    /** buffer for the current line, reused across tuples */
+    std::string line;
     size_t lineNumber;
     std::map<int, int> inputMap;
 };
@@ -178,22 +207,35 @@ public:
         try {
             return ReadStreamCSV::readNextTuple();
         } catch (std::exception& e) {
-            std::stringstream errorMessage;
-            errorMessage << e.what();
-            errorMessage << "cannot parse fact file " << baseName << "!\n";
-            throw std::invalid_argument(errorMessage.str());
+            throwParseError(e);
+        }
+    }
+
+    size_t readNextTuples(RamDomain* buffer, size_t count) override {
+        try {
+            return ReadStreamCSV::readNextTuples(buffer, count);
+        } catch (std::exception& e) {
+            throwParseError(e);
         }
     }
 
     ~ReadFileCSV() override = default;
 
-protected:
-    std::string getFileName(const IODirectives& ioDirectives) const {
+    static std::string getFileName(const IODirectives& ioDirectives) {
         if (ioDirectives.has("filename")) {
             return ioDirectives.get("filename");
         }
         return ioDirectives.getRelationName() + ".facts";
     }
+
+protected:
+    [[noreturn]] void throwParseError(const std::exception& e) const {
+        std::stringstream errorMessage;
+        errorMessage << e.what();
+        errorMessage << "cannot parse fact file " << baseName << "!\n";
+        throw std::invalid_argument(errorMessage.str());
+    }
+
     std::string baseName;
 #ifdef USE_LIBZ
     gzfstream::igzfstream fileHandle;
@@ -202,6 +244,332 @@ protected:
 #endif
 };
 
+/**
+ * Reads a plain fact file by mapping it into memory, splitting it at line boundaries into
+ * chunks and parsing a window of chunks in parallel whenever the tuples of the previous window
+ * have been delivered, so that the parsed tuples held at any time are bounded by the window.
+ *
+ * Symbols that are already in the symbol table are resolved while parsing; new symbols are
+ * interned after each window in file order, so symbol numbering is the same as with ReadFileCSV.
+ * Tuples before the first malformed line are still delivered before the error is raised.
+ */
+class ReadFileMappedCSV : public ReadStream {
+public:
+    ReadFileMappedCSV(const std::string& fileName, const std::vector<bool>& symbolMask,
+            SymbolTable& symbolTable, const IODirectives& ioDirectives, const bool provenance = false)
+            : ReadStream(symbolMask, symbolTable, provenance), baseName(souffle::baseName(fileName)),
+              delimiter(ReadStreamCSV::getDelimiter(ioDirectives)),
+              headers(ioDirectives.has("headers") && ioDirectives.get("headers") == "true") {
+        std::map<int, int> inputMap = ReadStreamCSV::getInputColumnMap(ioDirectives, arity);
+        if (!inputMap.empty()) {
+            columnMap.resize(inputMap.rbegin()->first + 1, -1);
+            for (const auto& cur : inputMap) {
+                if (cur.first >= 0) {
+                    columnMap[cur.first] = cur.second;
+                }
+            }
+        }
+        fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::invalid_argument("Cannot open fact file " + baseName + "\n");
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size = static_cast<size_t>(info.st_size);
+            void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw std::invalid_argument("Cannot map fact file " + baseName + "\n");
+            }
+            data = static_cast<const char*>(mapping);
+        }
+    }
+
+    ~ReadFileMappedCSV() override {
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    /**
+     * Check whether a fact file can be read through a memory mapping, i.e. whether it is a
+     * regular file that is not gzip-compressed.
+     */
+    static bool isMappable(const std::string& fileName) {
+        struct stat info;
+        if (stat(fileName.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+            return false;
+        }
+#ifdef USE_LIBZ
+        std::ifstream file(fileName, std::ios::in | std::ios::binary);
+        char magic[2] = {0, 0};
+        file.read(magic, 2);
+        if (static_cast<unsigned char>(magic[0]) == 0x1f && static_cast<unsigned char>(magic[1]) == 0x8b) {
+            return false;
+        }
+#endif
+        return true;
+    }
+
+protected:
+    /** A line-aligned part of the file together with the tuples parsed from it */
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        /** tuples stored back to back, each of symbolMask.size() elements */
+        std::vector<RamDomain> tuples;
+        /** slots in tuples holding symbols that were not in the symbol table yet, with their text */
+        std::vector<std::pair<size_t, std::pair<const char*, const char*>>> pending;
+        /** message of the first malformed line of this chunk, if any */
+        std::string error;
+    };
+
+    /**
+     * Read and return the next tuple.
+     *
+     * Returns nullptr if no tuple was readable.
+     * @return
+     */
+    std::unique_ptr<RamDomain[]> readNextTuple() override {
+        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(symbolMask.size());
+        if (readNextTuples(tuple.get(), 1) == 0) {
+            return nullptr;
+        }
+        return tuple;
+    }
+
+    /** Copy tuples straight out of the parsed chunks, parsing the next window once they are consumed */
+    size_t readNextTuples(RamDomain* buffer, size_t count) override {
+        const size_t tupleSize = symbolMask.size();
+        // nullary tuples carry no data, their lines are marked by a single slot each
+        const size_t stride = std::max<size_t>(tupleSize, 1);
+        size_t read = 0;
+        while (read < count) {
+            if (currentChunk == window.size() && !parseWindow()) {
+                break;
+            }
+            Chunk& chunk = window[currentChunk];
+            if (position < chunk.tuples.size()) {
+                const size_t available = (chunk.tuples.size() - position) / stride;
+                const size_t n = std::min(count - read, available);
+                if (tupleSize > 0) {
+                    std::copy(chunk.tuples.begin() + position,
+                            chunk.tuples.begin() + position + n * tupleSize, buffer + read * tupleSize);
+                }
+                position += n * stride;
+                read += n;
+                continue;
+            }
+            if (!chunk.error.empty()) {
+                if (read > 0) {
+                    break;
+                }
+                std::stringstream errorMessage;
+                errorMessage << chunk.error;
+                errorMessage << "cannot parse fact file " << baseName << "!\n";
+                window.clear();
+                currentChunk = 0;
+                throw std::invalid_argument(errorMessage.str());
+            }
+            ++currentChunk;
+            position = 0;
+        }
+        return read;
+    }
+
+    /**
+     * Split the next part of the mapping into a window of chunks, parse them in parallel and
+     * intern their new symbols in order; returns false if the file has been consumed.
+     *
+     * The chunks of the previous window are reused, so that their buffers are only grown once.
+     */
+    bool parseWindow() {
+        const char* end = data + size;
+        if (next == nullptr) {
+            next = data;
+            if (headers && data != nullptr) {
+                const char* newline = static_cast<const char*>(std::memchr(data, '\n', size));
+                next = newline == nullptr ? end : newline + 1;
+            }
+        }
+        currentChunk = 0;
+        position = 0;
+        if (failed || next == end) {
+            window.clear();
+            return false;
+        }
+
+        const size_t numChunks = std::max<size_t>(1, MAX_THREADS);
+        size_t used = 0;
+        window.resize(numChunks);
+        for (; used < numChunks && next != end; ++used) {
+            Chunk& chunk = window[used];
+            chunk.begin = next;
+            const char* target = next + std::min<size_t>(CHUNK_SIZE, end - next);
+            const char* newline = static_cast<const char*>(std::memchr(target, '\n', end - target));
+            next = newline == nullptr ? end : newline + 1;
+            chunk.end = next;
+            chunk.tuples.clear();
+            chunk.pending.clear();
+            chunk.error.clear();
+        }
+        window.resize(used);
+
+#pragma omp parallel for schedule(dynamic)
+        for (size_t i = 0; i < used; ++i) {
+            parseChunk(window[i]);
+        }
+
+        // intern new symbols in file order, up to the first malformed line
+        for (size_t i = 0; i < used; ++i) {
+            Chunk& chunk = window[i];
+            for (auto& cur : chunk.pending) {
+                chunk.tuples[cur.first] =
+                        symbolTable.unsafeLookup(std::string(cur.second.first, cur.second.second));
+            }
+            chunk.pending.clear();
+            if (!chunk.error.empty()) {
+                failed = true;
+                window.resize(i + 1);
+                break;
+            }
+        }
+        return true;
+    }
+
+    /** Parse all lines of a chunk; parsing stops at the first malformed line */
+    void parseChunk(Chunk& chunk) {
+        const size_t tupleSize = symbolMask.size();
+        const char* lineStart = chunk.begin;
+        while (lineStart < chunk.end) {
+            const char* lineEnd =
+                    static_cast<const char*>(std::memchr(lineStart, '\n', chunk.end - lineStart));
+            const char* next = lineEnd == nullptr ? chunk.end : lineEnd + 1;
+            if (lineEnd == nullptr) {
+                lineEnd = chunk.end;
+            }
+            // Handle Windows line endings on non-Windows systems
+            if (lineEnd > lineStart && *(lineEnd - 1) == '\r') {
+                --lineEnd;
+            }
+            const size_t base = chunk.tuples.size();
+            chunk.tuples.resize(base + std::max<size_t>(tupleSize, 1), 0);
+            const size_t pendingSize = chunk.pending.size();
+            if (!parseLine(lineStart, lineEnd, chunk, base)) {
+                chunk.tuples.resize(base);
+                chunk.pending.resize(pendingSize);
+                return;
+            }
+            lineStart = next;
+        }
+    }
+
+    /** Parse a single line into the tuple at offset base, returns false on malformed input */
+    bool parseLine(const char* lineStart, const char* lineEnd, Chunk& chunk, size_t base) {
+        const char* start = lineStart;
+        size_t columnsFilled = 0;
+        for (uint32_t column = 0; columnsFilled < arity; column++) {
+            if (start > lineEnd) {
+                std::stringstream errorMessage;
+                errorMessage << "Values missing in line " << getLineNumber(lineStart) << "; ";
+                chunk.error = errorMessage.str();
+                return false;
+            }
+            const char* end = findDelimiter(start, lineEnd);
+            const char* first = start;
+            start = end + delimiter.size();
+            if (column >= columnMap.size() || columnMap[column] < 0) {
+                continue;
+            }
+            ++columnsFilled;
+            const size_t position = columnMap[column];
+            const size_t slot = base + position;
+            if (symbolMask.at(position)) {
+                std::string element(first, end);
+                if (!symbolTable.findExisting(element, chunk.tuples[slot])) {
+                    chunk.pending.emplace_back(slot, std::make_pair(first, end));
+                }
+            } else if (!parseNumber(first, end, chunk.tuples[slot])) {
+                std::string element(first, end);
+                try {
+#if RAM_DOMAIN_SIZE == 64
+                    chunk.tuples[slot] = std::stoll(element);
+#else
+                    chunk.tuples[slot] = std::stoi(element);
+#endif
+                } catch (...) {
+                    std::stringstream errorMessage;
+                    errorMessage << "Error converting number <" + element + "> in column " << column + 1
+                                 << " in line " << getLineNumber(lineStart) << "; ";
+                    chunk.error = errorMessage.str();
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /** Find the next delimiter in [first, last), or last if there is none */
+    const char* findDelimiter(const char* first, const char* last) const {
+        if (delimiter.size() == 1) {
+            const void* found = std::memchr(first, delimiter[0], last - first);
+            return found == nullptr ? last : static_cast<const char*>(found);
+        }
+        return std::search(first, last, delimiter.begin(), delimiter.end());
+    }
+
+    /**
+     * Fast path for plain decimal numbers that cannot overflow; anything else is left to
+     * std::stoi so that accepted inputs and error messages stay the same.
+     */
+    static bool parseNumber(const char* first, const char* last, RamDomain& value) {
+        const bool negative = first != last && *first == '-';
+        if (negative) {
+            ++first;
+        }
+        if (first == last || last - first > std::numeric_limits<RamDomain>::digits10) {
+            return false;
+        }
+        RamDomain result = 0;
+        for (; first != last; ++first) {
+            if (*first < '0' || *first > '9') {
+                return false;
+            }
+            result = result * 10 + (*first - '0');
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+    /** Line number of a line for error messages, only computed when an error occurs */
+    size_t getLineNumber(const char* lineStart) const {
+        return std::count(data, lineStart, '\n') + (headers ? 0 : 1);
+    }
+
+    /** Number of bytes after which a chunk ends at the next line break */
+    static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+    std::string baseName;
+    const std::string delimiter;
+    const bool headers;
+    /** tuple position of each file column, -1 for columns that are skipped */
+    std::vector<int> columnMap;
+    int fd = -1;
+    const char* data = nullptr;
+    size_t size = 0;
+    /** start of the part of the mapping that has not been parsed yet, null before the first window */
+    const char* next = nullptr;
+    /** whether a malformed line has been found, which ends parsing */
+    bool failed = false;
+    /** chunks of the current window */
+    std::vector<Chunk> window;
+    size_t currentChunk = 0;
+    size_t position = 0;
+};
+
 class ReadCinCSVFactory : public ReadStreamFactory {
 public:
     std::unique_ptr<ReadStream> getReader(const std::vector<bool>& symbolMask, SymbolTable& symbolTable,
@@ -219,6 +587,13 @@ class ReadFileCSVFactory : public ReadStreamFactory {
 public:
     std::unique_ptr<ReadStream> getReader(const std::vector<bool>& symbolMask, SymbolTable& symbolTable,
             const IODirectives& ioDirectives, const bool provenance) override {
+        if (!ioDirectives.has("intermediate")) {
+            const std::string fileName = ReadFileCSV::getFileName(ioDirectives);
+            if (ReadFileMappedCSV::isMappable(fileName)) {
+                return std::make_unique<ReadFileMappedCSV>(
+                        fileName, symbolMask, symbolTable, ioDirectives, provenance);
+            }
+        }
         return std::make_unique<ReadFileCSV>(symbolMask, symbolTable, ioDirectives, provenance);
     }
     const std::string& getName() const override {
@@ -18,6 +18,7 @@
 #include "ReadStream.h"
 #include "SymbolTable.h"
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
 #include <sstream>
@@ -52,11 +53,27 @@ protected:
      * @return
      */
     std::unique_ptr<RamDomain[]> readNextTuple() override {
-        if (sqlite3_step(selectStatement) != SQLITE_ROW) {
+        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(arity + (isProvenance ? 2 : 0));
+        if (!readTuple(tuple.get())) {
             return nullptr;
         }
+        return tuple;
+    }
 
-        std::unique_ptr<RamDomain[]> tuple = std::make_unique<RamDomain[]>(arity + (isProvenance ? 2 : 0));
+    size_t readNextTuples(RamDomain* buffer, size_t count) override {
+        return fillBatch(buffer, count, [&](RamDomain* tuple) { return readTuple(tuple); });
+    }
+
+    /**
+     * Read the next row into tuple, which must hold symbolMask.size() elements.
+     *
+     * Returns false if no tuple was readable.
+     */
+    bool readTuple(RamDomain* tuple) {
+        if (sqlite3_step(selectStatement) != SQLITE_ROW) {
+            return false;
+        }
+        std::fill(tuple, tuple + symbolMask.size(), 0);
 
         uint32_t column;
         for (column = 0; column < arity; column++) {
@@ -82,7 +99,7 @@ protected:
             }
         }
 
-        return tuple;
+        return true;
     }
 
     void executeSQL(const std::string& sql) {
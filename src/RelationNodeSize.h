@@ -0,0 +1,93 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RelationNodeSize.h
+ *
+ * Node sizes of the b-trees storing relations, selected with the
+ * node-size pragma.
+ *
+ * The value of the pragma is a comma-separated list of entries
+ * <relation>=<bytes>; an entry consisting of <bytes> only applies to all
+ * relations without an entry of their own, e.g.
+ *
+ *   .pragma "node-size" "1024,edge=4096"
+ *
+ * The delta and new relations of a recursive relation use its node size.
+ ***********************************************************************/
+
+#pragma once
+
+#include "Global.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+class RelationNodeSize {
+public:
+    /** Node size of relations without a requested size, leaving the choice to the backend */
+    static constexpr size_t DEFAULT = 0;
+
+    /** The supported node sizes in bytes, all multiples of a cache line */
+    static const std::vector<size_t>& getSupportedSizes() {
+        static const std::vector<size_t> sizes = {128, 256, 512, 1024, 2048, 4096};
+        return sizes;
+    }
+
+    /** Obtain the node size requested for the given relation, or DEFAULT */
+    static size_t get(const std::string& relationName) {
+        const std::map<std::string, size_t> sizes = parse();
+        std::string name = relationName;
+        for (const std::string prefix : {"@delta_", "@new_"}) {
+            if (name.compare(0, prefix.size(), prefix) == 0) {
+                name = name.substr(prefix.size());
+            }
+        }
+        auto pos = sizes.find(name);
+        if (pos == sizes.end()) {
+            pos = sizes.find("");
+        }
+        return (pos == sizes.end()) ? DEFAULT : pos->second;
+    }
+
+    /** Check the value of the pragma, throws std::invalid_argument if it is malformed */
+    static void check() {
+        parse();
+    }
+
+private:
+    /** Map relation names to node sizes, the empty name to the size of all other relations */
+    static std::map<std::string, size_t> parse() {
+        std::map<std::string, size_t> res;
+        if (!Global::config().has("node-size")) {
+            return res;
+        }
+        for (const std::string& entry : splitString(Global::config().get("node-size"), ',')) {
+            const size_t split = entry.find('=');
+            const std::string name = (split == std::string::npos) ? "" : entry.substr(0, split);
+            const std::string size = (split == std::string::npos) ? entry : entry.substr(split + 1);
+            const auto& supported = getSupportedSizes();
+            if (size.empty() || !isNumber(size.c_str()) ||
+                    std::find(supported.begin(), supported.end(), std::stoul(size)) == supported.end()) {
+                throw std::invalid_argument("Invalid node size \"" + size + "\", supported sizes are " +
+                                            toString(join(supported, ", ")) + " bytes");
+            }
+            res[name] = std::stoul(size);
+        }
+        return res;
+    }
+};
+
+}  // end of namespace souffle
@@ -29,7 +29,11 @@ enum class RelationRepresentation {
     // btree data-structure
     BRIE,
     // equivalence relation
-    EQREL
+    EQREL,
+    // front-coded blocks of tuples
+    COMPRESSED,
+    // hash indexes, for relations only searched by equality
+    HASH
 };
 
 inline std::ostream& operator<<(std::ostream& os, RelationRepresentation structure) {
@@ -43,6 +47,12 @@ inline std::ostream& operator<<(std::ostream& os, RelationRepresentation structu
         case RelationRepresentation::EQREL:
             os << "eqrel";
             break;
+        case RelationRepresentation::COMPRESSED:
+            os << "compressed";
+            break;
+        case RelationRepresentation::HASH:
+            os << "hash";
+            break;
         case RelationRepresentation::DEFAULT:
         default:
             break;
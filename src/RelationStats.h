@@ -0,0 +1,174 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RelationStats.h
+ *
+ * Cardinality statistics of relations, i.e. the number of tuples and
+ * estimates of the number of distinct values of each column, which are
+ * recorded in profiles to guide the ordering of atoms.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamTypes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A HyperLogLog sketch estimating the number of distinct values inserted into it.
+ *
+ * Each value is hashed; the first bits of the hash select a register, which keeps the maximal
+ * position of the first one bit among the remaining bits. The estimate has a standard error of
+ * about 1.04 / sqrt(2^Precision) and is corrected by linear counting for small numbers of values.
+ */
+template <unsigned Precision = 12>
+class HyperLogLog {
+    static_assert(4 <= Precision && Precision <= 16, "unsupported precision");
+
+public:
+    /** The number of registers */
+    static constexpr std::size_t num_registers = std::size_t(1) << Precision;
+
+    HyperLogLog() : registers(num_registers, 0) {}
+
+    /** Add a value to the sketch */
+    void insert(RamDomain value) {
+        const uint64_t hash = mix(static_cast<uint64_t>(static_cast<uint32_t>(value)));
+        const std::size_t reg = hash >> (64 - Precision);
+        // the remaining bits, with a stop bit bounding the rank
+        const uint64_t rest = (hash << Precision) | (uint64_t(1) << (Precision - 1));
+        const uint8_t rank = 1 + countLeadingZeros(rest);
+        registers[reg] = std::max(registers[reg], rank);
+    }
+
+    /** Add all values of another sketch to this sketch */
+    void merge(const HyperLogLog& other) {
+        for (std::size_t i = 0; i < num_registers; ++i) {
+            registers[i] = std::max(registers[i], other.registers[i]);
+        }
+    }
+
+    /** Estimate the number of distinct values inserted */
+    std::size_t estimate() const {
+        const double m = num_registers;
+        double sum = 0;
+        std::size_t zeros = 0;
+        for (uint8_t cur : registers) {
+            sum += std::ldexp(1.0, -cur);
+            zeros += (cur == 0);
+        }
+        const double alpha = 0.7213 / (1 + 1.079 / m);
+        double res = alpha * m * m / sum;
+        if (res <= 2.5 * m && zeros != 0) {
+            res = m * std::log(m / zeros);
+        }
+        return static_cast<std::size_t>(res + 0.5);
+    }
+
+private:
+    static uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    static uint8_t countLeadingZeros(uint64_t x) {
+        uint8_t res = 0;
+        for (uint64_t bit = uint64_t(1) << 63; (x & bit) == 0; bit >>= 1) {
+            ++res;
+        }
+        return res;
+    }
+
+    // the maximal rank observed per register
+    std::vector<uint8_t> registers;
+};
+
+/**
+ * The cardinality statistics of a relation: its number of tuples and the estimated number of
+ * distinct values of each of its columns.
+ */
+class RelationStats {
+public:
+    RelationStats() = default;
+
+    RelationStats(std::size_t cardinality, std::vector<std::size_t> distinctValues)
+            : cardinality(cardinality), distinctValues(std::move(distinctValues)) {}
+
+    /**
+     * Collect the statistics of the tuples in the given range, each of which is indexable by the
+     * columns 0 .. arity-1. A single pass updates one sketch per column.
+     */
+    template <typename Iter>
+    static RelationStats extractFrom(std::size_t arity, Iter begin, Iter end) {
+        std::vector<HyperLogLog<>> sketches(arity);
+        std::size_t cardinality = 0;
+        for (Iter it = begin; it != end; ++it) {
+            const auto& tuple = *it;
+            for (std::size_t i = 0; i < arity; ++i) {
+                sketches[i].insert(tuple[i]);
+            }
+            ++cardinality;
+        }
+        std::vector<std::size_t> distinctValues;
+        for (const auto& cur : sketches) {
+            // an estimate never exceeds the number of tuples, nor is it zero for a non-empty column
+            distinctValues.push_back(std::max<std::size_t>(
+                    std::min(cur.estimate(), cardinality), cardinality == 0 ? 0 : 1));
+        }
+        return RelationStats(cardinality, std::move(distinctValues));
+    }
+
+    /** Get the number of tuples */
+    std::size_t getCardinality() const {
+        return cardinality;
+    }
+
+    /** Get the number of columns */
+    std::size_t getArity() const {
+        return distinctValues.size();
+    }
+
+    /** Get the estimated number of distinct values of a column */
+    std::size_t getDistinctValues(std::size_t column) const {
+        return distinctValues[column];
+    }
+
+    /**
+     * Estimate the number of tuples matching a search binding the given columns, assuming that
+     * the values of the columns are independent and uniformly distributed.
+     */
+    double getEstimatedMatches(const std::vector<bool>& bound) const {
+        double res = cardinality;
+        for (std::size_t i = 0; i < bound.size() && i < distinctValues.size(); ++i) {
+            if (bound[i] && distinctValues[i] > 0) {
+                res /= distinctValues[i];
+            }
+        }
+        return std::min<double>(cardinality, std::max(res, 1.0));
+    }
+
+private:
+    // the number of tuples
+    std::size_t cardinality = 0;
+
+    // the estimated number of distinct values per column
+    std::vector<std::size_t> distinctValues;
+};
+
+}  // end of namespace souffle
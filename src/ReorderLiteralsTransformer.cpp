@@ -25,7 +25,9 @@
 #include "AstTranslationUnit.h"
 #include "AstVisitor.h"
 #include "Global.h"
+#include "RelationStats.h"
 #include <cmath>
+#include <map>
 #include <set>
 #include <string>
 #include <utility>
@@ -42,6 +44,22 @@ inline bool isProposition(const AstAtom* atom) {
     return atom->getArguments().empty();
 }
 
+/**
+ * Checks whether an argument is bound, i.e. whether all its variables are bound.
+ */
+bool isBoundArgument(const AstArgument* arg, const std::set<std::string>& boundVariables) {
+    bool isBound = true;
+
+    visitDepthFirst(*arg, [&](const AstVariable& var) {
+        if (boundVariables.find(var.getName()) == boundVariables.end()) {
+            // found an unbound variable, so argument is unbound
+            isBound = false;
+        }
+    });
+
+    return isBound;
+}
+
 /**
  * Counts the number of bound arguments in a given atom.
  */
@@ -49,17 +67,7 @@ unsigned int numBoundArguments(const AstAtom* atom, const std::set<std::string>&
     int count = 0;
 
     for (const AstArgument* arg : atom->getArguments()) {
-        // argument is bound iff all contained variables are bound
-        bool isBound = true;
-
-        visitDepthFirst(*arg, [&](const AstVariable& var) {
-            if (boundVariables.find(var.getName()) == boundVariables.end()) {
-                // found an unbound variable, so argument is unbound
-                isBound = false;
-            }
-        });
-
-        if (isBound) {
+        if (isBoundArgument(arg, boundVariables)) {
             count++;
         }
     }
@@ -379,9 +387,33 @@ bool ReorderLiteralsTransformer::transform(AstTranslationUnit& translationUnit)
         // parse supplied profile information
         auto* profileUse = translationUnit.getAnalysis<AstProfileUse>();
 
+        // the statistics of the relations in the profile; columns without recorded distinct values
+        // are assumed to have |R|^(1/arity) of them, such that each bound argument is equally selective
+        std::map<AstRelationIdentifier, RelationStats> statistics;
+        auto getStatistics = [&](const AstAtom* atom) -> const RelationStats& {
+            const AstRelationIdentifier& name = atom->getName();
+            auto pos = statistics.find(name);
+            if (pos == statistics.end()) {
+                size_t size = profileUse->getRelationSize(name);
+                size_t arity = atom->getArity();
+                std::vector<size_t> distinctValues;
+                for (size_t i = 0; i < arity; i++) {
+                    if (profileUse->hasDistinctValues(name, i)) {
+                        distinctValues.push_back(profileUse->getDistinctValues(name, i));
+                    } else if (arity == 1) {
+                        distinctValues.push_back(size);
+                    } else {
+                        distinctValues.push_back(static_cast<size_t>(std::pow(size, 1.0 / arity) + 0.5));
+                    }
+                }
+                pos = statistics.emplace(name, RelationStats(size, distinctValues)).first;
+            }
+            return pos->second;
+        };
+
         auto profilerSips = [&](std::vector<AstAtom*> atoms, const std::set<std::string>& boundVariables) {
             // Goal: reorder based on the given profiling information
-            // Metric: cost(atom_R) = log(|atom_R|) * #free/#args
+            // Metric: cost(atom_R) = log(estimated number of tuples of R matching the bound arguments)
             //         - exception: propositions are prioritised
 
             double currOptimalVal = -1;
@@ -401,12 +433,12 @@ bool ReorderLiteralsTransformer::transform(AstTranslationUnit& translationUnit)
                     return i;
                 }
 
-                // calculate log(|R|) * #free/#args
-                int numBound = numBoundArguments(currAtom, boundVariables);
-                int numArgs = currAtom->getArity();
-                int numFree = numArgs - numBound;
-                double value = log(profileUse->getRelationSize(currAtom->getName()));
-                value *= (numFree * 1.0) / numArgs;
+                // calculate log(|R| / product of the distinct values of the bound columns)
+                std::vector<bool> bound;
+                for (const AstArgument* arg : currAtom->getArguments()) {
+                    bound.push_back(isBoundArgument(arg, boundVariables));
+                }
+                double value = log(getStatistics(currAtom).getEstimatedMatches(bound));
 
                 if (!set || value < currOptimalVal) {
                     set = true;
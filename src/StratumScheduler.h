@@ -0,0 +1,269 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file StratumScheduler.h
+ *
+ * A scheduler evaluating independent strata of a program concurrently.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace souffle {
+
+/**
+ * Evaluates strata on a pool of worker threads along the dependency DAG between them.
+ *
+ * A stratum becomes ready once all its predecessors have finished and is pushed onto the queue of
+ * the worker that finished the last predecessor, such that it runs while its inputs are still in
+ * the cache of that worker. Workers take strata from the back of their own queue and steal from the
+ * front of the queues of other workers. Strata are coarse-grained, hence the queues share a lock.
+ *
+ * The parallel loops within a stratum share the threads with the other running strata: the OpenMP
+ * team size of a stratum is chosen when it starts. While the resident memory of the process exceeds
+ * the memory limit, no further stratum is started as long as another one is still running.
+ *
+ * Releases, e.g. dropping a relation, are run as soon as all strata using the relation finished.
+ */
+class StratumScheduler {
+public:
+    StratumScheduler() : memoryLimit(getPhysicalMemory() / 4 * 3) {}
+
+    /** Add a stratum evaluated after the given distinct strata, which must have been added before */
+    size_t addStratum(std::function<void()> body, const std::vector<size_t>& predecessors) {
+        const size_t id = strata.size();
+        strata.emplace_back();
+        strata.back().body = std::move(body);
+        strata.back().pending = predecessors.size();
+        for (size_t predecessor : predecessors) {
+            assert(predecessor < id && "strata not added in topological order");
+            strata[predecessor].successors.push_back(id);
+        }
+        return id;
+    }
+
+    /** Add an action executed once all the given distinct strata have finished */
+    void addRelease(std::function<void()> action, const std::vector<size_t>& users) {
+        const size_t id = releases.size();
+        releases.push_back({std::move(action), users.size()});
+        for (size_t user : users) {
+            assert(user < strata.size() && "unknown stratum");
+            strata[user].releases.push_back(id);
+        }
+    }
+
+    /** Set the resident memory in bytes above which strata are not started concurrently, 0 for none */
+    void setMemoryLimit(size_t bytes) {
+        memoryLimit = bytes;
+    }
+
+    /**
+     * Evaluate all strata with the given number of threads. If a stratum throws an exception, no
+     * further strata are started and the first exception is rethrown once the running ones finished.
+     */
+    void run(size_t numThreads) {
+        threads = std::max<size_t>(1, numThreads);
+        const size_t workers = std::max<size_t>(1, std::min(threads, strata.size()));
+        queues.assign(workers, std::deque<size_t>());
+        size_t worker = 0;
+        for (size_t i = 0; i < strata.size(); ++i) {
+            if (strata[i].pending == 0) {
+                queues[worker++ % workers].push_front(i);
+                ++queued;
+            }
+        }
+        for (auto& release : releases) {
+            if (release.pending == 0) {
+                release.action();
+            }
+        }
+
+#ifdef _OPENMP
+        const int teamSize = omp_get_max_threads();
+#endif
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < workers; ++i) {
+            pool.emplace_back([this, i]() { work(i); });
+        }
+        work(0);
+        for (auto& thread : pool) {
+            thread.join();
+        }
+#ifdef _OPENMP
+        omp_set_num_threads(teamSize);
+#endif
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /** Obtain the resident memory of the process in bytes, or 0 if it is unknown */
+    static size_t getResidentMemory() {
+#ifdef __linux__
+        size_t size = 0;
+        size_t resident = 0;
+        std::ifstream statm("/proc/self/statm");
+        if (statm >> size >> resident) {
+            return resident * sysconf(_SC_PAGESIZE);
+        }
+#endif
+        return 0;
+    }
+
+    /** Obtain the physical memory of the machine in bytes, or 0 if it is unknown */
+    static size_t getPhysicalMemory() {
+        const long pages = sysconf(_SC_PHYS_PAGES);
+        const long pageSize = sysconf(_SC_PAGESIZE);
+        return (pages > 0 && pageSize > 0) ? size_t(pages) * size_t(pageSize) : 0;
+    }
+
+private:
+    struct Stratum {
+        std::function<void()> body;
+        std::vector<size_t> successors;
+        std::vector<size_t> releases;
+        /** Number of unfinished predecessors */
+        size_t pending = 0;
+    };
+
+    struct Release {
+        std::function<void()> action;
+        /** Number of unfinished users */
+        size_t pending;
+    };
+
+    /** Evaluate strata on the given worker until all strata finished */
+    void work(size_t worker) {
+        std::unique_lock<std::mutex> guard(lock);
+        while (finished < strata.size() && !(error && running == 0)) {
+            size_t id;
+            if (!take(worker, id)) {
+                idle.wait(guard);
+                continue;
+            }
+            ++running;
+            const size_t team = threads / std::max<size_t>(1, std::min(threads, running + queued));
+            guard.unlock();
+
+#ifdef _OPENMP
+            omp_set_num_threads(team);
+#endif
+            std::exception_ptr failure;
+            try {
+                strata[id].body();
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            guard.lock();
+            --running;
+            ++finished;
+            if (failure && !error) {
+                error = failure;
+            }
+            // push the successors such that the first of them is taken next
+            const auto& successors = strata[id].successors;
+            for (auto it = successors.rbegin(); it != successors.rend(); ++it) {
+                if (--strata[*it].pending == 0) {
+                    queues[worker].push_back(*it);
+                    ++queued;
+                }
+            }
+            std::vector<size_t> expired;
+            for (size_t release : strata[id].releases) {
+                if (--releases[release].pending == 0) {
+                    expired.push_back(release);
+                }
+            }
+            idle.notify_all();
+
+            if (!expired.empty()) {
+                guard.unlock();
+                for (size_t release : expired) {
+                    releases[release].action();
+                }
+                guard.lock();
+                // released memory may admit further strata
+                idle.notify_all();
+            }
+        }
+    }
+
+    /** Take a ready stratum for the given worker, own strata first; the lock must be held */
+    bool take(size_t worker, size_t& id) {
+        if (error || queued == 0) {
+            return false;
+        }
+        if (running > 0 && memoryLimit > 0 && getResidentMemory() > memoryLimit) {
+            return false;
+        }
+        if (!queues[worker].empty()) {
+            id = queues[worker].back();
+            queues[worker].pop_back();
+            --queued;
+            return true;
+        }
+        for (size_t i = 1; i < queues.size(); ++i) {
+            auto& victim = queues[(worker + i) % queues.size()];
+            if (!victim.empty()) {
+                id = victim.front();
+                victim.pop_front();
+                --queued;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<Stratum> strata;
+    std::vector<Release> releases;
+
+    /** Resident memory in bytes above which strata are not started concurrently */
+    size_t memoryLimit;
+
+    /** Number of threads shared by the running strata */
+    size_t threads = 1;
+
+    /** Ready strata of each worker */
+    std::vector<std::deque<size_t>> queues;
+
+    /** Guards the queues and counters below */
+    std::mutex lock;
+
+    /** Signalled when a stratum finished */
+    std::condition_variable idle;
+
+    size_t queued = 0;
+    size_t running = 0;
+    size_t finished = 0;
+
+    /** The first exception thrown by a stratum */
+    std::exception_ptr error;
+};
+
+}  // end of namespace souffle
@@ -15,6 +15,9 @@
  ***********************************************************************/
 
 #pragma once
+
+#include "ParallelUtils.h"
+
 #include <iostream>
 
 #include <stdio.h>
@@ -34,30 +37,20 @@ public:
         return &singleton;
     }
 
-    /* lookup a string */
+    /* lookup a string, only the bucket of the string is locked */
     inline const char* lookup(const char* str) {
         size_t i = hash(str);
+        auto lease = locks[i % LOCKS].acquire();
+        (void)lease;  // avoid warning;
 
-        const char* res = nullptr;
-
-        {
-            if (hashtab[i] == nullptr) {
-                char* nstr = strdup(str);
-                hashtab[i] = new hashentry(nstr);
-                res = nstr;
-            } else {
-                for (hashentry* p = hashtab[i]; p != nullptr && res == NULL; p = p->next) {
-                    if (!strcmp(p->str, str)) {
-                        res = p->str;
-                    }
-                }
-                char* nstr = strdup(str);
-                hashtab[i] = new hashentry(nstr, hashtab[i]);
-                res = nstr;
+        for (hashentry* p = hashtab[i]; p != nullptr; p = p->next) {
+            if (!strcmp(p->str, str)) {
+                return p->str;
             }
         }
-
-        return res;
+        char* nstr = strdup(str);
+        hashtab[i] = new hashentry(nstr, hashtab[i]);
+        return nstr;
     }
 
 private:
@@ -69,6 +62,12 @@ private:
     };
     static hashentry* hashtab[HASH_SIZE];
 
+    /* Number of locks guarding the buckets of the hash table */
+    static constexpr size_t LOCKS = 1024;
+
+    /* Locks guarding the buckets, bucket i is guarded by lock i % LOCKS */
+    Lock locks[LOCKS];
+
     /* Hash function */
     inline size_t hash(const char* str) {
         size_t hash = 5381;
@@ -25,8 +25,10 @@
 #include <thread>
 #endif
 
+#include <array>
+#include <atomic>
 #include <cassert>
-#include <deque>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
 #include <string>
@@ -58,6 +60,9 @@ private:
         UNSAFE_RESOLVE = 9
     };
 
+    /** A lock to synchronize parallel accesses to the caches */
+    mutable Lock access;
+
     mutable std::unordered_map<std::string, size_t> strToNumCache;
     mutable std::unordered_map<size_t, std::string> numToStrCache;
 
@@ -175,36 +180,200 @@ public:
 #endif
 
 private:
-    /** A lock to synchronize parallel accesses */
-    mutable Lock access;
+    /**
+     * Append-only array of symbols.
+     *
+     * Symbols are stored in blocks of doubling size which are never moved, so resolving an index is wait-free
+     * while other threads append. An index is only handed out once its symbol is stored. Each slot is marked
+     * ready once its symbol is stored, and the size covers the prefix of ready slots, which is advanced by
+     * whichever append completes it.
+     */
+    class SymbolStore {
+    public:
+        SymbolStore() {
+            for (auto& block : blocks) {
+                block.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        SymbolStore(const SymbolStore& other) : SymbolStore() {
+            for (size_t i = 0; i < other.size(); ++i) {
+                append(other[i]);
+            }
+        }
+
+        SymbolStore(SymbolStore&& other) noexcept : SymbolStore() {
+            swap(other);
+        }
+
+        ~SymbolStore() {
+            clear();
+        }
+
+        SymbolStore& operator=(const SymbolStore& other) {
+            if (this != &other) {
+                clear();
+                for (size_t i = 0; i < other.size(); ++i) {
+                    append(other[i]);
+                }
+            }
+            return *this;
+        }
+
+        SymbolStore& operator=(SymbolStore&& other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        /** Append a symbol and return its index */
+        size_t append(const std::string& symbol) {
+            size_t index = reserved.fetch_add(1, std::memory_order_relaxed);
+            size_t block = getBlock(index);
+            Slot* slots = blocks[block].load(std::memory_order_acquire);
+            if (slots == nullptr) {
+                // concurrent appends may race to allocate the block, the losers discard theirs
+                Slot* fresh = new Slot[FIRST_BLOCK_SIZE << block];
+                if (blocks[block].compare_exchange_strong(slots, fresh, std::memory_order_acq_rel)) {
+                    slots = fresh;
+                } else {
+                    delete[] fresh;
+                }
+            }
+            Slot& slot = slots[getOffset(index)];
+            slot.symbol = symbol;
+            slot.ready.store(true);
+
+            // extend the published prefix over this and any following ready slots
+            size_t published = count.load();
+            while (published < reserved.load(std::memory_order_relaxed) && isReady(published)) {
+                if (count.compare_exchange_weak(published, published + 1)) {
+                    ++published;
+                }
+            }
+            return index;
+        }
+
+        /** Return the symbol of an index */
+        const std::string& operator[](size_t index) const {
+            return blocks[getBlock(index)].load(std::memory_order_acquire)[getOffset(index)].symbol;
+        }
+
+        /** Return the number of symbols */
+        size_t size() const {
+            return count.load(std::memory_order_acquire);
+        }
+
+    private:
+        static constexpr size_t FIRST_BLOCK_BITS = 10;
+        static constexpr size_t FIRST_BLOCK_SIZE = 1ul << FIRST_BLOCK_BITS;
+        static constexpr size_t MAX_BLOCKS = 64 - FIRST_BLOCK_BITS;
+
+        /** Slot of a symbol, ready once the symbol is stored */
+        struct Slot {
+            std::string symbol;
+            std::atomic<bool> ready{false};
+        };
+
+        /** Blocks holding the symbols, block i holds FIRST_BLOCK_SIZE << i symbols */
+        std::array<std::atomic<Slot*>, MAX_BLOCKS> blocks;
+
+        /** Number of published symbols, all slots below it are ready */
+        std::atomic<size_t> count{0};
+
+        /** Number of symbols whose slots have been claimed by append */
+        std::atomic<size_t> reserved{0};
+
+        /** Whether the symbol of a claimed index is stored */
+        bool isReady(size_t index) const {
+            const Slot* slots = blocks[getBlock(index)].load(std::memory_order_acquire);
+            return slots != nullptr && slots[getOffset(index)].ready.load();
+        }
+
+        static size_t getBlock(size_t index) {
+            return (63 - __builtin_clzll(index + FIRST_BLOCK_SIZE)) - FIRST_BLOCK_BITS;
+        }
+
+        static size_t getOffset(size_t index) {
+            size_t position = index + FIRST_BLOCK_SIZE;
+            return position - (1ul << (63 - __builtin_clzll(position)));
+        }
+
+        void clear() {
+            for (auto& block : blocks) {
+                delete[] block.load(std::memory_order_relaxed);
+                block.store(nullptr, std::memory_order_relaxed);
+            }
+            count.store(0, std::memory_order_relaxed);
+            reserved.store(0, std::memory_order_relaxed);
+        }
+
+        void swap(SymbolStore& other) {
+            for (size_t i = 0; i < MAX_BLOCKS; ++i) {
+                Slot* block = blocks[i].load(std::memory_order_relaxed);
+                blocks[i].store(other.blocks[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                other.blocks[i].store(block, std::memory_order_relaxed);
+            }
+            size_t size = count.load(std::memory_order_relaxed);
+            count.store(other.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            other.count.store(size, std::memory_order_relaxed);
+            size_t claimed = reserved.load(std::memory_order_relaxed);
+            reserved.store(other.reserved.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            other.reserved.store(claimed, std::memory_order_relaxed);
+        }
+    };
+
+    /** Shard of the mapping from strings to indices, guarded by its own lock */
+    struct Shard {
+        /** A lock to synchronize parallel accesses to the shard */
+        mutable Lock access;
+
+        /** Map strings to indices. */
+        std::unordered_map<std::string, size_t> strToNum;
+
+        Shard() = default;
+        Shard(const Shard& other) : strToNum(other.strToNum) {}
+        Shard& operator=(const Shard& other) {
+            strToNum = other.strToNum;
+            return *this;
+        }
+    };
+
+    /** Number of shards, a power of two */
+    static constexpr size_t SHARDS = 64;
 
     /** Map indices to strings. */
-    std::deque<std::string> numToStr;
+    SymbolStore numToStr;
+
+    /** Map strings to indices, sharded by the hash of the string. */
+    std::array<Shard, SHARDS> shards;
 
-    /** Map strings to indices. */
-    std::unordered_map<std::string, size_t> strToNum;
+    /** Return the shard responsible for a symbol */
+    Shard& getShard(const std::string& symbol) {
+        return shards[std::hash<std::string>()(symbol) & (SHARDS - 1)];
+    }
+
+    const Shard& getShard(const std::string& symbol) const {
+        return shards[std::hash<std::string>()(symbol) & (SHARDS - 1)];
+    }
 
     /** Convenience method to place a new symbol in the table, if it does not exist, and return the index of
      * it. */
     inline size_t newSymbolOfIndex(const std::string& symbol) {
-        size_t index;
-        auto it = strToNum.find(symbol);
-        if (it == strToNum.end()) {
-            index = numToStr.size();
-            strToNum[symbol] = index;
-            numToStr.push_back(symbol);
-        } else {
-            index = it->second;
+        Shard& shard = getShard(symbol);
+        auto lease = shard.access.acquire();
+        (void)lease;  // avoid warning;
+        auto it = shard.strToNum.find(symbol);
+        if (it != shard.strToNum.end()) {
+            return it->second;
         }
+        size_t index = numToStr.append(symbol);
+        shard.strToNum[symbol] = index;
         return index;
     }
 
     /** Convenience method to place a new symbol in the table, if it does not exist. */
     inline void newSymbol(const std::string& symbol) {
-        if (strToNum.find(symbol) == strToNum.end()) {
-            strToNum[symbol] = numToStr.size();
-            numToStr.push_back(symbol);
-        }
+        newSymbolOfIndex(symbol);
     }
 
 public:
@@ -212,16 +381,16 @@ public:
     SymbolTable() = default;
 
     /** Copy constructor, performs a deep copy. */
-    SymbolTable(const SymbolTable& other) : numToStr(other.numToStr), strToNum(other.strToNum) {}
+    SymbolTable(const SymbolTable& other) : numToStr(other.numToStr), shards(other.shards) {}
 
     /** Copy constructor for r-value reference. */
-    SymbolTable(SymbolTable&& other) noexcept {
-        numToStr.swap(other.numToStr);
-        strToNum.swap(other.strToNum);
+    SymbolTable(SymbolTable&& other) noexcept : numToStr(std::move(other.numToStr)) {
+        for (size_t i = 0; i < SHARDS; ++i) {
+            shards[i].strToNum.swap(other.shards[i].strToNum);
+        }
     }
 
     SymbolTable(std::initializer_list<std::string> symbols) {
-        strToNum.reserve(symbols.size());
         for (const auto& symbol : symbols) {
             newSymbol(symbol);
         }
@@ -236,14 +405,16 @@ public:
             return *this;
         }
         numToStr = other.numToStr;
-        strToNum = other.strToNum;
+        shards = other.shards;
         return *this;
     }
 
     /** Assignment operator for r-value references. */
     SymbolTable& operator=(SymbolTable&& other) noexcept {
-        numToStr.swap(other.numToStr);
-        strToNum.swap(other.strToNum);
+        numToStr = std::move(other.numToStr);
+        for (size_t i = 0; i < SHARDS; ++i) {
+            shards[i].strToNum.swap(other.shards[i].strToNum);
+        }
         return *this;
     }
 
@@ -255,11 +426,7 @@ public:
             return cacheLookup(symbol, LOOKUP);
         } else
 #endif
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
             return static_cast<RamDomain>(newSymbolOfIndex(symbol));
-        }
     }
 
     /** Finds the index of a symbol in the table, giving an error if it's not found */
@@ -270,10 +437,11 @@ public:
         } else
 #endif
         {
-            auto lease = access.acquire();
+            const Shard& shard = getShard(symbol);
+            auto lease = shard.access.acquire();
             (void)lease;  // avoid warning;
-            auto result = strToNum.find(symbol);
-            if (result == strToNum.end()) {
+            auto result = shard.strToNum.find(symbol);
+            if (result == shard.strToNum.end()) {
                 std::cerr << "Error string not found in call to SymbolTable::lookupExisting.\n";
                 exit(1);
             }
@@ -281,8 +449,27 @@ public:
         }
     }
 
+    /** Find the index of a symbol in the table without inserting it, returns false if it is not
+     * there. Only the shard of the symbol is locked, so probes can run concurrently. */
+    bool findExisting(const std::string& symbol, RamDomain& index) const {
+#ifdef USE_MPI
+        if (mpi::commRank() != 0) {
+            return false;
+        }
+#endif
+        const Shard& shard = getShard(symbol);
+        auto lease = shard.access.acquire();
+        (void)lease;  // avoid warning;
+        auto result = shard.strToNum.find(symbol);
+        if (result == shard.strToNum.end()) {
+            return false;
+        }
+        index = static_cast<RamDomain>(result->second);
+        return true;
+    }
+
     /** Find the index of a symbol in the table, inserting a new symbol if it does not exist there
-     * already. */
+     * already. Kept for compatibility, lookups only lock the shard of the symbol. */
     RamDomain unsafeLookup(const std::string& symbol) {
 #ifdef USE_MPI
         if (mpi::commRank() != 0) {
@@ -293,7 +480,7 @@ public:
     }
 
     /** Find a symbol in the table by its index, note that this gives an error if the index is out of
-     * bounds.
+     * bounds. This operation is wait-free.
      */
     const std::string& resolve(const RamDomain index) const {
 #ifdef USE_MPI
@@ -302,8 +489,6 @@ public:
         } else
 #endif
         {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
             auto pos = static_cast<size_t>(index);
             if (pos >= size()) {
                 // TODO: use different error reporting here!!
@@ -346,9 +531,6 @@ public:
         } else
 #endif
         {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
-            strToNum.reserve(size() + symbols.size());
             for (auto& symbol : symbols) {
                 newSymbol(symbol);
             }
@@ -364,11 +546,7 @@ public:
             mpi::send(symbol, 0, INSERT_STRING);
         } else
 #endif
-        {
-            auto lease = access.acquire();
-            (void)lease;  // avoid warning;
             newSymbol(symbol);
-        }
     }
 
     /** Print the symbol table to the given stream. */
@@ -380,41 +558,29 @@ public:
 #endif
         {
             out << "SymbolTable: {\n\t";
-            out << join(strToNum, "\n\t",
-                           [](std::ostream& out, const std::pair<std::string, std::size_t>& entry) {
-                               out << entry.first << "\t => " << entry.second;
-                           })
-                << "\n";
+            for (size_t i = 0; i < size(); ++i) {
+                if (i > 0) {
+                    out << "\n\t";
+                }
+                out << numToStr[i] << "\t => " << i;
+            }
+            out << "\n";
             out << "}\n";
         }
     }
 
     /** Check if the symbol table contains a string */
     bool contains(const std::string& symbol) const {
-        auto lease = access.acquire();
+        const Shard& shard = getShard(symbol);
+        auto lease = shard.access.acquire();
         (void)lease;  // avoid warning;
-        auto result = strToNum.find(symbol);
-        if (result == strToNum.end()) {
-            return false;
-        } else {
-            return true;
-        }
+        return shard.strToNum.find(symbol) != shard.strToNum.end();
     }
 
     /** Check if the symbol table contains an index */
     bool contains(const RamDomain index) const {
-        auto lease = access.acquire();
-        (void)lease;  // avoid warning;
         auto pos = static_cast<size_t>(index);
-        if (pos >= size()) {
-            return false;
-        } else {
-            return true;
-        }
-    }
-
-    Lock::Lease acquireLock() const {
-        return access.acquire();
+        return pos < size();
     }
 
     /** Stream operator, used as a convenience for print. */
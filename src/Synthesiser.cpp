@@ -26,6 +26,7 @@
 #include "RamOperation.h"
 #include "RamProgram.h"
 #include "RamRelation.h"
+#include "RamStratumAnalysis.h"
 #include "RamTranslationUnit.h"
 #include "RamVisitor.h"
 #include "RelationRepresentation.h"
@@ -179,6 +180,10 @@ std::set<const RamRelation*> Synthesiser::getReferencedRelations(const RamOperat
             res.insert(&provExists->getRelation());
         } else if (auto project = dynamic_cast<const RamProject*>(&node)) {
             res.insert(&project->getRelation());
+        } else if (auto join = dynamic_cast<const RamLeapfrogJoin*>(&node)) {
+            for (const RamRelation* rel : join->getRelations()) {
+                res.insert(rel);
+            }
         }
     });
     return res;
@@ -384,6 +389,13 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visitAdaptiveQuery(const RamAdaptiveQuery& adaptive, std::ostream& out) override {
+            // the join order is fixed at compile time: emit the first alternative only
+            PRINT_BEGIN_COMMENT(out);
+            visit(adaptive.getQueries()[0], out);
+            PRINT_END_COMMENT(out);
+        }
+
         void visitMerge(const RamMerge& merge, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             if (merge.getTargetRelation().getRepresentation() == RelationRepresentation::EQREL) {
@@ -399,8 +411,9 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
         void visitClear(const RamClear& clear, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
+            // the relation is refilled in the next iteration => keep its memory
             out << synthesiser.getRelationName(clear.getRelation()) << "->"
-                << "purge();\n";
+                << "reset();\n";
             PRINT_END_COMMENT(out);
         }
 
@@ -423,6 +436,21 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visitLogStatistics(const RamLogStatistics& statistics, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const auto& messages = statistics.getMessages();
+            const std::string& relName = synthesiser.getRelationName(statistics.getRelation());
+            out << "{\n";
+            out << "const auto stats = RelationStats::extractFrom(" << messages.size() << "," << relName
+                << "->begin()," << relName << "->end());\n";
+            for (size_t i = 0; i < messages.size(); ++i) {
+                out << "ProfileEventSingleton::instance().makeQuantityEvent( R\"(" << messages[i] << ")\",";
+                out << "stats.getDistinctValues(" << i << "),iter);\n";
+            }
+            out << "}\n";
+            PRINT_END_COMMENT(out);
+        }
+
         // -- control flow statements --
 
         void visitSequence(const RamSequence& seq, std::ostream& out) override {
@@ -883,6 +911,40 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visitLeapfrogJoin(const RamLeapfrogJoin& leapfrog, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            auto identifier = leapfrog.getTupleId();
+            auto joinName = "join" + std::to_string(identifier);
+            auto relations = leapfrog.getRelations();
+
+            out << "LeapfrogTrieJoin " << joinName << "(" << leapfrog.getNumVariables() << ");\n";
+
+            // add a trie over the index of each relation ordered by the variables of its columns
+            for (size_t i = 0; i < relations.size(); ++i) {
+                const auto& rel = *relations[i];
+                auto order = leapfrog.getOrder(i);
+                const MinIndexSelection::LexOrder lexOrder(order.begin(), order.end());
+                auto indNum = isa->getIndexes(rel).getOrderNum(lexOrder);
+                auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + ")";
+
+                out << joinName << ".addIterator(makeIndexTrieIterator(";
+                out << "[&](const RamDomain* low, const RamDomain* high) {";
+                out << "return " << synthesiser.getRelationName(rel) << "->lowerUpperRange_" << indNum;
+                out << "(low, high, " << ctxName << ");}, ";
+                out << "{" << join(order) << "}, " << rel.getArity() << "), ";
+                out << "{" << join(leapfrog.getSortedVariables(i)) << "});\n";
+            }
+
+            out << "while (" << joinName << ".next()) {\n";
+            out << "const RamDomain* env" << identifier << " = " << joinName << ".getBinding();\n";
+
+            // continue with condition checks and nested body
+            visitTupleOperation(leapfrog, out);
+
+            out << "}\n";
+            PRINT_END_COMMENT(out);
+        }
+
         void visitIndexAggregate(const RamIndexAggregate& aggregate, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             // get some properties
@@ -1786,8 +1848,8 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         const std::string& raw_name = rel.getName();
 
         bool isProvInfo = raw_name.find("@info") != std::string::npos;
-        auto relationType = SynthesiserRelation::getSynthesiserRelation(
-                rel, idxAnalysis->getIndexes(rel), Global::config().has("provenance") && !isProvInfo);
+        auto relationType = SynthesiserRelation::getSynthesiserRelation(rel, idxAnalysis->getIndexes(rel),
+                idxAnalysis->getRepresentation(rel), Global::config().has("provenance") && !isProvInfo);
 
         generateRelationTypeStruct(os, std::move(relationType));
     });
@@ -1906,8 +1968,8 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         // ensure that the type of the new knowledge is the same as that of the delta knowledge
         bool isDelta = rel.isTemp() && raw_name.find("@delta") != std::string::npos;
         bool isProvInfo = raw_name.find("@info") != std::string::npos;
-        auto relationType = SynthesiserRelation::getSynthesiserRelation(
-                rel, idxAnalysis->getIndexes(rel), Global::config().has("provenance") && !isProvInfo);
+        auto relationType = SynthesiserRelation::getSynthesiserRelation(rel, idxAnalysis->getIndexes(rel),
+                idxAnalysis->getRepresentation(rel), Global::config().has("provenance") && !isProvInfo);
         tempType = isDelta ? relationType->getTypeName() : tempType;
         const std::string& type = (rel.isTemp()) ? tempType : relationType->getTypeName();
 
@@ -2066,21 +2128,43 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     }
 
     // Set up stratum
-    visitDepthFirst(*(prog.getMain()), [&](const RamStratum& stratum) {
-        os << "/* BEGIN STRATUM " << stratum.getIndex() << " */\n";
-        if (Global::config().has("engine")) {
-            // go to the stratum with the max value for int as a suffix if calling the master stratum
-            auto i = stratum.getIndex();
-            os << "STRATUM_" << i << ":\n";
+    const auto* stratumAnalysis = translationUnit.getAnalysis<RamStratumAnalysis>();
+    if (stratumAnalysis->isConcurrent()) {
+        // independent strata are evaluated concurrently, expired relations are dropped by the scheduler
+        os << "StratumScheduler scheduler;\n";
+        const auto& strata = stratumAnalysis->getStrata();
+        for (size_t i = 0; i < strata.size(); ++i) {
+            os << "/* BEGIN STRATUM " << strata[i]->getIndex() << " */\n";
+            os << "scheduler.addStratum([&]() {\n";
+            for (const RamStatement* stmt : stratumAnalysis->getStatements(i)) {
+                emitCode(os, *stmt);
+            }
+            os << "}, {" << join(stratumAnalysis->getPredecessors(i), ",") << "});\n";
+            os << "/* END STRATUM " << strata[i]->getIndex() << " */\n";
         }
-        os << "[&]() {\n";
-        emitCode(os, stratum.getBody());
-        os << "}();\n";
-        if (Global::config().has("engine")) {
-            os << "if (stratumIndex != (size_t) -1) goto EXIT;\n";
+        for (const RamDrop* drop : stratumAnalysis->getDeferredDrops()) {
+            os << "scheduler.addRelease([&]() {\n";
+            emitCode(os, *drop);
+            os << "}, {" << join(stratumAnalysis->getUsers(*drop), ",") << "});\n";
         }
-        os << "/* END STRATUM " << stratum.getIndex() << " */\n";
-    });
+        os << "scheduler.run(MAX_THREADS);\n";
+    } else {
+        visitDepthFirst(*(prog.getMain()), [&](const RamStratum& stratum) {
+            os << "/* BEGIN STRATUM " << stratum.getIndex() << " */\n";
+            if (Global::config().has("engine")) {
+                // go to the stratum with the max value for int as a suffix if calling the master stratum
+                auto i = stratum.getIndex();
+                os << "STRATUM_" << i << ":\n";
+            }
+            os << "[&]() {\n";
+            emitCode(os, stratum.getBody());
+            os << "}();\n";
+            if (Global::config().has("engine")) {
+                os << "if (stratumIndex != (size_t) -1) goto EXIT;\n";
+            }
+            os << "/* END STRATUM " << stratum.getIndex() << " */\n";
+        });
+    }
 
     if (Global::config().has("engine")) {
         os << "EXIT:{}";
@@ -17,8 +17,8 @@
 
 namespace souffle {
 
-std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation(
-        const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance) {
+std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation(const RamRelation& ramRel,
+        const MinIndexSelection& indexSet, RelationRepresentation representation, bool isProvenance) {
     SynthesiserRelation* rel;
 
     // Handle the qualifier in souffle code
@@ -26,12 +26,16 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
         rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.isNullary()) {
         rel = new SynthesiserNullaryRelation(ramRel, indexSet, isProvenance);
-    } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE) {
+    } else if (representation == RelationRepresentation::BTREE) {
         rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
-    } else if (ramRel.getRepresentation() == RelationRepresentation::BRIE) {
+    } else if (representation == RelationRepresentation::BRIE) {
         rel = new SynthesiserBrieRelation(ramRel, indexSet, isProvenance);
-    } else if (ramRel.getRepresentation() == RelationRepresentation::EQREL) {
+    } else if (representation == RelationRepresentation::COMPRESSED) {
+        rel = new SynthesiserCompressedRelation(ramRel, indexSet, isProvenance);
+    } else if (representation == RelationRepresentation::EQREL) {
         rel = new SynthesiserEqrelRelation(ramRel, indexSet, isProvenance);
+    } else if (representation == RelationRepresentation::HASH) {
+        rel = new SynthesiserHashRelation(ramRel, indexSet, isProvenance);
     } else {
         // Handle the data structure command line flag
         if (ramRel.getArity() > 6) {
@@ -49,6 +53,16 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
     return std::unique_ptr<SynthesiserRelation>(rel);
 }
 
+std::string SynthesiserRelation::getNodeSizeArguments(const std::string& key) const {
+    if (getNodeSize() == RelationNodeSize::DEFAULT) {
+        return "";
+    }
+    std::stringstream res;
+    res << ", std::allocator<" << key << ">, " << getNodeSize()
+        << ", typename souffle::detail::default_strategy<" << key << ">::type";
+    return res.str();
+}
+
 // -------- Nullary Relation --------
 
 /** Generate index set for a nullary relation, which should be empty */
@@ -140,6 +154,14 @@ std::string SynthesiserDirectRelation::getTypeName() {
         res << "__" << search;
     }
 
+    for (auto& search : getMinIndexSelection().getHashSearches()) {
+        res << "__hash" << search;
+    }
+
+    if (getNodeSize() != RelationNodeSize::DEFAULT) {
+        res << "__node" << getNodeSize();
+    }
+
     return res.str();
 }
 
@@ -148,6 +170,7 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     size_t arity = getArity();
     const auto& inds = getIndices();
     size_t numIndexes = inds.size();
+    const auto& hashSearches = getMinIndexSelection().getHashSearches();
     std::map<MinIndexSelection::LexOrder, int> indexToNumMap;
 
     // struct definition
@@ -178,7 +201,8 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
         // also strong/weak comparators and updater methods
         if (isProvenance) {
             out << "using t_ind_" << i << " = btree_set<t_tuple, index_utils::comparator<" << join(ind);
-            out << ">, std::allocator<t_tuple>, 256, typename "
+            out << ">, std::allocator<t_tuple>, "
+                << (getNodeSize() == RelationNodeSize::DEFAULT ? 256 : getNodeSize()) << ", typename "
                    "souffle::detail::default_strategy<t_tuple>::type, index_utils::comparator<";
             out << join(ind.begin(), ind.end() - 2) << ">, updater_" << getTypeName() << ">;\n";
 
@@ -186,15 +210,20 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
         } else {
             if (ind.size() == arity) {
                 out << "using t_ind_" << i << " = btree_set<t_tuple, index_utils::comparator<" << join(ind)
-                    << ">>;\n";
+                    << ">" << getNodeSizeArguments("t_tuple") << ">;\n";
             } else {
                 out << "using t_ind_" << i << " = btree_multiset<t_tuple, index_utils::comparator<"
-                    << join(ind) << ">>;\n";
+                    << join(ind) << ">" << getNodeSizeArguments("t_tuple") << ">;\n";
             }
         }
         out << "t_ind_" << i << " ind_" << i << ";\n";
     }
 
+    // hash indexes serving the hot searches by exact matches of their columns
+    for (int64_t search : hashSearches) {
+        out << "HashIndex<" << arity << "> hash_" << search << "{" << search << "};\n";
+    }
+
     // typedef master index iterator to be struct iterator
     out << "using iterator = t_ind_" << masterIndex << "::iterator;\n";
 
@@ -219,6 +248,9 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
             out << "ind_" << i << ".insert(t, h.hints_" << i << ");\n";
         }
     }
+    for (int64_t search : hashSearches) {
+        out << "hash_" << search << ".insert(t);\n";
+    }
     out << "return true;\n";
     out << "} else return false;\n";
     out << "}\n";  // end of insert(t_tuple&, context&)
@@ -250,8 +282,16 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     out << "}\n";  // end of insertAll<T>
 
     out << "void insertAll(" << getTypeName() << "& other) {\n";
-    for (size_t i = 0; i < numIndexes; i++) {
-        out << "ind_" << i << ".insertAll(other.ind_" << i << ");\n";
+    if (hashSearches.empty()) {
+        for (size_t i = 0; i < numIndexes; i++) {
+            out << "ind_" << i << ".insertAll(other.ind_" << i << ");\n";
+        }
+    } else {
+        // the hash indexes only receive the tuples new to the master index
+        out << "context h;\n";
+        out << "for (auto const& cur : other) {\n";
+        out << "insert(cur, h);\n";
+        out << "}\n";
     }
     out << "}\n";  // end of insertAll(relationType& other)
 
@@ -291,6 +331,20 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
 
     // equalRange methods for each pattern which is used to search this relation
     for (int64_t search : getMinIndexSelection().getSearches()) {
+        // hot searches are served by their hash index
+        if (hashSearches.count(search) > 0) {
+            out << "range<HashIndex<" << arity << ">::iterator> equalRange_" << search;
+            out << "(const t_tuple& t, context& h) const {\n";
+            out << "return hash_" << search << ".equalRange(t);\n";
+            out << "}\n";
+
+            out << "range<HashIndex<" << arity << ">::iterator> equalRange_" << search;
+            out << "(const t_tuple& t) const {\n";
+            out << "return hash_" << search << ".equalRange(t);\n";
+            out << "}\n";
+            continue;
+        }
+
         auto lexOrder = getMinIndexSelection().getLexOrder(search);
         size_t indNum = indexToNumMap[lexOrder];
 
@@ -334,6 +388,23 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // lowerUpperRange methods for the indexes of leapfrog joins
+    std::set<int> trieIndexes;
+    for (const auto& order : getMinIndexSelection().getRequiredOrders()) {
+        trieIndexes.insert(getMinIndexSelection().getOrderNum(order));
+    }
+    for (int indNum : trieIndexes) {
+        out << "std::pair<t_ind_" << indNum << "::iterator,t_ind_" << indNum << "::iterator> ";
+        out << "lowerUpperRange_" << indNum;
+        out << "(const RamDomain* low, const RamDomain* high, context& h) const {\n";
+        out << "return std::make_pair(";
+        out << "ind_" << indNum << ".lower_bound(reinterpret_cast<const t_tuple&>(*low), h.hints_" << indNum
+            << "), ";
+        out << "ind_" << indNum << ".upper_bound(reinterpret_cast<const t_tuple&>(*high), h.hints_" << indNum
+            << "));\n";
+        out << "}\n";
+    }
+
     // empty method
     out << "bool empty() const {\n";
     out << "return ind_" << masterIndex << ".empty();\n";
@@ -349,6 +420,19 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     for (size_t i = 0; i < numIndexes; i++) {
         out << "ind_" << i << ".clear();\n";
     }
+    for (int64_t search : hashSearches) {
+        out << "hash_" << search << ".clear();\n";
+    }
+    out << "}\n";
+
+    // purge method keeping the memory of the indexes for reuse
+    out << "void reset() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".reset();\n";
+    }
+    for (int64_t search : hashSearches) {
+        out << "hash_" << search << ".reset();\n";
+    }
     out << "}\n";
 
     // begin and end iterators
@@ -445,6 +529,10 @@ std::string SynthesiserIndirectRelation::getTypeName() {
         res << "__" << search;
     }
 
+    if (getNodeSize() != RelationNodeSize::DEFAULT) {
+        res << "__node" << getNodeSize();
+    }
+
     return res.str();
 }
 
@@ -477,12 +565,12 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
             out << "using t_ind_" << i
                 << " = btree_set<const t_tuple*, index_utils::deref_compare<typename "
                    "index_utils::comparator<"
-                << join(ind) << ">>>;\n";
+                << join(ind) << ">>" << getNodeSizeArguments("const t_tuple*") << ">;\n";
         } else {
             out << "using t_ind_" << i
                 << " = btree_multiset<const t_tuple*, index_utils::deref_compare<typename "
                    "index_utils::comparator<"
-                << join(ind) << ">>>;\n";
+                << join(ind) << ">>" << getNodeSizeArguments("const t_tuple*") << ">;\n";
         }
 
         out << "t_ind_" << i << " ind_" << i << ";\n";
@@ -551,6 +639,19 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     out << "}\n";
     out << "}\n";
 
+    // insert the partitions of a relation of the same type in parallel
+    out << "void insertAll(" << getTypeName() << "& other) {\n";
+    out << "auto part = other.partition();\n";
+    out << "PARALLEL_START;\n";
+    out << "CREATE_OP_CONTEXT(ctxt, createContext());\n";
+    out << "pfor(auto it = part.begin(); it < part.end(); ++it) {\n";
+    out << "for (const auto& cur : *it) {\n";
+    out << "insert(cur, READ_OP_CONTEXT(ctxt));\n";
+    out << "}\n";
+    out << "}\n";
+    out << "PARALLEL_END;\n";
+    out << "}\n";
+
     // contains methods
     out << "bool contains(const t_tuple& t, context& h) const {\n";
     out << "return ind_" << masterIndex << ".contains(&t, h.hints_" << masterIndex << ");\n";
@@ -627,6 +728,22 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
         out << "}\n";
     }
 
+    // lowerUpperRange methods for the indexes of leapfrog joins
+    std::set<int> trieIndexes;
+    for (const auto& order : getMinIndexSelection().getRequiredOrders()) {
+        trieIndexes.insert(getMinIndexSelection().getOrderNum(order));
+    }
+    for (int indNum : trieIndexes) {
+        out << "std::pair<iterator_" << indNum << ",iterator_" << indNum << "> ";
+        out << "lowerUpperRange_" << indNum;
+        out << "(const RamDomain* low, const RamDomain* high, context& h) const {\n";
+        out << "return std::make_pair(iterator_" << indNum << "(ind_" << indNum
+            << ".lower_bound(reinterpret_cast<const t_tuple*>(low), h.hints_" << indNum << ")), iterator_"
+            << indNum << "(ind_" << indNum << ".upper_bound(reinterpret_cast<const t_tuple*>(high), h.hints_"
+            << indNum << ")));\n";
+        out << "}\n";
+    }
+
     // empty method
     out << "bool empty() const {\n";
     out << "return ind_" << masterIndex << ".empty();\n";
@@ -649,6 +766,14 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     out << "dataTable.clear();\n";
     out << "}\n";
 
+    // purge method keeping the memory of the indexes for reuse
+    out << "void reset() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".reset();\n";
+    }
+    out << "dataTable.clear();\n";
+    out << "}\n";
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return ind_" << masterIndex << ".begin();\n";
@@ -720,10 +845,10 @@ void SynthesiserBrieRelation::computeIndices() {
     computedIndices = inds;
 }
 
-/** Generate type name of a brie relation */
+/** Generate type name of a brie relation, or of a compressed relation sharing its generated struct */
 std::string SynthesiserBrieRelation::getTypeName() {
     std::stringstream res;
-    res << "t_brie_" << getArity();
+    res << "t_" << relation.getRepresentation() << "_" << getArity();
 
     for (auto& ind : getIndices()) {
         res << "__" << join(ind, "_");
@@ -751,7 +876,7 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
         if (i < getMinIndexSelection().getAllOrders().size()) {
             indexToNumMap[getMinIndexSelection().getAllOrders()[i]] = i;
         }
-        out << "using t_ind_" << i << " = Trie<" << inds[i].size() << ">;\n";
+        out << "using t_ind_" << i << " = " << getIndexTemplate() << "<" << inds[i].size() << ">;\n";
         out << "t_ind_" << i << " ind_" << i << ";\n";
     }
     out << "using t_tuple = t_ind_" << masterIndex << "::entry_type;\n";
@@ -943,6 +1068,13 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
     }
     out << "}\n";
 
+    // purge method keeping the memory of the indexes for reuse
+    out << "void reset() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".reset();\n";
+    }
+    out << "}\n";
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".begin());\n";
@@ -956,8 +1088,8 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
     for (size_t i = 0; i < numIndexes; i++) {
         out << "const auto& stats_" << i << " = ind_" << i << ".getHintStatistics();\n";
-        out << "o << prefix << \"arity " << arity << " brie index " << inds[i]
-            << ": (hits/misses/total)\\n\";\n";
+        out << "o << prefix << \"arity " << arity << " " << relation.getRepresentation() << " index "
+            << inds[i] << ": (hits/misses/total)\\n\";\n";
         out << "o << prefix << \"Insert: \" << stats_" << i << ".inserts.getHits() << \"/\" << stats_" << i
             << ".inserts.getMisses() << \"/\" << stats_" << i << ".inserts.getAccesses() << \"\\n\";\n";
         out << "o << prefix << \"Contains: \" << stats_" << i << ".contains.getHits() << \"/\" << stats_" << i
@@ -993,6 +1125,182 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
     out << "};\n";
 }
 
+// -------- Hash Relation --------
+
+/** Generate index set for a hash relation, one hash index per set of bound columns */
+void SynthesiserHashRelation::computeIndices() {
+    assert(!isProvenance && "hash relations cannot be used with provenance");
+
+    const SearchSignature full = (SearchSignature(1) << getArity()) - 1;
+    signatures.push_back(full);
+    for (auto search : getMinIndexSelection().getSearches()) {
+        if (search != full) {
+            signatures.push_back(search);
+        }
+    }
+
+    // record the key columns of each index
+    for (auto search : signatures) {
+        MinIndexSelection::LexOrder ind;
+        for (size_t i = 0; i < getArity(); i++) {
+            if ((search >> i) & 1) {
+                ind.push_back(i);
+            }
+        }
+        computedIndices.push_back(ind);
+    }
+    masterIndex = 0;
+}
+
+/** Generate type name of a hash relation */
+std::string SynthesiserHashRelation::getTypeName() {
+    std::stringstream res;
+    res << "t_hash_" << getArity();
+
+    for (auto search : signatures) {
+        res << "__" << search;
+    }
+
+    return res.str();
+}
+
+/** Generate type struct of a hash relation */
+void SynthesiserHashRelation::generateTypeStruct(std::ostream& out) {
+    size_t arity = getArity();
+    size_t numIndexes = signatures.size();
+
+    // struct definition
+    out << "struct " << getTypeName() << " {\n";
+
+    // define hash indexes
+    out << "using t_ind = HashIndex<" << arity << ">;\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "t_ind ind_" << i << "{" << signatures[i] << "};\n";
+    }
+    out << "using t_tuple = t_ind::entry_type;\n";
+    out << "using iterator = t_ind::iterator;\n";
+
+    // hash indexes take no hints
+    out << "struct context {};\n";
+    out << "context createContext() { return context(); }\n";
+
+    // insert methods
+    out << "bool insert(const t_tuple& t) {\n";
+    out << "if (ind_" << masterIndex << ".insert(t)) {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        if (i != masterIndex) {
+            out << "ind_" << i << ".insert(t);\n";
+        }
+    }
+    out << "return true;\n";
+    out << "} else return false;\n";
+    out << "}\n";
+
+    out << "bool insert(const t_tuple& t, context& h) {\n";
+    out << "return insert(t);\n";
+    out << "}\n";
+
+    out << "bool insert(const RamDomain* ramDomain) {\n";
+    out << "RamDomain data[" << arity << "];\n";
+    out << "std::copy(ramDomain, ramDomain + " << arity << ", data);\n";
+    out << "const t_tuple& tuple = reinterpret_cast<const t_tuple&>(data);\n";
+    out << "return insert(tuple);\n";
+    out << "}\n";
+
+    std::vector<std::string> decls, params;
+    for (size_t i = 0; i < arity; i++) {
+        decls.push_back("RamDomain a" + std::to_string(i));
+        params.push_back("a" + std::to_string(i));
+    }
+    out << "bool insert(" << join(decls, ",") << ") {\nRamDomain data[";
+    out << arity << "] = {" << join(params, ",") << "};\n";
+    out << "return insert(data);\n";
+    out << "}\n";
+
+    // insertAll method
+    out << "template <typename T>\n";
+    out << "void insertAll(T& other) {\n";
+    out << "for (auto const& cur : other) {\n";
+    out << "insert(cur);\n";
+    out << "}\n";
+    out << "}\n";
+
+    // contains methods
+    out << "bool contains(const t_tuple& t, context& h) const {\n";
+    out << "return ind_" << masterIndex << ".contains(t);\n";
+    out << "}\n";
+
+    out << "bool contains(const t_tuple& t) const {\n";
+    out << "return ind_" << masterIndex << ".contains(t);\n";
+    out << "}\n";
+
+    // size method
+    out << "std::size_t size() const {\n";
+    out << "return ind_" << masterIndex << ".size();\n";
+    out << "}\n";
+
+    // empty equalRange method
+    out << "range<iterator> equalRange_0(const t_tuple& t, context& h) const {\n";
+    out << "return range<iterator>(ind_" << masterIndex << ".begin(),ind_" << masterIndex << ".end());\n";
+    out << "}\n";
+
+    out << "range<iterator> equalRange_0(const t_tuple& t) const {\n";
+    out << "return range<iterator>(ind_" << masterIndex << ".begin(),ind_" << masterIndex << ".end());\n";
+    out << "}\n";
+
+    // equalRange methods, served by the index keyed by the bound columns
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "range<iterator> equalRange_" << signatures[i] << "(const t_tuple& t, context& h) const {\n";
+        out << "return ind_" << i << ".equalRange(t);\n";
+        out << "}\n";
+
+        out << "range<iterator> equalRange_" << signatures[i] << "(const t_tuple& t) const {\n";
+        out << "return ind_" << i << ".equalRange(t);\n";
+        out << "}\n";
+    }
+
+    // empty method
+    out << "bool empty() const {\n";
+    out << "return ind_" << masterIndex << ".empty();\n";
+    out << "}\n";
+
+    // partition method
+    out << "std::vector<range<iterator>> partition() const {\n";
+    out << "return ind_" << masterIndex << ".partition(10000);\n";
+    out << "}\n";
+
+    // purge method
+    out << "void purge() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".clear();\n";
+    }
+    out << "}\n";
+
+    // purge method keeping the memory of the indexes for reuse
+    out << "void reset() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".reset();\n";
+    }
+    out << "}\n";
+
+    // begin and end iterators
+    out << "iterator begin() const {\n";
+    out << "return ind_" << masterIndex << ".begin();\n";
+    out << "}\n";
+
+    out << "iterator end() const {\n";
+    out << "return ind_" << masterIndex << ".end();\n";
+    out << "}\n";
+
+    // hash indexes keep no hint statistics
+    out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
+    out << "o << prefix << \"arity " << arity << " hash relation: no hints\\n\";\n";
+    out << "}\n";
+
+    // end struct
+    out << "};\n";
+}
+
 // -------- Eqrel Relation --------
 
 /** Generate index set for a eqrel relation */
@@ -1175,6 +1483,11 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
     }
     out << "}\n";
 
+    // purge method, equivalence relations do not retain memory
+    out << "void reset() {\n";
+    out << "purge();\n";
+    out << "}\n";
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".begin());\n";
@@ -1186,7 +1499,8 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
 
     // printHintStatistics method
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
-    out << "o << \"eqrel index: no hint statistics supported\\n\";\n";
+    out << "o << prefix << \"eqrel index: union-find statistics\\n\";\n";
+    out << "ind_" << masterIndex << ".getStatistics().print(o, prefix + \"  \");\n";
     out << "}\n";
 
     // generate orderIn and orderOut methods which reorder tuples
@@ -10,10 +10,12 @@
 
 #include "RamIndexAnalysis.h"
 #include "RamRelation.h"
+#include "RelationNodeSize.h"
 
 #include <memory>
 #include <ostream>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -61,11 +63,20 @@ public:
     /** Generate relation type struct */
     virtual void generateTypeStruct(std::ostream& out) = 0;
 
-    /** Factory method to generate a SynthesiserRelation */
-    static std::unique_ptr<SynthesiserRelation> getSynthesiserRelation(
-            const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance);
+    /** Factory method to generate a SynthesiserRelation of the representation chosen by the index analysis */
+    static std::unique_ptr<SynthesiserRelation> getSynthesiserRelation(const RamRelation& ramRel,
+            const MinIndexSelection& indexSet, RelationRepresentation representation, bool isProvenance);
 
 protected:
+    /** Get the b-tree node size requested for this relation by the node-size pragma */
+    size_t getNodeSize() const {
+        return RelationNodeSize::get(relation.getName());
+    }
+
+    /** Print the template arguments following the comparator of a b-tree over the given key type,
+     * empty unless a node size is requested for this relation */
+    std::string getNodeSizeArguments(const std::string& key) const;
+
     /** Ram relation referred to by this */
     const RamRelation& relation;
 
@@ -125,6 +136,38 @@ public:
     void computeIndices() override;
     std::string getTypeName() override;
     void generateTypeStruct(std::ostream& out) override;
+
+protected:
+    /** Get the class template of the sets storing the tuples of an index */
+    virtual std::string getIndexTemplate() const {
+        return "Trie";
+    }
+};
+
+class SynthesiserCompressedRelation : public SynthesiserBrieRelation {
+public:
+    SynthesiserCompressedRelation(
+            const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance)
+            : SynthesiserBrieRelation(ramRel, indexSet, isProvenance) {}
+
+protected:
+    std::string getIndexTemplate() const override {
+        return "CompressedSet";
+    }
+};
+
+class SynthesiserHashRelation : public SynthesiserRelation {
+public:
+    SynthesiserHashRelation(const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance)
+            : SynthesiserRelation(ramRel, indexSet, isProvenance) {}
+
+    void computeIndices() override;
+    std::string getTypeName() override;
+    void generateTypeStruct(std::ostream& out) override;
+
+private:
+    /** The columns bound by the searches served by each index, the first index holds all columns */
+    std::vector<SearchSignature> signatures;
 };
 
 class SynthesiserEqrelRelation : public SynthesiserRelation {
@@ -17,14 +17,19 @@
 #pragma once
 
 #include "LambdaBTree.h"
+#include "ParallelUtils.h"
 #include "PiggyList.h"
+#include "Util.h"
 
 #include <atomic>
 #include <exception>
 #include <iterator>
 #include <limits>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <ostream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -46,6 +51,85 @@ using block_t = uint64_t;
 // block_t & rank_mask extracts the rank
 constexpr block_t rank_mask = (1ul << split_size) - 1;
 
+/**
+ * Counters of the operations of a disjoint set, showing the depth of the trees traversed by finds
+ * and the contention of concurrent unions. Counting is only active if hints profiling is enabled.
+ */
+class DisjointSetStatistics {
+    bool active;
+    std::atomic<size_t> finds;
+    std::atomic<size_t> findSteps;
+    std::atomic<size_t> maxFindDepth;
+    std::atomic<size_t> unions;
+    std::atomic<size_t> casRetries;
+
+public:
+    DisjointSetStatistics(bool active = isHintsProfilingEnabled())
+            : active(active), finds(0), findSteps(0), maxFindDepth(0), unions(0), casRetries(0) {}
+
+    bool isActive() const {
+        return active;
+    }
+
+    /** Record a find that has traversed the given number of parent links */
+    void addFind(size_t depth) {
+        if (!active) return;
+        finds.fetch_add(1, std::memory_order_relaxed);
+        findSteps.fetch_add(depth, std::memory_order_relaxed);
+        size_t max = maxFindDepth.load(std::memory_order_relaxed);
+        while (depth > max && !maxFindDepth.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {
+        }
+    }
+
+    /** Record a union of two distinct sets */
+    void addUnion() {
+        if (active) unions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** Record a compare-and-swap that failed due to a concurrent update */
+    void addCasRetry() {
+        if (active) casRetries.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t getFinds() const {
+        return finds;
+    }
+
+    size_t getFindSteps() const {
+        return findSteps;
+    }
+
+    size_t getMaxFindDepth() const {
+        return maxFindDepth;
+    }
+
+    size_t getUnions() const {
+        return unions;
+    }
+
+    size_t getCasRetries() const {
+        return casRetries;
+    }
+
+    void reset() {
+        finds = 0;
+        findSteps = 0;
+        maxFindDepth = 0;
+        unions = 0;
+        casRetries = 0;
+    }
+
+    void print(std::ostream& out, const std::string& prefix) const {
+        if (!active) {
+            out << prefix << "union-find statistics are only collected with SOUFFLE_PROFILE_HINTS set\n";
+            return;
+        }
+        out << prefix << "Finds: " << getFinds() << ", parent links followed: " << getFindSteps()
+            << ", maximal depth: " << getMaxFindDepth() << "\n";
+        out << prefix << "Unions: " << getUnions() << ", CAS retries: " << getCasRetries() << "\n";
+    }
+};
+
 /**
  * Structure that emulates a Disjoint Set, i.e. a data structure that supports efficient union-find operations
  */
@@ -55,6 +139,9 @@ class DisjointSet {
 
     PiggyList<std::atomic<block_t>> a_blocks;
 
+    // the counters of the operations on this set
+    mutable DisjointSetStatistics stats;
+
 public:
     DisjointSet() = default;
 
@@ -93,6 +180,7 @@ public:
      * @return The parent of x
      */
     parent_t findNode(parent_t x) {
+        size_t depth = 0;
         // while x's parent is not itself
         while (x != b2p(get(x))) {
             block_t xState = get(x);
@@ -101,13 +189,24 @@ public:
             // construct block out of the original rank and the new parent
             block_t newState = pr2b(newParent, b2r(xState));
 
-            this->get(x).compare_exchange_strong(xState, newState);
+            if (!this->get(x).compare_exchange_strong(xState, newState)) {
+                stats.addCasRetry();
+            }
 
             x = newParent;
+            ++depth;
         }
+        stats.addFind(depth);
         return x;
     }
 
+    /**
+     * Obtain the counters of the operations on this set
+     */
+    const DisjointSetStatistics& getStatistics() const {
+        return stats;
+    }
+
 private:
     /**
      * Update the root of the tree of which x is, to have y as the base instead
@@ -137,6 +236,7 @@ public:
      */
     void clear() {
         a_blocks.clear();
+        stats.reset();
     }
 
     /**
@@ -159,14 +259,16 @@ public:
      * Union the two specified index nodes
      * @param x node to be unioned
      * @param y node to be unioned
+     * @param attached if not null, receives the former root that has been attached to the other root
+     * @return whether the two nodes have been in different sets
      */
-    void unionNodes(parent_t x, parent_t y) {
+    bool unionNodes(parent_t x, parent_t y, parent_t* attached = nullptr) {
         while (true) {
             x = findNode(x);
             y = findNode(y);
 
             // no need to union if both already in same set
-            if (x == y) return;
+            if (x == y) return false;
 
             rank_t xrank = b2r(get(x));
             rank_t yrank = b2r(get(y));
@@ -178,10 +280,15 @@ public:
             }
             // join the trees together
             // perhaps we can optimise the use of compare_exchange_strong here, as we're in a pessimistic loop
-            if (!updateRoot(x, xrank, y, yrank)) continue;
+            if (!updateRoot(x, xrank, y, yrank)) {
+                stats.addCasRetry();
+                continue;
+            }
             // make sure that the ranks are orderable
             if (xrank == yrank) updateRoot(y, yrank, y, yrank + 1);
-            break;
+            if (attached != nullptr) *attached = x;
+            stats.addUnion();
+            return true;
         }
     }
 
@@ -247,6 +354,154 @@ struct EqrelMapComparator {
     }
 };
 
+/**
+ * A concurrent hash map from sparse values to the dense values of a disjoint set.
+ *
+ * The map is split into shards selected by the hash of a key. Each shard is an open-addressing
+ * table with linear probing. Lookups are lock-free, insertions of new keys serialise on the lock
+ * of their shard. A slot is published by storing its value after its key, such that a lookup
+ * observing a value also observes its key. Tables are grown by copying them before publishing the
+ * copy; superseded tables are retained until the map is cleared, as lookups may still read them.
+ */
+template <typename SparseDomain>
+class SparseToDenseMap {
+    static constexpr size_t num_shards = 64;
+    static constexpr size_t shard_bits = 6;
+    static constexpr parent_t empty_value = std::numeric_limits<parent_t>::max();
+
+    struct slot {
+        std::atomic<SparseDomain> key;
+        std::atomic<parent_t> value;
+    };
+
+    struct table {
+        const size_t mask;
+        std::unique_ptr<slot[]> slots;
+
+        table(size_t size) : mask(size - 1), slots(new slot[size]) {
+            for (size_t i = 0; i < size; ++i) {
+                slots[i].key.store(SparseDomain(), std::memory_order_relaxed);
+                slots[i].value.store(empty_value, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct shard {
+        // the table read by lookups
+        std::atomic<table*> current{nullptr};
+
+        // all tables of this shard, including superseded ones
+        std::vector<std::unique_ptr<table>> tables;
+
+        // the number of occupied slots of the current table
+        size_t used = 0;
+
+        // serialises insertions into this shard
+        SpinLock lock;
+    };
+
+    std::unique_ptr<shard[]> shards;
+
+    static uint64_t hash(const SparseDomain key) {
+        uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 29);
+    }
+
+    static shard& getShard(shard* shards, uint64_t h) {
+        return shards[h >> (64 - shard_bits)];
+    }
+
+    /** Find the dense value of the key in the given table, or the empty value */
+    static parent_t find(const table* t, const SparseDomain key, uint64_t h) {
+        if (t == nullptr) return empty_value;
+        for (size_t pos = h & t->mask;; pos = (pos + 1) & t->mask) {
+            const parent_t value = t->slots[pos].value.load(std::memory_order_acquire);
+            if (value == empty_value) return empty_value;
+            if (t->slots[pos].key.load(std::memory_order_relaxed) == key) return value;
+        }
+    }
+
+    /** Store a new key into the given table, which is not visible to lookups or has room for it */
+    static void place(table* t, const SparseDomain key, const parent_t value, uint64_t h) {
+        size_t pos = h & t->mask;
+        while (t->slots[pos].value.load(std::memory_order_relaxed) != empty_value) {
+            pos = (pos + 1) & t->mask;
+        }
+        t->slots[pos].key.store(key, std::memory_order_relaxed);
+        t->slots[pos].value.store(value, std::memory_order_release);
+    }
+
+    /** Replace the table of a shard by one of twice the size */
+    static void grow(shard& cur) {
+        table* old = cur.current.load(std::memory_order_relaxed);
+        const size_t size = (old == nullptr) ? 16 : (old->mask + 1) * 2;
+        std::unique_ptr<table> next = std::make_unique<table>(size);
+        if (old != nullptr) {
+            for (size_t i = 0; i <= old->mask; ++i) {
+                const parent_t value = old->slots[i].value.load(std::memory_order_relaxed);
+                if (value != empty_value) {
+                    const SparseDomain key = old->slots[i].key.load(std::memory_order_relaxed);
+                    place(next.get(), key, value, hash(key));
+                }
+            }
+        }
+        cur.current.store(next.get(), std::memory_order_release);
+        cur.tables.push_back(std::move(next));
+    }
+
+public:
+    SparseToDenseMap() : shards(new shard[num_shards]) {}
+
+    /**
+     * Obtain the dense value of a sparse value
+     * @return the dense value, or the maximal parent_t value if the sparse value is absent
+     */
+    parent_t lookup(const SparseDomain key) const {
+        const uint64_t h = hash(key);
+        return find(getShard(shards.get(), h).current.load(std::memory_order_acquire), key, h);
+    }
+
+    bool contains(const SparseDomain key) const {
+        return lookup(key) != empty_value;
+    }
+
+    /**
+     * Obtain the dense value of a sparse value, adding it if absent
+     * @param create the function creating the dense value of an absent key; it is called once per key
+     */
+    template <typename Create>
+    parent_t insert(const SparseDomain key, const Create& create) {
+        const uint64_t h = hash(key);
+        shard& cur = getShard(shards.get(), h);
+        parent_t res = find(cur.current.load(std::memory_order_acquire), key, h);
+        if (res != empty_value) return res;
+
+        std::lock_guard<SpinLock> guard(cur.lock);
+        res = find(cur.current.load(std::memory_order_relaxed), key, h);
+        if (res != empty_value) return res;
+        table* t = cur.current.load(std::memory_order_relaxed);
+        if (t == nullptr || (cur.used + 1) * 2 > t->mask + 1) {
+            grow(cur);
+            t = cur.current.load(std::memory_order_relaxed);
+        }
+        res = create(key);
+        place(t, key, res, h);
+        cur.used++;
+        return res;
+    }
+
+    /**
+     * Remove all keys; not to be called concurrently with other operations
+     */
+    void clear() {
+        for (size_t i = 0; i < num_shards; ++i) {
+            shards[i].current.store(nullptr, std::memory_order_relaxed);
+            shards[i].tables.clear();
+            shards[i].used = 0;
+        }
+    }
+};
+
 template <typename SparseDomain>
 class SparseDisjointSet {
     DisjointSet ds;
@@ -254,13 +509,9 @@ class SparseDisjointSet {
     template <typename TupleType>
     friend class EquivalenceRelation;
 
-    using PairStore = std::pair<SparseDomain, parent_t>;
-    using SparseMap =
-            LambdaBTreeSet<PairStore, std::function<parent_t(PairStore&)>, EqrelMapComparator<PairStore>>;
+    using SparseMap = SparseToDenseMap<SparseDomain>;
     using DenseMap = RandomInsertPiggyList<SparseDomain>;
 
-    typename SparseMap::operation_hints last_ins;
-
     SparseMap sparseToDenseMap;
     // mapping from union-find val to souffle, union-find encoded as index
     DenseMap denseToSparseMap;
@@ -274,11 +525,9 @@ public:
     parent_t toDense(const SparseDomain in) {
         // insert into the mapping - if the key doesn't exist (in), the function will be called
         // and a dense value will be created for it
-        PairStore p = {in, -1};
-        return sparseToDenseMap.insert(p, [&](PairStore& p) {
+        return sparseToDenseMap.insert(in, [&](const SparseDomain key) {
             parent_t c2 = DisjointSet::b2p(this->ds.makeNode());
-            this->denseToSparseMap.insertAt(c2, p.first);
-            p.second = c2;
+            this->denseToSparseMap.insertAt(c2, key);
             return c2;
         });
     }
@@ -316,9 +565,9 @@ public:
     inline SparseDomain findNode(SparseDomain x) {
         return toSparse(ds.findNode(toDense(x)));
     };
-    /* union the nodes, add if not existing */
-    inline void unionNodes(SparseDomain x, SparseDomain y) {
-        ds.unionNodes(toDense(x), toDense(y));
+    /* union the nodes, add if not existing; the attached root is given as a dense value */
+    inline bool unionNodes(SparseDomain x, SparseDomain y, parent_t* attached = nullptr) {
+        return ds.unionNodes(toDense(x), toDense(y), attached);
     };
 
     inline std::size_t size() {
@@ -342,9 +591,16 @@ public:
 
     /* whether we the supplied node exists */
     inline bool nodeExists(const SparseDomain val) const {
-        return sparseToDenseMap.contains({val, -1});
+        return sparseToDenseMap.contains(val);
     };
 
+    /**
+     * Obtain the counters of the operations on the underlying disjoint set
+     */
+    const DisjointSetStatistics& getStatistics() const {
+        return ds.getStatistics();
+    }
+
     inline bool contains(SparseDomain v1, SparseDomain v2) {
         if (nodeExists(v1) && nodeExists(v2)) {
             return sameSet(v1, v2);
@@ -18,6 +18,7 @@
 #include "RamTypes.h"
 #include "SymbolTable.h"
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 #include <vector>
@@ -35,16 +36,25 @@ public:
         if (summary) {
             return writeSize(relation.size());
         }
-        auto lease = symbolTable.acquireLock();
-        (void)lease;
         if (arity == 0) {
             if (relation.begin() != relation.end()) {
                 writeNullary();
             }
             return;
         }
+        const size_t tupleSize = symbolMask.size();
+        std::vector<RamDomain> buffer(BATCH_SIZE * tupleSize);
+        size_t count = 0;
         for (const auto& current : relation) {
-            writeNext(current);
+            const RamDomain* tuple = getData(current);
+            std::copy(tuple, tuple + tupleSize, buffer.data() + count * tupleSize);
+            if (++count == BATCH_SIZE) {
+                writeNextTuples(buffer.data(), count);
+                count = 0;
+            }
+        }
+        if (count > 0) {
+            writeNextTuples(buffer.data(), count);
         }
     }
     template <typename T>
@@ -61,8 +71,21 @@ protected:
     const bool summary;
     const size_t arity;
 
+    /** Number of tuples handed to writeNextTuples at once by writeAll */
+    static constexpr size_t BATCH_SIZE = 1024;
+
     virtual void writeNullary() = 0;
     virtual void writeNextTuple(const RamDomain* tuple) = 0;
+
+    /**
+     * Write count tuples stored back to back in tuples, each of symbolMask.size() elements.
+     */
+    virtual void writeNextTuples(const RamDomain* tuples, size_t count) {
+        const size_t tupleSize = symbolMask.size();
+        for (size_t i = 0; i < count; ++i) {
+            writeNextTuple(tuples + i * tupleSize);
+        }
+    }
     virtual void writeSize(std::size_t size) {
         assert(false && "attempting to print size of a write operation");
     }
@@ -70,6 +93,13 @@ protected:
     void writeNext(const Tuple tuple) {
         writeNextTuple(tuple.data);
     }
+    template <typename Tuple>
+    static const RamDomain* getData(const Tuple& tuple) {
+        return tuple.data;
+    }
+    static const RamDomain* getData(const RamDomain* tuple) {
+        return tuple;
+    }
 };
 
 class WriteStreamFactory {
@@ -0,0 +1,143 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WriteStreamBinary.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "BinaryFormat.h"
+#include "IODirectives.h"
+#include "RamTypes.h"
+#include "SymbolTable.h"
+#include "WriteStream.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Writes a relation in the binary fact format described in BinaryFormat.h, one block per
+ * batch of tuples.
+ */
+class WriteFileBinary : public WriteStream {
+public:
+    WriteFileBinary(const std::vector<bool>& symbolMask, const SymbolTable& symbolTable,
+            const IODirectives& ioDirectives, const bool provenance = false)
+            : WriteStream(symbolMask, symbolTable, provenance),
+              file(ioDirectives.getFileName(), std::ios::out | std::ios::binary) {
+        if (!file.is_open()) {
+            throw std::invalid_argument("Cannot open output file " + ioDirectives.getFileName() + "\n");
+        }
+        writeHeader();
+    }
+
+    ~WriteFileBinary() override = default;
+
+protected:
+    void writeNullary() override {
+        writeValue<uint64_t>(1);
+        writeValue<uint64_t>(0);
+    }
+
+    void writeNextTuple(const RamDomain* tuple) override {
+        writeNextTuples(tuple, 1);
+    }
+
+    void writeNextTuples(const RamDomain* tuples, size_t count) override {
+        const size_t tupleSize = symbolMask.size();
+
+        // number the symbols that have not been written yet
+        std::vector<RamDomain> newSymbols;
+        columns.resize(arity * count);
+        for (size_t col = 0; col < arity; ++col) {
+            RamDomain* column = columns.data() + col * count;
+            for (size_t i = 0; i < count; ++i) {
+                RamDomain value = tuples[i * tupleSize + col];
+                if (symbolMask.at(col)) {
+                    auto pos = symbolIds.find(value);
+                    if (pos == symbolIds.end()) {
+                        pos = symbolIds.emplace(value, static_cast<RamDomain>(symbolIds.size())).first;
+                        newSymbols.push_back(value);
+                    }
+                    value = pos->second;
+                }
+                column[i] = value;
+            }
+        }
+
+        writeValue<uint64_t>(count);
+        writeValue<uint64_t>(newSymbols.size());
+        for (RamDomain symbol : newSymbols) {
+            const std::string& str = symbolTable.unsafeResolve(symbol);
+            writeValue<uint32_t>(str.size());
+            write(str.data(), str.size());
+        }
+        writePadding();
+        write(columns.data(), columns.size() * sizeof(RamDomain));
+    }
+
+    void writeHeader() {
+        write(BinaryFormat::MAGIC, BinaryFormat::MAGIC_SIZE);
+        writeValue<uint32_t>(BinaryFormat::VERSION);
+        writeValue<uint32_t>(sizeof(RamDomain));
+        writeValue<uint32_t>(arity);
+        for (size_t col = 0; col < arity; ++col) {
+            writeValue<uint8_t>(symbolMask.at(col) ? 1 : 0);
+        }
+        writePadding();
+    }
+
+    template <typename T>
+    void writeValue(T value) {
+        write(&value, sizeof(T));
+    }
+
+    void write(const void* data, size_t size) {
+        file.write(static_cast<const char*>(data), size);
+        offset += size;
+    }
+
+    void writePadding() {
+        static const char zeros[BinaryFormat::ALIGNMENT] = {};
+        write(zeros, BinaryFormat::padding(offset));
+    }
+
+    std::ofstream file;
+    /** number of bytes written so far, used for alignment */
+    size_t offset = 0;
+    /** file-local numbers of the symbols written so far */
+    std::unordered_map<RamDomain, RamDomain> symbolIds;
+    /** column-major staging buffer for the current block */
+    std::vector<RamDomain> columns;
+};
+
+class WriteFileBinaryFactory : public WriteStreamFactory {
+public:
+    std::unique_ptr<WriteStream> getWriter(const std::vector<bool>& symbolMask,
+            const SymbolTable& symbolTable, const IODirectives& ioDirectives,
+            const bool provenance) override {
+        return std::make_unique<WriteFileBinary>(symbolMask, symbolTable, ioDirectives, provenance);
+    }
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+    ~WriteFileBinaryFactory() override = default;
+};
+
+} /* namespace souffle */
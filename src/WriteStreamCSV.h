@@ -27,6 +27,7 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -38,6 +39,30 @@ protected:
         }
         return "\t";
     }
+
+    /** Append count tuples of the given layout to out, one delimited line per tuple */
+    static void formatTuples(std::string& out, const RamDomain* tuples, size_t count,
+            const std::vector<bool>& symbolMask, size_t arity, const SymbolTable& symbolTable,
+            const std::string& delimiter) {
+        const size_t tupleSize = symbolMask.size();
+        for (size_t i = 0; i < count; ++i) {
+            const RamDomain* tuple = tuples + i * tupleSize;
+            for (size_t col = 0; col < arity; ++col) {
+                if (col > 0) {
+                    out += delimiter;
+                }
+                if (symbolMask.at(col)) {
+                    out += symbolTable.unsafeResolve(tuple[col]);
+                } else {
+                    out += std::to_string(tuple[col]);
+                }
+            }
+            out += '\n';
+        }
+    }
+
+    /** buffer for formatted batches, reused across calls */
+    std::string batch;
 };
 
 class WriteFileCSV : public WriteStreamCSV, public WriteStream {
@@ -77,6 +102,12 @@ protected:
         }
         file << "\n";
     }
+
+    void writeNextTuples(const RamDomain* tuples, size_t count) override {
+        batch.clear();
+        formatTuples(batch, tuples, count, symbolMask, arity, symbolTable, delimiter);
+        file.write(batch.data(), batch.size());
+    }
 };
 
 #ifdef USE_LIBZ
@@ -115,6 +146,12 @@ protected:
         file << "\n";
     }
 
+    void writeNextTuples(const RamDomain* tuples, size_t count) override {
+        batch.clear();
+        formatTuples(batch, tuples, count, symbolMask, arity, symbolTable, delimiter);
+        file.write(batch.data(), batch.size());
+    }
+
     const std::string delimiter;
     gzfstream::ogzfstream file;
 };
@@ -158,6 +195,12 @@ protected:
         std::cout << "\n";
     }
 
+    void writeNextTuples(const RamDomain* tuples, size_t count) override {
+        batch.clear();
+        formatTuples(batch, tuples, count, symbolMask, arity, symbolTable, delimiter);
+        std::cout.write(batch.data(), batch.size());
+    }
+
     const std::string delimiter;
 };
 
@@ -71,6 +71,21 @@ protected:
         sqlite3_reset(insertStatement);
     }
 
+    /** Insert a batch of tuples inside a single transaction */
+    void writeNextTuples(const RamDomain* tuples, size_t count) override {
+        const size_t tupleSize = symbolMask.size();
+        executeSQL("BEGIN TRANSACTION", db);
+        try {
+            for (size_t i = 0; i < count; ++i) {
+                writeNextTuple(tuples + i * tupleSize);
+            }
+        } catch (...) {
+            executeSQL("COMMIT", db);
+            throw;
+        }
+        executeSQL("COMMIT", db);
+    }
+
 private:
     void executeSQL(const std::string& sql, sqlite3* db) {
         assert(db && "Database connection is closed");
@@ -205,6 +205,9 @@ int main(int argc, char** argv) {
                 {"profile", 'p', "FILE", "", false, "Enable profiling, and write profile data to <FILE>."},
                 {"profile-use", 'u', "FILE", "", false,
                         "Use profile log-file <FILE> for profile-guided optimization."},
+                {"fact-sample", '\6', "N", "", false,
+                        "Load only every <N>-th input tuple, e.g. for a profiled sample run whose "
+                        "relation statistics guide the atom order with --profile-use."},
                 {"debug-report", 'r', "FILE", "", false, "Write HTML debug report to <FILE>."},
                 {"pragma", 'P', "OPTIONS", "", false, "Set pragma options."},
                 {"provenance", 't', "[ none | explain | explore ]", "", false,
@@ -212,6 +215,8 @@ int main(int argc, char** argv) {
                 {"engine", 'e', "[ file | mpi ]", "", false,
                         "Specify communication engine for distributed execution."},
                 {"interpreter", '\1', "[ RAMI | LVM ]", "LVM", false, "Switch interpreter implementation."},
+                {"adaptive-join-order", '\5', "", "", false,
+                        "Choose the join order of recursive rules in every iteration (LVM only)."},
                 {"hostfile", '\2', "FILE", "", false,
                         "Specify --hostfile option for call to mpiexec when using mpi as "
                         "execution engine."},
@@ -320,6 +325,23 @@ int main(int argc, char** argv) {
             Global::config().set("compile");
         }
 
+        /* join orders are only chosen at runtime by the LVM */
+        if (Global::config().has("adaptive-join-order")) {
+            if (Global::config().has("compile") || Global::config().has("dl-program") ||
+                    Global::config().has("generate") || Global::config().get("interpreter") != "LVM") {
+                throw std::invalid_argument("Error: Use of adaptive join order only available for the LVM.");
+            }
+        }
+
+        /* a sample run loads every n-th input tuple */
+        if (Global::config().has("fact-sample")) {
+            if (!isNumber(Global::config().get("fact-sample").c_str()) ||
+                    std::stoi(Global::config().get("fact-sample")) < 1) {
+                throw std::runtime_error("Wrong parameter " + Global::config().get("fact-sample") +
+                                         " for option --fact-sample!");
+            }
+        }
+
         /* disable provenance with engine option */
         if (Global::config().has("provenance")) {
             if (Global::config().has("engine")) {
@@ -88,6 +88,8 @@
 %token BRIE_QUALIFIER            "BRIE datastructure qualifier"
 %token BTREE_QUALIFIER           "BTREE datastructure qualifier"
 %token EQREL_QUALIFIER           "equivalence relation qualifier"
+%token COMPRESSED_QUALIFIER      "COMPRESSED datastructure qualifier"
+%token HASH_QUALIFIER            "HASH datastructure qualifier"
 %token OVERRIDABLE_QUALIFIER     "relation qualifier overidable"
 %token INLINE_QUALIFIER          "relation qualifier inline"
 %token TMATCH                    "match predicate"
@@ -511,20 +513,30 @@ qualifiers
         $$ = $1 | INLINE_RELATION;
     }
   | qualifiers BRIE_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|COMPRESSED_RELATION|HASH_RELATION))
+            driver.error(@2, "btree/brie/eqrel/compressed/hash qualifier already set");
         $$ = $1 | BRIE_RELATION;
     }
   | qualifiers BTREE_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|COMPRESSED_RELATION|HASH_RELATION))
+            driver.error(@2, "btree/brie/eqrel/compressed/hash qualifier already set");
         $$ = $1 | BTREE_RELATION;
     }
   | qualifiers EQREL_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|COMPRESSED_RELATION|HASH_RELATION))
+            driver.error(@2, "btree/brie/eqrel/compressed/hash qualifier already set");
         $$ = $1 | EQREL_RELATION;
     }
+  | qualifiers COMPRESSED_QUALIFIER {
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|COMPRESSED_RELATION|HASH_RELATION))
+            driver.error(@2, "btree/brie/eqrel/compressed/hash qualifier already set");
+        $$ = $1 | COMPRESSED_RELATION;
+    }
+  | qualifiers HASH_QUALIFIER {
+        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION|COMPRESSED_RELATION|HASH_RELATION))
+            driver.error(@2, "btree/brie/eqrel/compressed/hash qualifier already set");
+        $$ = $1 | HASH_RELATION;
+    }
   | %empty {
         $$ = 0;
     }
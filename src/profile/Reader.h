@@ -222,7 +222,7 @@ protected:
 
 /**
  * Visit ProfileDB relations.
- * relname: {DSN, non-recursive-rule: {}, iteration: {...}}
+ * relname: {DSN, non-recursive-rule: {}, iteration: {...}, distinct-values: {column: num}}
  */
 class RelationVisitor : public DSNVisitor<Relation> {
 public:
@@ -248,6 +248,12 @@ public:
             for (const auto& key : directory.getKeys()) {
                 directory.readEntry(key)->accept(rulesVisitor);
             }
+        } else if (directory.getKey() == "distinct-values") {
+            for (const auto& key : directory.getKeys()) {
+                if (auto* distinct = dynamic_cast<SizeEntry*>(directory.readEntry(key))) {
+                    base.setDistinctValues(std::stoul(key), distinct->getSize());
+                }
+            }
         } else if (directory.getKey() == "maxRSS") {
             auto* preMaxRSS = dynamic_cast<SizeEntry*>(directory.readEntry("pre"));
             auto* postMaxRSS = dynamic_cast<SizeEntry*>(directory.readEntry("post"));
@@ -11,6 +11,7 @@
 #include "Iteration.h"
 #include "Rule.h"
 #include <chrono>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -39,6 +40,7 @@ private:
     int ruleId = 0;
     int recursiveId = 0;
     size_t tuplesRead = 0;
+    std::map<size_t, size_t> distinctValues;
 
     std::vector<std::shared_ptr<Iteration>> iterations;
 
@@ -145,6 +147,17 @@ public:
         nonRecTuples = numTuples;
     }
 
+    void setDistinctValues(size_t column, size_t num) {
+        distinctValues[column] = num;
+    }
+
+    /**
+     * Return the estimated number of distinct values of each column with statistics, indexed by column.
+     */
+    const std::map<size_t, size_t>& getDistinctValues() const {
+        return distinctValues;
+    }
+
     void setPostMaxRSS(size_t maxRSS) {
         postMaxRSS = std::max(maxRSS, postMaxRSS);
     }
@@ -0,0 +1,208 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file binary_io_test.cpp
+ *
+ * Tests the binary fact format.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "IOSystem.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace souffle;
+
+namespace test {
+
+/** A relation that keeps the loaded tuples in order */
+struct TupleList {
+    size_t arity;
+    std::vector<std::vector<RamDomain>> tuples;
+
+    void insert(const RamDomain* tuple) {
+        tuples.emplace_back(tuple, tuple + arity);
+    }
+
+    std::vector<const RamDomain*> data() const {
+        std::vector<const RamDomain*> res;
+        for (const auto& cur : tuples) {
+            res.push_back(cur.data());
+        }
+        return res;
+    }
+};
+
+IODirectives getDirectives(const std::string& type, const std::string& fileName) {
+    IODirectives ioDirectives;
+    ioDirectives.setIOType(type);
+    ioDirectives.setRelationName("rel");
+    ioDirectives.setFileName(fileName);
+    return ioDirectives;
+}
+
+std::string readFile(const std::string& fileName) {
+    std::ifstream file(fileName, std::ios::in | std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+TEST(BinaryIO, RoundTrip) {
+    const std::string fileName = "binary_io_test_roundtrip.bin";
+    const std::vector<bool> symbolMask = {true, false, true};
+
+    SymbolTable writeTable;
+    TupleList relation{3, {}};
+    for (RamDomain i = 0; i < 5000; ++i) {
+        relation.tuples.push_back({writeTable.lookup("s" + std::to_string(i % 777)), -i,
+                writeTable.lookup("t" + std::to_string(i % 13))});
+    }
+    IOSystem::getInstance()
+            .getWriter(symbolMask, writeTable, getDirectives("binary", fileName), false)
+            ->writeAll(relation.data());
+
+    // the reading table numbers symbols differently
+    SymbolTable readTable({"unrelated", "t5"});
+    TupleList loaded{3, {}};
+    IOSystem::getInstance()
+            .getReader(symbolMask, readTable, getDirectives("binary", fileName), false)
+            ->readAll(loaded);
+
+    EXPECT_EQ(relation.tuples.size(), loaded.tuples.size());
+    for (size_t i = 0; i < relation.tuples.size() && i < loaded.tuples.size(); ++i) {
+        EXPECT_EQ(writeTable.resolve(relation.tuples[i][0]), readTable.resolve(loaded.tuples[i][0]));
+        EXPECT_EQ(relation.tuples[i][1], loaded.tuples[i][1]);
+        EXPECT_EQ(writeTable.resolve(relation.tuples[i][2]), readTable.resolve(loaded.tuples[i][2]));
+    }
+    std::remove(fileName.c_str());
+}
+
+TEST(BinaryIO, CSVRoundTrip) {
+    const std::string csvIn = "binary_io_test_in.csv";
+    const std::string binary = "binary_io_test.bin";
+    const std::string csvOut = "binary_io_test_out.csv";
+    const std::vector<bool> symbolMask = {false, true};
+    {
+        std::ofstream file(csvIn);
+        file << "1\ta\n-2\tb c\n3\t\n2147483647\ta\n";
+    }
+
+    SymbolTable symbolTable;
+    TupleList relation{2, {}};
+    IOSystem::getInstance()
+            .getReader(symbolMask, symbolTable, getDirectives("file", csvIn), false)
+            ->readAll(relation);
+    IOSystem::getInstance()
+            .getWriter(symbolMask, symbolTable, getDirectives("binary", binary), false)
+            ->writeAll(relation.data());
+
+    SymbolTable otherTable;
+    TupleList loaded{2, {}};
+    IOSystem::getInstance()
+            .getReader(symbolMask, otherTable, getDirectives("binary", binary), false)
+            ->readAll(loaded);
+    IOSystem::getInstance()
+            .getWriter(symbolMask, otherTable, getDirectives("file", csvOut), false)
+            ->writeAll(loaded.data());
+
+    EXPECT_EQ(readFile(csvIn), readFile(csvOut));
+    std::remove(csvIn.c_str());
+    std::remove(binary.c_str());
+    std::remove(csvOut.c_str());
+}
+
+TEST(BinaryIO, Nullary) {
+    const std::string fileName = "binary_io_test_nullary.bin";
+    const std::vector<bool> symbolMask;
+    SymbolTable symbolTable;
+    TupleList relation{0, {{}}};
+    IOSystem::getInstance()
+            .getWriter(symbolMask, symbolTable, getDirectives("binary", fileName), false)
+            ->writeAll(relation.data());
+
+    TupleList loaded{0, {}};
+    IOSystem::getInstance()
+            .getReader(symbolMask, symbolTable, getDirectives("binary", fileName), false)
+            ->readAll(loaded);
+    EXPECT_EQ(1, loaded.tuples.size());
+    std::remove(fileName.c_str());
+}
+
+TEST(BinaryIO, TypeMismatch) {
+    const std::string fileName = "binary_io_test_mismatch.bin";
+    SymbolTable symbolTable;
+    TupleList relation{2, {{1, 2}}};
+    IOSystem::getInstance()
+            .getWriter({false, false}, symbolTable, getDirectives("binary", fileName), false)
+            ->writeAll(relation.data());
+
+    bool failed = false;
+    try {
+        IOSystem::getInstance().getReader({false, true}, symbolTable, getDirectives("binary", fileName), false);
+    } catch (std::invalid_argument&) {
+        failed = true;
+    }
+    EXPECT_TRUE(failed);
+
+    failed = false;
+    try {
+        IOSystem::getInstance().getReader({false}, symbolTable, getDirectives("binary", fileName), false);
+    } catch (std::invalid_argument&) {
+        failed = true;
+    }
+    EXPECT_TRUE(failed);
+    std::remove(fileName.c_str());
+}
+
+TEST(BinaryIO, UndefinedSymbol) {
+    const std::string fileName = "binary_io_test_undefined.bin";
+    const std::vector<bool> symbolMask = {false, true};
+    SymbolTable symbolTable;
+    TupleList relation{2, {}};
+    for (RamDomain i = 0; i < 1500; ++i) {
+        relation.tuples.push_back({i, symbolTable.lookup("a")});
+    }
+    IOSystem::getInstance()
+            .getWriter(symbolMask, symbolTable, getDirectives("binary", fileName), false)
+            ->writeAll(relation.data());
+
+    // refer to an undefined symbol in the 101st tuple of the first block
+    std::string content = readFile(fileName);
+    const RamDomain numbers[] = {0, 1, 2, 3};
+    size_t column = content.find(std::string(reinterpret_cast<const char*>(numbers), sizeof(numbers)));
+    EXPECT_TRUE(column != std::string::npos);
+    RamDomain undefined = 7;
+    content.replace(column + (1024 + 100) * sizeof(RamDomain), sizeof(RamDomain),
+            reinterpret_cast<const char*>(&undefined), sizeof(RamDomain));
+    std::ofstream(fileName, std::ios::out | std::ios::binary).write(content.data(), content.size());
+
+    // the tuples decoded before the error are kept
+    TupleList loaded{2, {}};
+    bool failed = false;
+    try {
+        IOSystem::getInstance()
+                .getReader(symbolMask, symbolTable, getDirectives("binary", fileName), false)
+                ->readAll(loaded);
+    } catch (std::invalid_argument&) {
+        failed = true;
+    }
+    EXPECT_TRUE(failed);
+    EXPECT_EQ(100, loaded.tuples.size());
+    std::remove(fileName.c_str());
+}
+
+}  // end namespace test
@@ -512,6 +512,56 @@ TEST(EqRelTest, IterPartition) {
     EXPECT_EQ(br.size(), values.size());
 }
 
+TEST(EqRelTest, InterleavedIteration) {
+    // insertions and iterations alternate, as in a recursive stratum
+    EqRel br;
+    std::vector<std::set<RamDomain>> reference;
+    std::srand(7);
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 20; ++i) {
+            RamDomain a = std::rand() % 300;
+            RamDomain b = (i % 4 == 0) ? std::rand() % 300 : a + 1;
+            br.insert(a, b);
+
+            // merge the sets of a and b in the reference
+            std::set<RamDomain> merged = {a, b};
+            for (auto it = reference.begin(); it != reference.end();) {
+                if (it->count(a) != 0 || it->count(b) != 0) {
+                    merged.insert(it->begin(), it->end());
+                    it = reference.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            reference.push_back(merged);
+        }
+
+        if (round % 10 != 0) {
+            // a cheap scan of the set of one element
+            RamDomain e = *reference.back().begin();
+            auto r = br.getBoundaries<1>({{e, 0}});
+            EXPECT_EQ(reference.back().size(), std::distance(r.begin(), r.end()));
+            continue;
+        }
+
+        // a full scan
+        std::set<std::pair<RamDomain, RamDomain>> expected;
+        for (const auto& set : reference) {
+            for (auto a : set) {
+                for (auto b : set) {
+                    expected.insert(std::make_pair(a, b));
+                }
+            }
+        }
+        std::set<std::pair<RamDomain, RamDomain>> is;
+        for (const auto& cur : br) {
+            is.insert(std::make_pair(cur[0], cur[1]));
+        }
+        EXPECT_EQ(expected.size(), br.size());
+        EXPECT_TRUE(expected == is);
+    }
+}
+
 TEST(EqRelTest, Scaling) {
     const int N = 100;
 
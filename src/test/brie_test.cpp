@@ -17,6 +17,7 @@
 #include "Brie.h"
 #include "test.h"
 #include <cstring>
+#include <map>
 
 using namespace souffle;
 
@@ -267,6 +268,32 @@ TEST(SparseArray, Merge) {
     EXPECT_EQ("[(100,1),(500,2)]", toString(data));
 }
 
+TEST(SparseArray, MergeLarge) {
+    // arrays deep enough for their top-level branches to be merged in parallel
+    SparseArray<int> m1;
+    SparseArray<int> m2;
+    std::map<int, int> expected;
+
+    for (int i = 0; i < 1000000; i += 3) {
+        m1.update(i, i + 1);
+        expected[i] = i + 1;
+    }
+    for (int i = 0; i < 2000000; i += 5) {
+        m2.update(i, i + 1);
+        expected[i] = i + 1;
+    }
+
+    m1.addAll(m2);
+
+    std::map<int, int> data;
+    for (const auto& cur : m1) {
+        data[cur.first] = cur.second;
+    }
+    EXPECT_EQ(expected.size(), data.size());
+    EXPECT_TRUE(expected == data);
+    EXPECT_EQ(0, m1.begin()->first);
+}
+
 TEST(SparseArray, LowerBound) {
     SparseArray<int> m;
 
@@ -322,36 +349,39 @@ TEST(SparseArray, MemoryUsage) {
         // an empty one should be small
         EXPECT_TRUE(a.empty());
         // EXPECT_EQ(56, a.getMemoryUsage());
-        EXPECT_EQ(40, a.getMemoryUsage());
+        // EXPECT_EQ(40, a.getMemoryUsage());
+        EXPECT_EQ(56, a.getMemoryUsage());
 
         // a single element should have the same size as an empty one
         a.update(12, 15);
         EXPECT_FALSE(a.empty());
         // EXPECT_EQ(56, a.getMemoryUsage());
-        EXPECT_EQ(560, a.getMemoryUsage());
+        // EXPECT_EQ(560, a.getMemoryUsage());
+        EXPECT_EQ(576, a.getMemoryUsage());
 
         // more than one => there are nodes
         a.update(14, 18);
         EXPECT_FALSE(a.empty());
 
         // EXPECT_EQ(576, a.getMemoryUsage());
-        EXPECT_EQ(560, a.getMemoryUsage());
+        // EXPECT_EQ(560, a.getMemoryUsage());
+        EXPECT_EQ(576, a.getMemoryUsage());
     } else {
         SparseArray<int> a;
 
         // an empty one should be small
         EXPECT_TRUE(a.empty());
-        EXPECT_EQ(28, a.getMemoryUsage());
+        EXPECT_EQ(32, a.getMemoryUsage());
 
         // a single element should have the same size as an empty one
         a.update(12, 15);
         EXPECT_FALSE(a.empty());
-        EXPECT_EQ(288, a.getMemoryUsage());
+        EXPECT_EQ(292, a.getMemoryUsage());
 
         // more than one => there are nodes
         a.update(14, 18);
         EXPECT_FALSE(a.empty());
-        EXPECT_EQ(288, a.getMemoryUsage());
+        EXPECT_EQ(292, a.getMemoryUsage());
     }
 }
 
@@ -519,6 +549,15 @@ TEST(SparseBitMap, Find) {
     EXPECT_EQ("12", toString(*it));
     ++it;
     EXPECT_EQ("1400", toString(*it));
+
+    // iterators obtained by find continue within the same word
+    map.set(10);
+    map.set(14);
+    it = map.find(12);
+    ++it;
+    EXPECT_EQ("14", toString(*it));
+    ++it;
+    EXPECT_EQ("1400", toString(*it));
 }
 
 TEST(SparseBitMap, Size) {
@@ -534,6 +573,30 @@ TEST(SparseBitMap, Size) {
     EXPECT_EQ(3, map.size());
 }
 
+TEST(SparseBitMap, Partition) {
+    SparseBitMap<> map;
+    EXPECT_TRUE(map.partition(10).empty());
+
+    std::vector<int> all;
+    for (int i = 0; i < 100000; i += 3) {
+        map.set(i);
+        all.push_back(i);
+    }
+
+    for (unsigned chunks : {1, 10, 400, 100000}) {
+        // parts are only split between words of 64 bits
+        std::size_t limit = all.size() / chunks + 64;
+        std::vector<int> is;
+        for (const auto& part : map.partition(chunks)) {
+            std::size_t size = std::distance(part.begin(), part.end());
+            EXPECT_LT(0, size);
+            EXPECT_TRUE(size <= limit);
+            is.insert(is.end(), part.begin(), part.end());
+        }
+        EXPECT_EQ(all, is);
+    }
+}
+
 TEST(SparseBitMap, CopyAndMerge) {
     SparseBitMap<> mapA;
     SparseBitMap<> mapB;
@@ -1180,6 +1243,39 @@ TEST(Trie, Merge_Bug) {
     EXPECT_EQ(5, count);
 }
 
+TEST(Trie, Partition) {
+    Trie<3> set;
+    EXPECT_TRUE(set.partition(10).empty());
+
+    // a skewed trie with few values on the first two levels
+    std::vector<Trie<3>::entry_type> all;
+    for (RamDomain i = 0; i < 3; i++) {
+        for (RamDomain j = 0; j < 2; j++) {
+            for (RamDomain k = 0; k < 20000; k++) {
+                set.insert(i, j, k * 7);
+                all.push_back({{i, j, k * 7}});
+            }
+        }
+    }
+    set.insert(5, 0, 0);
+    all.push_back({{5, 0, 0}});
+
+    for (unsigned chunks : {1, 10, 400, 1000000}) {
+        // parts are split at any level, but only between words of 64 bits
+        std::size_t limit = all.size() / chunks + 64;
+        std::vector<Trie<3>::entry_type> is;
+        auto parts = set.partition(chunks);
+        for (const auto& part : parts) {
+            std::size_t size = std::distance(part.begin(), part.end());
+            EXPECT_LT(0, size);
+            EXPECT_TRUE(size <= limit);
+            is.insert(is.end(), part.begin(), part.end());
+        }
+        EXPECT_EQ(all, is);
+        EXPECT_TRUE(std::min<std::size_t>(chunks, all.size() / 64) / 2 <= parts.size());
+    }
+}
+
 TEST(Trie, Size) {
     Trie<2> t;
 
@@ -1215,6 +1311,61 @@ TEST(Trie, Size) {
     EXPECT_EQ(5, t.size());
 }
 
+TEST(Trie, Reset) {
+    Trie<2> t;
+
+    for (int r = 0; r < 3; ++r) {
+        for (int i = 0; i < 1000; ++i) {
+            t.insert(i % 37, i + r);
+        }
+        EXPECT_EQ(1000, t.size());
+        EXPECT_TRUE(t.contains({5, 5 + r}));
+        EXPECT_FALSE(t.contains({5, 6 + r}));
+
+        // the memory of the cleared trie is reused by the next round
+        t.reset();
+        EXPECT_TRUE(t.empty());
+        EXPECT_EQ(0, t.size());
+        EXPECT_TRUE(t.begin() == t.end());
+    }
+
+    Trie<1> u;
+    u.insert(12);
+    u.reset();
+    EXPECT_TRUE(u.empty());
+    u.insert(14);
+    EXPECT_EQ(1, u.size());
+    EXPECT_FALSE(u.contains({12}));
+}
+
+TEST(Trie, CopyMove) {
+    Trie<3> a;
+    for (int i = 0; i < 1000; ++i) {
+        a.insert(i % 7, i % 13, i);
+    }
+
+    // copies hold all levels on their own
+    Trie<3> b = a;
+    a.reset();
+    a.insert(1, 2, 3);
+    EXPECT_EQ(1000, b.size());
+    EXPECT_TRUE(b.contains({5, 5, 5}));
+    EXPECT_FALSE(b.contains({1, 2, 3}));
+
+    b = a;
+    EXPECT_EQ(1, b.size());
+    EXPECT_TRUE(b.contains({1, 2, 3}));
+
+    // moves take over the arena including all nested levels
+    Trie<3> c = std::move(a);
+    EXPECT_EQ(1, c.size());
+    EXPECT_TRUE(c.contains({1, 2, 3}));
+    EXPECT_TRUE(a.empty());
+    a.insert(4, 5, 6);
+    EXPECT_EQ(1, a.size());
+    EXPECT_FALSE(c.contains({4, 5, 6}));
+}
+
 TEST(Trie, Limits) {
     Trie<2> data;
 
@@ -355,6 +355,33 @@ TEST(BTreeMultiSet, Load) {
     }
 }
 
+TEST(BTreeMultiSet, BulkInsert) {
+    using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    for (int N = 0; N < 500; N += 7) {
+        std::vector<int> data;
+        for (int i = 0; i < N; i++) {
+            data.push_back(i / 2);
+        }
+        random_shuffle(data.begin(), data.end());
+
+        // duplicates are retained, both within the range and with present elements
+        test_set t;
+        for (int i = 0; i < N; i += 3) {
+            t.insert(i / 2);
+        }
+        t.insert(data.begin(), data.end());
+        EXPECT_TRUE(t.check());
+
+        std::multiset<int> expected(data.begin(), data.end());
+        for (int i = 0; i < N; i += 3) {
+            expected.insert(i / 2);
+        }
+        EXPECT_EQ(expected.size(), t.size());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), t.begin()));
+    }
+}
+
 TEST(BTreeMultiSet, Clear) {
     using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -15,6 +15,8 @@
  ***********************************************************************/
 
 #include "BTree.h"
+#include "CompiledIndexUtils.h"
+#include "CompiledTuple.h"
 #include "test.h"
 
 #include <algorithm>
@@ -450,6 +452,58 @@ TEST(BTreeSet, BoundaryEmpty) {
     EXPECT_NE(t.lower_bound(5), t.upper_bound(5));
 }
 
+TEST(BTreeSet, SimdSearch) {
+    using int_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 256, detail::simd_search>;
+    using tuple = ram::Tuple<RamDomain, 3>;
+    using tuple_set = btree_set<tuple, ram::index_utils::comparator<2, 0, 1>, std::allocator<tuple>, 256,
+            detail::simd_search>;
+
+    std::set<int> ints;
+    std::set<std::tuple<RamDomain, RamDomain, RamDomain>> tuples;
+    int_set a;
+    tuple_set b;
+    srand(3);
+    for (int i = 0; i < 20000; i++) {
+        int v = rand() % 10000 - 5000;
+        ints.insert(v);
+        a.insert(v);
+        tuple t{{rand() % 50, rand() % 50, rand() % 200 - 100}};
+        tuples.insert(std::make_tuple(t[2], t[0], t[1]));
+        b.insert(t);
+    }
+    EXPECT_EQ(ints.size(), a.size());
+    EXPECT_EQ(tuples.size(), b.size());
+
+    bool allMatch = true;
+    for (int v = -5100; v < 5100; v++) {
+        auto lb = ints.lower_bound(v);
+        auto ub = ints.upper_bound(v);
+        allMatch = allMatch && (a.contains(v) == (ints.count(v) == 1));
+        allMatch = allMatch && (lb == ints.end() ? a.lower_bound(v) == a.end() : *a.lower_bound(v) == *lb);
+        allMatch = allMatch && (ub == ints.end() ? a.upper_bound(v) == a.end() : *a.upper_bound(v) == *ub);
+    }
+    EXPECT_TRUE(allMatch);
+
+    allMatch = true;
+    for (RamDomain z = -101; z < 101; z += 3) {
+        for (RamDomain x = 0; x < 50; x += 7) {
+            for (RamDomain y = 0; y < 50; y++) {
+                tuple t{{x, y, z}};
+                auto lb = tuples.lower_bound(std::make_tuple(z, x, y));
+                auto res = b.lower_bound(t);
+                allMatch = allMatch && (b.contains(t) == (tuples.count(std::make_tuple(z, x, y)) == 1));
+                if (lb == tuples.end()) {
+                    allMatch = allMatch && res == b.end();
+                } else {
+                    allMatch = allMatch && res != b.end() &&
+                               std::make_tuple((*res)[2], (*res)[0], (*res)[1]) == *lb;
+                }
+            }
+        }
+    }
+    EXPECT_TRUE(allMatch);
+}
+
 TEST(BTreeSet, Load) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -476,6 +530,123 @@ TEST(BTreeSet, Load) {
     }
 }
 
+TEST(BTreeSet, BulkInsert) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    for (int N = 0; N < 500; N += 7) {
+        // sorted input with duplicates, shuffled input and input merged into a non-empty tree
+        std::vector<int> sorted;
+        for (int i = 0; i < N; i++) {
+            sorted.push_back(i / 2);
+        }
+        std::vector<int> shuffled = sorted;
+        random_shuffle(shuffled.begin(), shuffled.end());
+
+        test_set a(sorted.begin(), sorted.end());
+        test_set b(shuffled.begin(), shuffled.end());
+        EXPECT_TRUE(a.check());
+        EXPECT_TRUE(b.check());
+        EXPECT_EQ((N + 1) / 2, a.size());
+        EXPECT_EQ(a, b);
+
+        test_set c;
+        for (int i = 0; i < N; i += 3) {
+            c.insert(i);
+        }
+        c.insert(shuffled.begin(), shuffled.end());
+        EXPECT_TRUE(c.check());
+
+        std::set<int> expected(sorted.begin(), sorted.end());
+        for (int i = 0; i < N; i += 3) {
+            expected.insert(i);
+        }
+        EXPECT_EQ(expected.size(), c.size());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), c.begin()));
+    }
+}
+
+TEST(BTreeSet, BulkMerge) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    // merge trees of all size ratios, covering both the rebuild and the element-wise path
+    for (int N : {0, 1, 10, 100, 1000, 10000}) {
+        for (int M : {0, 1, 10, 100, 1000, 10000}) {
+            test_set a;
+            test_set b;
+            std::set<int> expected;
+            for (int i = 0; i < N; i++) {
+                a.insert(i * 2);
+                expected.insert(i * 2);
+            }
+            for (int i = 0; i < M; i++) {
+                b.insert(i * 3);
+                expected.insert(i * 3);
+            }
+
+            EXPECT_EQ(expected.size() - N, a.insertAll(b));
+            EXPECT_TRUE(a.check());
+            EXPECT_EQ(expected.size(), a.size());
+            EXPECT_TRUE(std::equal(expected.begin(), expected.end(), a.begin()));
+
+            // the merged tree remains fully functional
+            a.insert(-1);
+            EXPECT_TRUE(a.contains(-1));
+            EXPECT_EQ(expected.size() + 1, a.size());
+            EXPECT_TRUE(a.check());
+        }
+    }
+}
+
+TEST(BTreeSet, ParallelMerge) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    // ranges large enough to be split into parts processed by different threads
+    for (int M : {100, 100000}) {
+        test_set t;
+        std::set<int> expected;
+        for (int i = 0; i < 200000; i += 4) {
+            t.insert(i);
+            expected.insert(i);
+        }
+
+        std::vector<int> data;
+        for (int i = 0; i < M; i++) {
+            data.push_back((i * 7) % 300000);
+        }
+        random_shuffle(data.begin(), data.end());
+        expected.insert(data.begin(), data.end());
+
+        t.insert(data.begin(), data.end());
+        EXPECT_TRUE(t.check());
+        EXPECT_EQ(expected.size(), t.size());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), t.begin()));
+    }
+}
+
+TEST(BTreeSet, ConcurrentRangeInsert) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    // ranges inserted concurrently race for building the empty tree
+    for (int M : {10, 10000}) {
+        test_set t;
+#pragma omp parallel for
+        for (int i = 0; i < 8; i++) {
+            std::vector<int> data;
+            for (int j = 0; j < M; j++) {
+                data.push_back(j * 8 + i);
+            }
+            random_shuffle(data.begin(), data.end());
+            t.insert(data.begin(), data.end());
+        }
+        EXPECT_TRUE(t.check());
+        EXPECT_EQ(8 * M, t.size());
+        int expected = 0;
+        for (int cur : t) {
+            EXPECT_EQ(expected++, cur);
+        }
+    }
+}
+
 TEST(BTreeSet, Clear) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -493,6 +664,41 @@ TEST(BTreeSet, Clear) {
     EXPECT_TRUE(t.empty());
 }
 
+TEST(BTreeSet, Reset) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    test_set t;
+    for (int r = 0; r < 3; ++r) {
+        for (int i = 0; i < 1000; ++i) {
+            t.insert(i * (r + 1));
+        }
+        EXPECT_EQ(1000, t.size());
+        EXPECT_TRUE(t.check());
+        EXPECT_TRUE(t.contains(999 * (r + 1)));
+
+        // the memory of the cleared tree is reused by the next round
+        t.reset();
+        EXPECT_TRUE(t.empty());
+        EXPECT_TRUE(t.begin() == t.end());
+    }
+
+    // copies and swaps do not share nodes
+    for (int i = 0; i < 100; ++i) {
+        t.insert(i);
+    }
+    test_set c = t;
+    test_set s;
+    s.swap(c);
+    t.reset();
+    for (int i = 100; i < 200; ++i) {
+        t.insert(i);
+    }
+    EXPECT_EQ(100, s.size());
+    EXPECT_TRUE(s.contains(50));
+    EXPECT_FALSE(s.contains(150));
+    EXPECT_TRUE(c.empty());
+}
+
 TEST(BTreeSet, ChunkSplit) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -696,6 +902,28 @@ TEST(Performance, Basic) {
     checkPerformance(t3, "souffle btree_set - 256 - binary", in, out);
 }
 
+TEST(Performance, SearchStrategies) {
+    int N = 1 << 18;
+
+    using tuple = ram::Tuple<RamDomain, 2>;
+    std::vector<tuple> in;
+    std::vector<tuple> out;
+    for (const auto& cur : getData(2 * N)) {
+        (in.size() == out.size() ? in : out).push_back(tuple{{std::get<0>(cur), std::get<1>(cur)}});
+    }
+
+    using comp = ram::index_utils::comparator<0, 1>;
+
+    using t1 = btree_set<tuple, comp, std::allocator<tuple>, 256, detail::linear_search>;
+    checkPerformance(t1, "souffle btree_set<ram::Tuple> - 256 - linear", in, out);
+
+    using t2 = btree_set<tuple, comp, std::allocator<tuple>, 256, detail::binary_search>;
+    checkPerformance(t2, "souffle btree_set<ram::Tuple> - 256 - binary", in, out);
+
+    using t3 = btree_set<tuple, comp, std::allocator<tuple>, 256, detail::simd_search>;
+    checkPerformance(t3, "souffle btree_set<ram::Tuple> - 256 - simd", in, out);
+}
+
 TEST(Performance, Load) {
     //        int N = 1<<24;
     int N = 1 << 20;
@@ -705,6 +933,14 @@ TEST(Performance, Load) {
         data.push_back(i);
     }
 
+    // take time for element-wise insertion
+    time("element-wise insert", [&]() {
+        btree_set<int> t;
+        for (int i : data) {
+            t.insert(i);
+        }
+    });
+
     // take time for conventional load
     time("conventional load", [&]() { btree_set<int> t(data.begin(), data.end()); });
 
@@ -712,6 +948,112 @@ TEST(Performance, Load) {
     time("bulk-load", [&]() { auto t = btree_set<int>::load(data.begin(), data.end()); });
 }
 
+TEST(Performance, Merge) {
+    int N = 1 << 20;
+
+    btree_set<int> full;
+    btree_set<int> delta;
+    for (int i = 0; i < N; i++) {
+        full.insert(i * 2);
+        delta.insert(i * 2 + 1);
+    }
+
+    // take time for element-wise merge
+    time("element-wise merge", [&]() {
+        btree_set<int> t = full;
+        btree_set<int>::operation_hints hints;
+        for (int i : delta) {
+            t.insert(i, hints);
+        }
+    });
+
+    // take time for bulk merge
+    time("bulk merge", [&]() {
+        btree_set<int> t = full;
+        t.insertAll(delta);
+    });
+}
+
+TEST(Performance, Reset) {
+    int N = 1 << 16;
+    int R = 64;
+
+    // take time for refilling a cleared tree, as done with delta relations
+    time("clear and refill", [&]() {
+        btree_set<int> t;
+        for (int r = 0; r < R; r++) {
+            t.clear();
+            for (int i = 0; i < N; i++) {
+                t.insert(i * 7 + r);
+            }
+        }
+    });
+
+    // take time for refilling a tree whose memory is retained
+    time("reset and refill", [&]() {
+        btree_set<int> t;
+        for (int r = 0; r < R; r++) {
+            t.reset();
+            for (int i = 0; i < N; i++) {
+                t.insert(i * 7 + r);
+            }
+        }
+    });
+}
+
+/** Fill a set with the given node size and query it, true if all queries are answered correctly */
+template <unsigned NodeSize, typename Tuple>
+bool checkNodeSize(const std::vector<Tuple>& in, const std::vector<Tuple>& out) {
+    using set_type = btree_set<Tuple, detail::comparator<Tuple>, std::allocator<Tuple>, NodeSize>;
+    std::cout << "Testing: arity " << Tuple::arity << " - " << NodeSize << " bytes ..\n";
+    set_type set;
+    time("filling set", [&]() {
+        for (const auto& cur : in) {
+            set.insert(cur);
+        }
+    });
+    bool allFound = true;
+    time("membership in", [&]() {
+        for (const auto& cur : in) {
+            allFound = set.contains(cur) && allFound;
+        }
+    });
+    bool allMissing = true;
+    time("membership out", [&]() {
+        for (const auto& cur : out) {
+            allMissing = !set.contains(cur) && allMissing;
+        }
+    });
+    std::cout << "\tmemory: " << set.getMemoryUsage() / 1024 << " KB, depth: " << set.getDepth() << "\n\n";
+    return set.size() == in.size() && allFound && allMissing;
+}
+
+template <unsigned Arity>
+bool checkNodeSizes(int N) {
+    using tuple = ram::Tuple<RamDomain, Arity>;
+    std::vector<tuple> in;
+    std::vector<tuple> out;
+    for (const auto& cur : getData(2 * N)) {
+        tuple t;
+        for (unsigned i = 0; i < Arity; i++) {
+            t[i] = (i % 2 == 0) ? std::get<0>(cur) : std::get<1>(cur);
+        }
+        (in.size() == out.size() ? in : out).push_back(t);
+    }
+    bool ok = checkNodeSize<128>(in, out);
+    ok = checkNodeSize<256>(in, out) && ok;
+    ok = checkNodeSize<512>(in, out) && ok;
+    ok = checkNodeSize<1024>(in, out) && ok;
+    ok = checkNodeSize<2048>(in, out) && ok;
+    return checkNodeSize<4096>(in, out) && ok;
+}
+
+TEST(Performance, NodeSizes) {
+    int N = 1 << 18;
+    EXPECT_TRUE(checkNodeSizes<2>(N));
+    EXPECT_TRUE(checkNodeSizes<4>(N));
+}
+
 TEST(BTreeSet, Parallel) {
     //        const int N = 600000000;
     //        const int N = 100000;
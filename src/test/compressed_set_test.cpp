@@ -0,0 +1,179 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file compressed_set_test.cpp
+ *
+ * A test case testing the front-coded tuple set.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "BTree.h"
+#include "CompressedSet.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace souffle;
+
+namespace test {
+
+using Entry = ram::Tuple<RamDomain, 3>;
+
+TEST(CompressedSet, Basic) {
+    CompressedSet<3> set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_TRUE(set.begin() == set.end());
+
+    EXPECT_TRUE(set.insert({{1, 2, 3}}));
+    EXPECT_FALSE(set.insert({{1, 2, 3}}));
+    EXPECT_TRUE(set.insert({{1, 2, 4}}));
+    EXPECT_TRUE(set.insert({{0, 5, 5}}));
+    EXPECT_TRUE(set.insert({{-7, 0, -1}}));
+
+    EXPECT_EQ(4, set.size());
+    EXPECT_TRUE(set.contains({{1, 2, 3}}));
+    EXPECT_TRUE(set.contains({{-7, 0, -1}}));
+    EXPECT_FALSE(set.contains({{1, 2, 5}}));
+    EXPECT_FALSE(set.contains({{-8, 0, 0}}));
+
+    std::vector<Entry> order(set.begin(), set.end());
+    std::vector<Entry> expected = {{{-7, 0, -1}}, {{0, 5, 5}}, {{1, 2, 3}}, {{1, 2, 4}}};
+    EXPECT_EQ(expected, order);
+}
+
+TEST(CompressedSet, Extremes) {
+    CompressedSet<2> set;
+    const RamDomain min = std::numeric_limits<RamDomain>::min();
+    const RamDomain max = std::numeric_limits<RamDomain>::max();
+    set.insert({{max, min}});
+    set.insert({{min, max}});
+    set.insert({{0, 0}});
+    set.insert({{min, min}});
+    set.insert({{max, max}});
+
+    std::vector<ram::Tuple<RamDomain, 2>> order(set.begin(), set.end());
+    std::vector<ram::Tuple<RamDomain, 2>> expected = {
+            {{min, min}}, {{min, max}}, {{0, 0}}, {{max, min}}, {{max, max}}};
+    EXPECT_EQ(expected, order);
+}
+
+TEST(CompressedSet, Random) {
+    std::mt19937 rand(42);
+    std::uniform_int_distribution<RamDomain> dist(-50, 50);
+
+    CompressedSet<3> set;
+    std::set<Entry> reference;
+    for (int i = 0; i < 100000; ++i) {
+        Entry e = {{dist(rand), dist(rand), dist(rand)}};
+        EXPECT_EQ(reference.insert(e).second, set.insert(e));
+    }
+    EXPECT_EQ(reference.size(), set.size());
+    EXPECT_TRUE(std::equal(reference.begin(), reference.end(), set.begin()));
+
+    // all prefix queries agree with the reference
+    for (RamDomain a = -51; a <= 51; a += 3) {
+        auto r = set.getBoundaries<1>({{a, 0, 0}});
+        EXPECT_EQ(std::count_if(reference.begin(), reference.end(), [&](const Entry& e) { return e[0] == a; }),
+                std::distance(r.begin(), r.end()));
+        for (RamDomain b = -51; b <= 51; b += 7) {
+            auto r = set.getBoundaries<2>({{a, b, 0}});
+            std::vector<Entry> found(r.begin(), r.end());
+            std::vector<Entry> expected;
+            for (const auto& e : reference) {
+                if (e[0] == a && e[1] == b) {
+                    expected.push_back(e);
+                }
+            }
+            EXPECT_EQ(expected, found);
+        }
+    }
+
+    // the partitions cover the set in order
+    std::vector<Entry> partitioned;
+    for (const auto& chunk : set.partition(100)) {
+        partitioned.insert(partitioned.end(), chunk.begin(), chunk.end());
+    }
+    EXPECT_TRUE(std::equal(reference.begin(), reference.end(), partitioned.begin()));
+    EXPECT_EQ(reference.size(), partitioned.size());
+}
+
+TEST(CompressedSet, ParallelInsert) {
+    CompressedSet<2> set;
+    const RamDomain n = 200;
+
+    // every thread inserts tuples interleaved with those of the others, including duplicates
+    std::atomic<std::size_t> inserted(0);
+#pragma omp parallel
+    {
+        CompressedSet<2>::op_context ctxt;
+#pragma omp for schedule(static, 7)
+        for (RamDomain i = n * n - 1; i >= 0; --i) {
+            inserted += set.insert({{i % n, i / n}}, ctxt);
+            set.insert({{i % n, i / n}}, ctxt);
+        }
+    }
+
+    EXPECT_EQ(n * n, inserted);
+    EXPECT_EQ(n * n, set.size());
+    RamDomain i = 0;
+    for (const auto& cur : set) {
+        EXPECT_EQ(i / n, cur[0]);
+        EXPECT_EQ(i % n, cur[1]);
+        ++i;
+    }
+    EXPECT_EQ(n * n, i);
+}
+
+TEST(CompressedSet, Hints) {
+    CompressedSet<2> set;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        set.insert({{i / 10, i % 10}});
+    }
+    CompressedSet<2>::op_context ctxt;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(set.contains({{i / 10, i % 10}}, ctxt));
+        EXPECT_FALSE(set.contains({{i / 10, 10}}, ctxt));
+        auto r = set.getBoundaries<1>({{i / 10, 0}}, ctxt);
+        EXPECT_EQ(10, std::distance(r.begin(), r.end()));
+    }
+
+    // removing blocks invalidates the hints
+    set.clear();
+    EXPECT_FALSE(set.contains({{0, 0}}, ctxt));
+    set.insert({{5, 5}});
+    EXPECT_TRUE(set.contains({{5, 5}}, ctxt));
+    EXPECT_EQ(1, std::distance(set.begin(), set.end()));
+}
+
+TEST(CompressedSet, MemoryUsage) {
+    // a wide relation whose tuples share long prefixes with their neighbours
+    using Wide = ram::Tuple<RamDomain, 8>;
+    CompressedSet<8> set;
+    btree_set<Wide> tree;
+    for (RamDomain i = 0; i < 100000; ++i) {
+        Wide t = {{1, i / 1000, 7, i / 100, 3, i / 10, 42, i}};
+        set.insert(t);
+        tree.insert(t);
+    }
+    EXPECT_EQ(tree.size(), set.size());
+    EXPECT_TRUE(std::equal(tree.begin(), tree.end(), set.begin()));
+
+    // the uncompressed tuples alone occupy 32 bytes each
+    EXPECT_LT(set.getMemoryUsage() * 4, tree.size() * sizeof(Wide));
+    EXPECT_LT(set.getMemoryUsage() * 4, tree.getMemoryUsage());
+}
+
+}  // end namespace test
@@ -18,6 +18,7 @@
 #include "test.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <set>
@@ -482,8 +483,93 @@ TEST(SparseDjTest, ParallelTest) {
     EXPECT_EQ(sds.size(), N);
 }
 
+TEST(SparseDjTest, ParallelChains) {
+    // concurrent unions forming long chains, followed by concurrent finds
+    setenv("SOUFFLE_PROFILE_HINTS", "1", 1);
+    souffle::SparseDisjointSet<size_t> sds;
+    unsetenv("SOUFFLE_PROFILE_HINTS");
+    constexpr size_t N = 100000;
+
+#pragma omp parallel for
+    for (size_t i = 0; i < N; ++i) {
+        sds.makeNode(i * 7919);
+    }
+
+#pragma omp parallel for
+    for (size_t i = 0; i < N - 1; ++i) {
+        sds.unionNodes(((i * 31) % N) * 7919, ((i * 31 + 1) % N) * 7919);
+    }
+
+    size_t rep = sds.findNode(0);
+    size_t mismatches = 0;
+#pragma omp parallel for reduction(+ : mismatches)
+    for (size_t i = 0; i < N; ++i) {
+        mismatches += (sds.findNode(i * 7919) != rep);
+    }
+    EXPECT_EQ(0, mismatches);
+    EXPECT_EQ(N, sds.size());
+
+    const auto& stats = sds.getStatistics();
+    EXPECT_EQ(N - 1, stats.getUnions());
+    EXPECT_TRUE(stats.getFinds() >= N);
+}
+
 #endif  // ifdef _OPENMP
 
+TEST(SparseDjTest, SparseToDenseMap) {
+    souffle::SparseToDenseMap<ssize_t> map;
+    EXPECT_FALSE(map.contains(0));
+
+    parent_t next = 0;
+    auto create = [&](ssize_t) { return next++; };
+    for (ssize_t i = -5000; i < 5000; ++i) {
+        EXPECT_EQ((parent_t)(i + 5000), map.insert(i * 3, create));
+    }
+    // present keys are not created again
+    for (ssize_t i = -5000; i < 5000; ++i) {
+        EXPECT_EQ((parent_t)(i + 5000), map.insert(i * 3, create));
+        EXPECT_EQ((parent_t)(i + 5000), map.lookup(i * 3));
+        EXPECT_FALSE(map.contains(i * 3 + 1));
+    }
+    EXPECT_EQ(10000, next);
+
+    map.clear();
+    EXPECT_FALSE(map.contains(0));
+    EXPECT_EQ(10000, map.insert(0, create));
+}
+
+TEST(SparseDjTest, Statistics) {
+    souffle::DisjointSetStatistics inactive(false);
+    inactive.addFind(3);
+    inactive.addUnion();
+    EXPECT_EQ(0, inactive.getFinds());
+    EXPECT_EQ(0, inactive.getUnions());
+
+    setenv("SOUFFLE_PROFILE_HINTS", "1", 1);
+    souffle::SparseDisjointSet<size_t> sds;
+    unsetenv("SOUFFLE_PROFILE_HINTS");
+    const auto& stats = sds.getStatistics();
+    EXPECT_TRUE(stats.isActive());
+
+    // a chain built by attaching roots of equal rank
+    for (size_t i = 0; i < 8; ++i) {
+        sds.makeNode(i);
+    }
+    EXPECT_TRUE(sds.unionNodes(0, 1));
+    EXPECT_TRUE(sds.unionNodes(2, 3));
+    EXPECT_TRUE(sds.unionNodes(0, 2));
+    EXPECT_FALSE(sds.unionNodes(1, 3));
+    EXPECT_EQ(3, stats.getUnions());
+    EXPECT_EQ(0, stats.getCasRetries());
+    EXPECT_TRUE(stats.getFinds() > 0);
+    EXPECT_TRUE(stats.getMaxFindDepth() <= 2);
+    EXPECT_TRUE(stats.getFindSteps() >= stats.getMaxFindDepth());
+
+    sds.clear();
+    EXPECT_EQ(0, stats.getFinds());
+    EXPECT_EQ(0, stats.getUnions());
+}
+
 typedef std::pair<size_t, size_t> TestPair;
 typedef souffle::LambdaBTreeSet<TestPair, std::function<TestPair::second_type(TestPair&)>,
         souffle::EqrelMapComparator<TestPair>>
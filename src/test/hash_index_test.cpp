@@ -0,0 +1,211 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file hash_index_test.cpp
+ *
+ * A test case testing the hash index and comparing it with b-trees.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "BTree.h"
+#include "CompiledIndexUtils.h"
+#include "HashIndex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace souffle;
+
+namespace test {
+
+using Entry = ram::Tuple<RamDomain, 3>;
+
+TEST(HashIndex, Set) {
+    HashIndex<3> set(7);
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(set.begin() == set.end());
+
+    EXPECT_TRUE(set.insert({{1, 2, 3}}));
+    EXPECT_FALSE(set.insert({{1, 2, 3}}));
+    EXPECT_TRUE(set.insert({{1, 2, 4}}));
+    EXPECT_TRUE(set.insert({{-1, 0, 0}}));
+    EXPECT_EQ(3, set.size());
+
+    EXPECT_TRUE(set.contains({{1, 2, 3}}));
+    EXPECT_TRUE(set.contains({{-1, 0, 0}}));
+    EXPECT_FALSE(set.contains({{1, 2, 5}}));
+
+    std::set<Entry> all(set.begin(), set.end());
+    EXPECT_EQ((std::set<Entry>{{{1, 2, 3}}, {{1, 2, 4}}, {{-1, 0, 0}}}), all);
+}
+
+TEST(HashIndex, Secondary) {
+    // keyed by the first and the last column
+    HashIndex<3> index(5);
+    std::set<Entry> reference;
+    for (RamDomain i = 0; i < 10000; ++i) {
+        Entry e = {{i % 10, i, i % 7}};
+        reference.insert(e);
+        EXPECT_TRUE(index.insert(e));
+    }
+    EXPECT_EQ(10000, index.size());
+
+    for (RamDomain a = 0; a < 11; ++a) {
+        for (RamDomain c = 0; c < 8; ++c) {
+            auto r = index.equalRange({{a, -1, c}});
+            std::set<Entry> found(r.begin(), r.end());
+            std::set<Entry> expected;
+            for (const auto& e : reference) {
+                if (e[0] == a && e[2] == c) {
+                    expected.insert(e);
+                }
+            }
+            EXPECT_EQ(expected, found);
+            EXPECT_EQ(!expected.empty(), index.contains({{a, 42, c}}));
+        }
+    }
+}
+
+TEST(HashIndex, Partition) {
+    HashIndex<3> set(7);
+    for (RamDomain i = 0; i < 50000; ++i) {
+        set.insert({{i, i % 3, -i}});
+    }
+    for (unsigned chunks : {1, 7, 100, 100000}) {
+        std::vector<Entry> found;
+        for (const auto& part : set.partition(chunks)) {
+            EXPECT_FALSE(part.empty());
+            found.insert(found.end(), part.begin(), part.end());
+        }
+        EXPECT_EQ(set.size(), found.size());
+        EXPECT_EQ(set.size(), std::set<Entry>(found.begin(), found.end()).size());
+    }
+}
+
+TEST(HashIndex, Reset) {
+    HashIndex<3> set(7);
+    for (int round = 0; round < 3; ++round) {
+        for (RamDomain i = 0; i < 1000; ++i) {
+            EXPECT_TRUE(set.insert({{round, i, i}}));
+        }
+        EXPECT_EQ(1000, set.size());
+        EXPECT_EQ(1000, std::distance(set.begin(), set.end()));
+        EXPECT_FALSE(set.contains({{round - 1, 0, 0}}));
+        set.reset();
+        EXPECT_TRUE(set.empty());
+    }
+    set.insert({{1, 1, 1}});
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(HashIndex, Parallel) {
+    HashIndex<3> set(7);
+    HashIndex<3> index(1);
+    const int N = 100000;
+#pragma omp parallel for
+    for (int i = 0; i < N; ++i) {
+        // every tuple is inserted twice
+        Entry e = {{(i / 2) % 100, i / 2, 0}};
+        if (set.insert(e)) {
+            index.insert(e);
+        }
+    }
+    EXPECT_EQ(N / 2, set.size());
+    EXPECT_EQ(N / 2, index.size());
+    auto r = index.equalRange({{5, 0, 0}});
+    EXPECT_EQ(N / 200, std::distance(r.begin(), r.end()));
+}
+
+namespace {
+
+template <typename Op>
+long time(const std::string& name, const Op& operation) {
+    std::cout << "\t" << std::setw(40) << std::setiosflags(std::ios::left) << name
+              << std::resetiosflags(std::ios::left) << " ... " << std::flush;
+    auto a = std::chrono::high_resolution_clock::now();
+    operation();
+    auto b = std::chrono::high_resolution_clock::now();
+    long time = std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count();
+    std::cout << " done [" << std::setw(5) << time << "ms]\n";
+    return time;
+}
+
+}  // namespace
+
+TEST(Performance, HashIndex) {
+    const int N = 1 << 20;
+    std::mt19937 rand(1);
+    std::uniform_int_distribution<RamDomain> dist(0, N);
+    std::vector<Entry> in;
+    std::vector<Entry> out;
+    for (int i = 0; i < 2 * N; ++i) {
+        (i % 2 == 0 ? in : out).push_back({{dist(rand), dist(rand), dist(rand)}});
+    }
+
+    // existence checks binding all columns, and scans binding the first two
+    HashIndex<3> hashSet(7);
+    HashIndex<3> hashIndex(3);
+    btree_set<Entry, ram::index_utils::comparator<0, 1, 2>> treeSet;
+    std::size_t hashHits = 0;
+    std::size_t treeHits = 0;
+
+    time("hash index - insert", [&]() {
+        for (const auto& cur : in) {
+            if (hashSet.insert(cur)) {
+                hashIndex.insert(cur);
+            }
+        }
+    });
+    time("btree - insert", [&]() {
+        for (const auto& cur : in) {
+            treeSet.insert(cur);
+        }
+    });
+
+    time("hash index - existence checks", [&]() {
+        for (int i = 0; i < N; ++i) {
+            hashHits += hashSet.contains(in[i]) + hashSet.contains(out[i]);
+        }
+    });
+    time("btree - existence checks", [&]() {
+        for (int i = 0; i < N; ++i) {
+            treeHits += treeSet.contains(in[i]) + treeSet.contains(out[i]);
+        }
+    });
+    EXPECT_EQ(hashHits, treeHits);
+
+    time("hash index - equality scans", [&]() {
+        for (const auto& cur : in) {
+            for (const auto& t : hashIndex.equalRange(cur)) {
+                hashHits += t[2];
+            }
+        }
+    });
+    time("btree - equality scans", [&]() {
+        for (const auto& cur : in) {
+            Entry low = {{cur[0], cur[1], MIN_RAM_DOMAIN}};
+            Entry high = {{cur[0], cur[1], MAX_RAM_DOMAIN}};
+            for (const auto& t : make_range(treeSet.lower_bound(low), treeSet.upper_bound(high))) {
+                treeHits += t[2];
+            }
+        }
+    });
+    EXPECT_EQ(hashHits, treeHits);
+}
+
+}  // end namespace test
@@ -0,0 +1,126 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file leapfrog_join_test.cpp
+ *
+ * A test case testing the leapfrog triejoin.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "LeapfrogTrieJoin.h"
+
+#include <array>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace souffle;
+
+namespace test {
+
+using Pair = std::array<RamDomain, 2>;
+using Triple = std::array<RamDomain, 3>;
+
+/** A binary relation sorted by the given order of its columns */
+class SortedRelation {
+    struct Less {
+        std::vector<size_t> order;
+        bool operator()(const Pair& a, const Pair& b) const {
+            for (size_t column : order) {
+                if (a[column] != b[column]) {
+                    return a[column] < b[column];
+                }
+            }
+            return false;
+        }
+    };
+
+public:
+    SortedRelation(const std::set<Pair>& tuples, std::vector<size_t> order)
+            : order(order), index(tuples.begin(), tuples.end(), Less{order}) {}
+
+    std::unique_ptr<TrieIterator> trie() const {
+        return makeIndexTrieIterator(
+                [&](const RamDomain* low, const RamDomain* high) {
+                    return std::make_pair(
+                            index.lower_bound({{low[0], low[1]}}), index.upper_bound({{high[0], high[1]}}));
+                },
+                order, 2);
+    }
+
+private:
+    const std::vector<size_t> order;
+    const std::set<Pair, Less> index;
+};
+
+/** Enumerate the triangles x -> y -> z -> x of the given edges by a leapfrog triejoin */
+std::vector<Triple> joinTriangles(const std::set<Pair>& edges) {
+    // the variables are x, y, z; the third atom binds z by its first and x by its second column
+    SortedRelation first(edges, {0, 1});
+    SortedRelation second(edges, {0, 1});
+    SortedRelation third(edges, {1, 0});
+    LeapfrogTrieJoin join(3);
+    join.addIterator(first.trie(), {0, 1});
+    join.addIterator(second.trie(), {1, 2});
+    join.addIterator(third.trie(), {0, 2});
+
+    std::vector<Triple> result;
+    while (join.next()) {
+        const RamDomain* binding = join.getBinding();
+        result.push_back({{binding[0], binding[1], binding[2]}});
+    }
+    return result;
+}
+
+/** Check that the join enumerates exactly the expected triangles, each of them once */
+bool matches(const std::set<Triple>& expected, const std::vector<Triple>& result) {
+    return result.size() == expected.size() && std::set<Triple>(result.begin(), result.end()) == expected;
+}
+
+TEST(LeapfrogTrieJoin, Empty) {
+    EXPECT_TRUE(joinTriangles({}).empty());
+    EXPECT_TRUE(joinTriangles({{{0, 1}}, {{1, 2}}}).empty());
+}
+
+TEST(LeapfrogTrieJoin, Triangle) {
+    std::set<Triple> expected = {{{0, 1, 2}}, {{1, 2, 0}}, {{2, 0, 1}}};
+    EXPECT_TRUE(matches(expected, joinTriangles({{{0, 1}}, {{1, 2}}, {{2, 0}}, {{2, 3}}})));
+}
+
+TEST(LeapfrogTrieJoin, Extremes) {
+    const RamDomain min = MIN_RAM_DOMAIN;
+    const RamDomain max = MAX_RAM_DOMAIN;
+    std::set<Triple> expected = {{{min, max, max}}, {{max, min, max}}, {{max, max, min}}, {{max, max, max}}};
+    EXPECT_TRUE(matches(expected, joinTriangles({{{min, max}}, {{max, max}}, {{max, min}}})));
+}
+
+TEST(LeapfrogTrieJoin, Random) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<RamDomain> node(0, 29);
+    std::set<Pair> edges;
+    for (int i = 0; i < 200; ++i) {
+        edges.insert({{node(rng), node(rng)}});
+    }
+
+    std::set<Triple> expected;
+    for (const auto& a : edges) {
+        for (const auto& b : edges) {
+            if (a[1] == b[0] && edges.count({{b[1], a[0]}}) > 0) {
+                expected.insert({{a[0], a[1], b[1]}});
+            }
+        }
+    }
+    EXPECT_FALSE(expected.empty());
+    EXPECT_TRUE(matches(expected, joinTriangles(edges)));
+}
+
+}  // end namespace test
@@ -95,3 +95,55 @@ TEST(Matching, StaticTest_2) {
 
     EXPECT_EQ(num, 5);
 }
+
+TEST(Matching, HotSearch) {
+    TestAutoIndex order;
+
+    // searches 1 and 3 are prefixes of the chain 1 < 3 < 7
+    order.addSearch(7);
+    order.addSearch(3);
+    order.addSearch(1);
+    order.addSearchFrequency(7, 10);
+    order.addSearchFrequency(3, 100);
+    order.addSearchFrequency(1, 10);
+
+    order.solve();
+
+    // the hot search keeps its prefix of the chain and is served by a hash index
+    EXPECT_EQ(order.getAllOrders().size(), 1);
+    EXPECT_TRUE(order.isSubset(3));
+    EXPECT_EQ(order.getHashSearches(), MinIndexSelection::SearchSet({3}));
+}
+
+TEST(Matching, LukewarmSearch) {
+    TestAutoIndex order;
+
+    order.addSearch(7);
+    order.addSearch(3);
+    order.addSearch(1);
+    order.addSearchFrequency(7, 10);
+    order.addSearchFrequency(3, 10);
+    order.addSearchFrequency(1, 10);
+
+    order.solve();
+
+    // no search dominates the lookups, hence the chain cover is kept
+    EXPECT_EQ(order.getAllOrders().size(), 1);
+    EXPECT_TRUE(order.isSubset(3));
+    EXPECT_TRUE(order.getHashSearches().empty());
+}
+
+TEST(Matching, HotSearchEndingChain) {
+    TestAutoIndex order;
+
+    // search 3 ends the chain 1 < 3, its order is completed by the relation
+    order.addSearch(3);
+    order.addSearch(1);
+    order.addSearchFrequency(3, 100);
+    order.addSearchFrequency(1, 10);
+
+    order.solve();
+
+    EXPECT_EQ(order.getAllOrders().size(), 1);
+    EXPECT_EQ(order.getHashSearches(), MinIndexSelection::SearchSet({3}));
+}
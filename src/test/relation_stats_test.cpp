@@ -0,0 +1,109 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file relation_stats_test.cpp
+ *
+ * A test case testing the cardinality statistics of relations.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "BTree.h"
+#include "CompiledTuple.h"
+#include "RelationStats.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace souffle;
+
+namespace test {
+
+using Entry = ram::Tuple<RamDomain, 3>;
+
+TEST(HyperLogLog, Small) {
+    HyperLogLog<> sketch;
+    EXPECT_EQ(0, sketch.estimate());
+    for (int round = 0; round < 3; ++round) {
+        for (RamDomain i = 0; i < 100; ++i) {
+            sketch.insert(i);
+        }
+    }
+    // linear counting is almost exact for few values
+    EXPECT_TRUE(std::abs(double(sketch.estimate()) - 100) <= 2);
+}
+
+TEST(HyperLogLog, Large) {
+    std::mt19937 rand(3);
+    std::uniform_int_distribution<RamDomain> dist(MIN_RAM_DOMAIN, MAX_RAM_DOMAIN);
+    HyperLogLog<> a;
+    HyperLogLog<> b;
+    for (int i = 0; i < 1000000; ++i) {
+        RamDomain value = dist(rand);
+        (i % 2 == 0 ? a : b).insert(value);
+    }
+    a.merge(b);
+    // the standard error is 1.6%, allow for three times of it
+    EXPECT_TRUE(std::abs(double(a.estimate()) - 1000000) <= 50000);
+}
+
+TEST(RelationStats, Basic) {
+    btree_set<Entry> rel;
+    rel.insert({{1, 1, 1}});
+    rel.insert({{1, 2, 1}});
+    rel.insert({{1, 3, 2}});
+    rel.insert({{1, 4, 2}});
+
+    RelationStats stats = RelationStats::extractFrom(3, rel.begin(), rel.end());
+    EXPECT_EQ(4, stats.getCardinality());
+    EXPECT_EQ(3, stats.getArity());
+    EXPECT_EQ(1, stats.getDistinctValues(0));
+    EXPECT_EQ(4, stats.getDistinctValues(1));
+    EXPECT_EQ(2, stats.getDistinctValues(2));
+
+    EXPECT_EQ(4, stats.getEstimatedMatches({false, false, false}));
+    EXPECT_EQ(4, stats.getEstimatedMatches({true, false, false}));
+    EXPECT_EQ(2, stats.getEstimatedMatches({false, false, true}));
+    EXPECT_EQ(1, stats.getEstimatedMatches({true, true, true}));
+}
+
+TEST(RelationStats, Empty) {
+    std::vector<const RamDomain*> rel;
+    RelationStats stats = RelationStats::extractFrom(2, rel.begin(), rel.end());
+    EXPECT_EQ(0, stats.getCardinality());
+    EXPECT_EQ(0, stats.getDistinctValues(0));
+    EXPECT_EQ(0, stats.getEstimatedMatches({true, false}));
+}
+
+TEST(RelationStats, Columns) {
+    // tuples given as pointers, as iterated by the interpreters
+    std::vector<RamDomain> data;
+    for (RamDomain i = 0; i < 10000; ++i) {
+        data.push_back(i);
+        data.push_back(i % 5);
+    }
+    std::vector<const RamDomain*> rel;
+    for (std::size_t i = 0; i < data.size(); i += 2) {
+        rel.push_back(&data[i]);
+    }
+
+    RelationStats stats = RelationStats::extractFrom(2, rel.begin(), rel.end());
+    EXPECT_EQ(10000, stats.getCardinality());
+    EXPECT_TRUE(std::abs(double(stats.getDistinctValues(0)) - 10000) <= 300);
+    EXPECT_EQ(5, stats.getDistinctValues(1));
+
+    // binding the key yields a single tuple, binding the second column a fifth of them
+    EXPECT_EQ(1, stats.getEstimatedMatches({true, false}));
+    EXPECT_EQ(2000, stats.getEstimatedMatches({false, true}));
+}
+
+}  // end namespace test
@@ -0,0 +1,186 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file stratum_scheduler_test.cpp
+ *
+ * A test case testing the concurrent evaluation of strata.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "StratumScheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+/** Records the order in which strata finish and the number of strata running at once */
+class Trace {
+public:
+    explicit Trace(size_t numStrata) : position(numStrata, 0) {}
+
+    std::function<void()> stratum(size_t id) {
+        return [this, id]() {
+            size_t now = ++running;
+            size_t seen = maxRunning;
+            while (now > seen && !maxRunning.compare_exchange_weak(seen, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            --running;
+            std::lock_guard<std::mutex> guard(lock);
+            position[id] = ++count;
+        };
+    }
+
+    /** Check that the first stratum finished before the second one */
+    bool before(size_t first, size_t second) const {
+        return position[first] != 0 && position[first] < position[second];
+    }
+
+    bool finished(size_t id) const {
+        return position[id] != 0;
+    }
+
+    size_t getMaxRunning() const {
+        return maxRunning;
+    }
+
+private:
+    std::mutex lock;
+    std::vector<size_t> position;
+    size_t count = 0;
+    std::atomic<size_t> running{0};
+    std::atomic<size_t> maxRunning{0};
+};
+
+TEST(StratumScheduler, Empty) {
+    bool released = false;
+    StratumScheduler scheduler;
+    scheduler.addRelease([&]() { released = true; }, {});
+    scheduler.run(4);
+    EXPECT_TRUE(released);
+}
+
+TEST(StratumScheduler, Dependencies) {
+    // a diamond 0 -> {1, 2} -> 3 followed by a chain 3 -> 4 and an independent stratum 5
+    for (size_t threads : {1, 2, 8}) {
+        Trace trace(6);
+        StratumScheduler scheduler;
+        scheduler.setMemoryLimit(0);
+        scheduler.addStratum(trace.stratum(0), {});
+        scheduler.addStratum(trace.stratum(1), {0});
+        scheduler.addStratum(trace.stratum(2), {0});
+        scheduler.addStratum(trace.stratum(3), {1, 2});
+        scheduler.addStratum(trace.stratum(4), {3});
+        scheduler.addStratum(trace.stratum(5), {});
+        scheduler.run(threads);
+
+        EXPECT_TRUE(trace.before(0, 1));
+        EXPECT_TRUE(trace.before(0, 2));
+        EXPECT_TRUE(trace.before(1, 3));
+        EXPECT_TRUE(trace.before(2, 3));
+        EXPECT_TRUE(trace.before(3, 4));
+        EXPECT_TRUE(trace.finished(5));
+        if (threads == 1) {
+            EXPECT_EQ(1, trace.getMaxRunning());
+        }
+    }
+}
+
+TEST(StratumScheduler, Concurrent) {
+    // two independent strata only finish if they run at the same time
+    std::atomic<int> started{0};
+    std::atomic<bool> overlapped{true};
+    auto stratum = [&]() {
+        ++started;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (started < 2) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                overlapped = false;
+                return;
+            }
+            std::this_thread::yield();
+        }
+    };
+    StratumScheduler scheduler;
+    scheduler.setMemoryLimit(0);
+    scheduler.addStratum(stratum, {});
+    scheduler.addStratum(stratum, {});
+    scheduler.run(2);
+    EXPECT_TRUE(overlapped);
+}
+
+TEST(StratumScheduler, Releases) {
+    Trace trace(3);
+    std::vector<bool> finishedAtRelease;
+    StratumScheduler scheduler;
+    scheduler.setMemoryLimit(0);
+    scheduler.addStratum(trace.stratum(0), {});
+    scheduler.addStratum(trace.stratum(1), {0});
+    scheduler.addStratum(trace.stratum(2), {0});
+    // released once both strata reading the result of stratum 0 finished
+    scheduler.addRelease(
+            [&]() {
+                finishedAtRelease.push_back(trace.finished(1) && trace.finished(2));
+            },
+            {0, 1, 2});
+    scheduler.run(4);
+    EXPECT_EQ(1, finishedAtRelease.size());
+    EXPECT_TRUE(finishedAtRelease.front());
+}
+
+#ifdef __linux__
+TEST(StratumScheduler, MemoryLimit) {
+    EXPECT_TRUE(StratumScheduler::getResidentMemory() > 0);
+
+    // every process exceeds a limit of one byte, hence the strata run one at a time
+    Trace trace(8);
+    StratumScheduler scheduler;
+    scheduler.setMemoryLimit(1);
+    for (size_t i = 0; i < 8; ++i) {
+        scheduler.addStratum(trace.stratum(i), {});
+    }
+    scheduler.run(4);
+    for (size_t i = 0; i < 8; ++i) {
+        EXPECT_TRUE(trace.finished(i));
+    }
+    EXPECT_EQ(1, trace.getMaxRunning());
+}
+#endif
+
+TEST(StratumScheduler, Exception) {
+    Trace trace(3);
+    StratumScheduler scheduler;
+    scheduler.setMemoryLimit(0);
+    scheduler.addStratum([]() { throw std::runtime_error("stratum failed"); }, {});
+    scheduler.addStratum(trace.stratum(1), {0});
+    scheduler.addStratum(trace.stratum(2), {1});
+    bool thrown = false;
+    try {
+        scheduler.run(2);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    EXPECT_TRUE(thrown);
+    EXPECT_FALSE(trace.finished(1));
+    EXPECT_FALSE(trace.finished(2));
+}
+
+}  // end namespace test
+
+}  // end namespace souffle
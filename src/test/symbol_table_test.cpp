@@ -140,4 +140,63 @@ TEST(SymbolTable, Inserts) {
     if (ECHO_TIME) std::cout << "Time to insert " << N << " new elements: " << n << " ns" << std::endl;
 }
 
+TEST(SymbolTable, ParallelLookup) {
+    const int N = 100000;  // number of distinct symbols
+    const int R = 4;       // number of times each symbol is looked up
+
+    SymbolTable table;
+    std::vector<RamDomain> indices(N);
+
+#pragma omp parallel for
+    for (int i = 0; i < N * R; ++i) {
+        int j = i % N;
+        RamDomain index = table.lookup(std::to_string(j) + "string");
+        if (i < N) {
+            indices[j] = index;
+        }
+    }
+
+    EXPECT_EQ(N, table.size());
+    for (int j = 0; j < N; ++j) {
+        EXPECT_EQ(indices[j], table.lookup(std::to_string(j) + "string"));
+        EXPECT_EQ(std::to_string(j) + "string", table.resolve(indices[j]));
+    }
+}
+
+TEST(SymbolTable, ParallelScaling) {
+    // whether to print the recorded times to stdout
+    // should be false unless developing
+    const bool ECHO_TIME = false;
+
+    const int N = 1000000;  // number of symbols to insert
+
+    std::vector<std::string> A;
+    A.reserve(N);
+    for (int i = 0; i < N; ++i) {
+        A.push_back(std::to_string(i) + "string");
+    }
+
+#ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+#else
+    const int maxThreads = 1;
+#endif
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        SymbolTable X;
+        time_point start = now();
+#pragma omp parallel for num_threads(threads)
+        for (int i = 0; i < N; ++i) {
+            RamDomain index = X.lookup(A[i]);
+            X.resolve(index);
+        }
+        time_point end = now();
+
+        EXPECT_EQ(N, X.size());
+        if (ECHO_TIME) {
+            std::cout << "Time to look up " << N << " new elements with " << threads
+                      << " threads: " << duration_in_ns(start, end) << " ns" << std::endl;
+        }
+    }
+}
+
 }  // end namespace test